@@ -0,0 +1,204 @@
+//
+// Age distribution over a population file - classifies a column of ages into configurable
+// buckets. The AVX2 kernel never scatters into the histogram: for each bucket boundary it
+// counts how many ages are >= the boundary (compare + subtract, 8 ages per step), and the
+// bucket sizes fall out as differences of those counts.
+//
+
+#ifndef EMPLOYEE_VALIDATION_C_AGEHISTOGRAM_H
+#define EMPLOYEE_VALIDATION_C_AGEHISTOGRAM_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "eligibility.h"
+#include "mappedFile.h"
+#include "simd.h"
+
+// Bucket i holds ages in [bounds[i-1], bounds[i]); bucket 0 is everything below the first bound
+class AgeBuckets {
+public:
+    static constexpr std::size_t kMaxBounds = 32;
+
+    // default bands: invalid (< 1), under 18 (the getValidAge rules), then adult age groups
+    AgeBuckets() : AgeBuckets(std::vector<std::int32_t>{1, 18, 25, 35, 45, 55, 65, 75}) {}
+
+    explicit AgeBuckets(std::vector<std::int32_t> lowerBounds) : bounds(std::move(lowerBounds)) {
+        std::sort(bounds.begin(), bounds.end());
+        bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+        if (bounds.size() > kMaxBounds) bounds.resize(kMaxBounds);
+    }
+
+    // "1,18,65" -> {1, 18, 65}
+    static AgeBuckets parse(std::string_view text) {
+        std::vector<std::int32_t> values;
+        std::int32_t value = 0;
+        bool inNumber = false;
+        for (char c : text) {
+            if (c >= '0' && c <= '9') {
+                value = value * 10 + (c - '0');
+                inNumber = true;
+            }
+            else if (inNumber) {
+                values.push_back(value);
+                value = 0;
+                inNumber = false;
+            }
+        }
+        if (inNumber) values.push_back(value);
+        return values.empty() ? AgeBuckets() : AgeBuckets(values);
+    }
+
+    std::size_t bucketCount() const { return bounds.size() + 1; }
+    const std::vector<std::int32_t>& lowerBounds() const { return bounds; }
+
+    std::string label(std::size_t bucket) const {
+        if (bounds.empty()) return "all";
+        if (bucket == 0) return "< " + std::to_string(bounds.front());
+        if (bucket == bounds.size()) return std::to_string(bounds.back()) + "+";
+        return std::to_string(bounds[bucket - 1]) + "-" + std::to_string(bounds[bucket] - 1);
+    }
+
+private:
+    std::vector<std::int32_t> bounds;
+};
+
+struct AgeHistogram {
+    std::vector<std::uint64_t> counts;
+    std::uint64_t malformed = 0;
+
+    explicit AgeHistogram(std::size_t buckets = 0) : counts(buckets, 0) {}
+
+    void merge(const AgeHistogram& other) {
+        for (std::size_t i = 0; i < counts.size() && i < other.counts.size(); ++i) counts[i] += other.counts[i];
+        malformed += other.malformed;
+    }
+};
+
+// reference version: find the bucket for every age and bump it
+inline void classifyAgesScalar(const std::int32_t* ages, std::size_t n, const AgeBuckets& buckets,
+                               AgeHistogram& histogram) {
+    const std::vector<std::int32_t>& bounds = buckets.lowerBounds();
+    for (std::size_t i = 0; i < n; ++i) {
+        std::size_t bucket = 0;
+        while (bucket < bounds.size() && ages[i] >= bounds[bucket]) ++bucket;
+        ++histogram.counts[bucket];
+    }
+}
+
+#if EV_X86_SIMD
+EV_TARGET_AVX2 inline void classifyAgesAvx2(const std::int32_t* ages, std::size_t n, const AgeBuckets& buckets,
+                                            AgeHistogram& histogram) {
+    const std::vector<std::int32_t>& bounds = buckets.lowerBounds();
+    const std::size_t k = bounds.size();
+    __m256i thresholds[AgeBuckets::kMaxBounds];
+    __m256i atLeast[AgeBuckets::kMaxBounds];
+    for (std::size_t b = 0; b < k; ++b) {
+        thresholds[b] = _mm256_set1_epi32(bounds[b] - 1);   // age >= bound  <=>  age > bound - 1
+        atLeast[b] = _mm256_setzero_si256();
+    }
+
+    std::uint64_t totals[AgeBuckets::kMaxBounds] = {};
+    std::size_t i = 0;
+    while (i + 8 <= n) {
+        // flush the 32 bit lane counters before they could overflow
+        std::size_t blockEnd = std::min(n - (n - i) % 8, i + (std::size_t{1} << 30));
+        for (; i < blockEnd; i += 8) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ages + i));
+            for (std::size_t b = 0; b < k; ++b) {
+                // compare gives -1 per matching lane, subtracting it counts up
+                atLeast[b] = _mm256_sub_epi32(atLeast[b], _mm256_cmpgt_epi32(v, thresholds[b]));
+            }
+        }
+        for (std::size_t b = 0; b < k; ++b) {
+            alignas(32) std::uint32_t lanes[8];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), atLeast[b]);
+            for (std::uint32_t lane : lanes) totals[b] += lane;
+            atLeast[b] = _mm256_setzero_si256();
+        }
+    }
+
+    std::uint64_t vectorized = i;
+    histogram.counts[0] += vectorized - (k > 0 ? totals[0] : 0);
+    for (std::size_t b = 0; b < k; ++b) {
+        histogram.counts[b + 1] += totals[b] - (b + 1 < k ? totals[b + 1] : 0);
+    }
+    classifyAgesScalar(ages + i, n - i, buckets, histogram);
+}
+#endif
+
+inline void classifyAges(const std::int32_t* ages, std::size_t n, const AgeBuckets& buckets, AgeHistogram& histogram) {
+#if EV_X86_SIMD
+    if (cpuHasAvx2()) {
+        classifyAgesAvx2(ages, n, buckets, histogram);
+        return;
+    }
+#endif
+    classifyAgesScalar(ages, n, buckets, histogram);
+}
+
+// Pulls just the age column out of "id,age,citizen" lines into ages; returns bytes consumed.
+// Stops when ages is full so the caller can classify a cache sized block at a time.
+inline std::size_t parseAgeColumn(std::string_view text, std::vector<std::int32_t>& ages, std::size_t maxAges,
+                                  std::uint64_t& malformed) {
+    const char* p = text.data();
+    const char* end = p + text.size();
+    while (p < end && ages.size() < maxAges) {
+        while (p < end && *p != ',' && *p != '\n') ++p;   // skip the id
+        if (p == end) break;
+        if (*p == '\n') {
+            ++p;
+            ++malformed;
+            continue;
+        }
+        ++p;
+        std::int32_t age = 0;
+        const char* digits = p;
+        while (p < end && *p >= '0' && *p <= '9' && p - digits < 9) age = age * 10 + (*p++ - '0');
+        if (p == digits || p == end || *p != ',') ++malformed;
+        else ages.push_back(age);
+        while (p < end && *p != '\n') ++p;
+        if (p < end) ++p;
+    }
+    return static_cast<std::size_t>(p - text.data());
+}
+
+using AgeClassifier = void (*)(const std::int32_t*, std::size_t, const AgeBuckets&, AgeHistogram&);
+
+// Parses and classifies in parallel; each thread keeps its own histogram, merged at the end
+inline bool buildAgeHistogram(const std::string& path, const AgeBuckets& buckets, unsigned threads,
+                              AgeHistogram& result, AgeClassifier classify = classifyAges) {
+    MappedFile input;
+    if (!input.open(path)) return false;
+    if (threads == 0) threads = 1;
+
+    std::vector<std::string_view> chunks = splitOnLineBoundaries(skipHeader(input.view()), threads);
+    std::vector<AgeHistogram> partial(chunks.size(), AgeHistogram(buckets.bucketCount()));
+    auto worker = [&](std::size_t c) {
+        constexpr std::size_t kBlock = 4096;   // 16 KB of ages, stays in L1
+        std::vector<std::int32_t> ages;
+        ages.reserve(kBlock);
+        std::string_view rest = chunks[c];
+        while (!rest.empty()) {
+            ages.clear();
+            rest.remove_prefix(parseAgeColumn(rest, ages, kBlock, partial[c].malformed));
+            classify(ages.data(), ages.size(), buckets, partial[c]);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (std::size_t c = 1; c < chunks.size(); ++c) pool.emplace_back(worker, c);
+    if (!chunks.empty()) worker(0);
+    for (auto& thread : pool) thread.join();
+
+    result = AgeHistogram(buckets.bucketCount());
+    for (const AgeHistogram& part : partial) result.merge(part);
+    return true;
+}
+
+#endif //EMPLOYEE_VALIDATION_C_AGEHISTOGRAM_H
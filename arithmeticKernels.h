@@ -0,0 +1,197 @@
+//
+// The learning.cpp operations as constexpr templates over int32, int64, float, double and a
+// Q16.16 Fixed type. Mixed argument types are promoted at compile time (see Promote below), so
+// compute<DivOp>(10.0, 4) is resolved to a double division before the program runs, and the
+// same functions work in constant expressions and in the batch loops.
+//
+// Promotion, lowest to highest: int32 < int64 < Fixed < float < double, except that float
+// mixed with int64 goes to double (float cannot hold int64 values) and so does an integer mixed
+// with Fixed (Fixed only reaches +-32768). Dividing two integers gives a double, like
+// divisionFunction does. Converting an out of range value to Fixed saturates.
+//
+
+#ifndef EMPLOYEE_VALIDATION_C_ARITHMETICKERNELS_H
+#define EMPLOYEE_VALIDATION_C_ARITHMETICKERNELS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+#include "batchArithmetic.h"
+
+// Q16.16 fixed point: raw holds value * 65536
+struct Fixed {
+    static constexpr int kFractionBits = 16;
+    static constexpr std::int32_t kOne = 1 << kFractionBits;
+
+    std::int32_t raw = 0;
+
+    static constexpr Fixed fromRaw(std::int64_t raw) {
+        return Fixed{static_cast<std::int32_t>(static_cast<std::uint32_t>(static_cast<std::uint64_t>(raw)))};
+    }
+    static constexpr Fixed fromInt(std::int64_t value) {
+        constexpr std::int64_t kLowest = std::numeric_limits<std::int32_t>::min() / kOne;
+        constexpr std::int64_t kHighest = std::numeric_limits<std::int32_t>::max() / kOne;
+        if (value < kLowest) return Fixed{std::numeric_limits<std::int32_t>::min()};
+        if (value > kHighest) return Fixed{std::numeric_limits<std::int32_t>::max()};
+        return fromRaw(value * kOne);
+    }
+    // NaN gives 0
+    static constexpr Fixed fromDouble(double value) {
+        const double scaled = value * kOne + (value < 0 ? -0.5 : 0.5);
+        if (!(scaled > std::numeric_limits<std::int32_t>::min() - 1.0)) {
+            return Fixed{scaled != scaled ? 0 : std::numeric_limits<std::int32_t>::min()};
+        }
+        if (scaled >= std::numeric_limits<std::int32_t>::max() + 1.0) return Fixed{std::numeric_limits<std::int32_t>::max()};
+        return fromRaw(static_cast<std::int64_t>(scaled));
+    }
+    constexpr double toDouble() const { return static_cast<double>(raw) / kOne; }
+
+    friend constexpr bool operator==(Fixed a, Fixed b) { return a.raw == b.raw; }
+};
+
+// ---- compile time promotion ----
+
+template <typename T> struct ArithRank;
+template <> struct ArithRank<std::int32_t> { static constexpr int value = 1; };
+template <> struct ArithRank<std::int64_t> { static constexpr int value = 2; };
+template <> struct ArithRank<Fixed> { static constexpr int value = 3; };
+template <> struct ArithRank<float> { static constexpr int value = 4; };
+template <> struct ArithRank<double> { static constexpr int value = 5; };
+
+template <typename A, typename B>
+struct Promote {
+    using type = std::conditional_t<(ArithRank<A>::value >= ArithRank<B>::value), A, B>;
+};
+template <> struct Promote<float, std::int64_t> { using type = double; };
+template <> struct Promote<std::int64_t, float> { using type = double; };
+template <> struct Promote<Fixed, std::int32_t> { using type = double; };
+template <> struct Promote<std::int32_t, Fixed> { using type = double; };
+template <> struct Promote<Fixed, std::int64_t> { using type = double; };
+template <> struct Promote<std::int64_t, Fixed> { using type = double; };
+
+template <typename A, typename B>
+using PromoteT = typename Promote<A, B>::type;
+
+template <typename To, typename From>
+constexpr To convertTo(From value) {
+    if constexpr (std::is_same_v<To, From>) {
+        return value;
+    }
+    else if constexpr (std::is_same_v<To, Fixed>) {
+        if constexpr (std::is_integral_v<From>) return Fixed::fromInt(value);
+        else return Fixed::fromDouble(static_cast<double>(value));
+    }
+    else if constexpr (std::is_same_v<From, Fixed>) {
+        return static_cast<To>(value.toDouble());
+    }
+    else {
+        return static_cast<To>(value);
+    }
+}
+
+// ---- operations, one type at a time ----
+
+// Integer add / subtract / multiply wrap like the AVX2 batch kernels do: the math is done in
+// the unsigned type, so overflow is defined and the scalar and batch paths agree
+template <typename T, typename Fn>
+constexpr T wrapping(T a, T b, Fn fn) {
+    using U = std::make_unsigned_t<T>;
+    return static_cast<T>(fn(static_cast<U>(a), static_cast<U>(b)));
+}
+
+struct AddOp {
+    template <typename T>
+    static constexpr T apply(T a, T b) {
+        if constexpr (std::is_same_v<T, Fixed>) return Fixed::fromRaw(std::int64_t{a.raw} + b.raw);
+        else if constexpr (std::is_integral_v<T>) return wrapping(a, b, [](auto x, auto y) { return x + y; });
+        else return a + b;
+    }
+};
+
+struct SubOp {
+    template <typename T>
+    static constexpr T apply(T a, T b) {
+        if constexpr (std::is_same_v<T, Fixed>) return Fixed::fromRaw(std::int64_t{a.raw} - b.raw);
+        else if constexpr (std::is_integral_v<T>) return wrapping(a, b, [](auto x, auto y) { return x - y; });
+        else return a - b;
+    }
+};
+
+struct MulOp {
+    template <typename T>
+    static constexpr T apply(T a, T b) {
+        if constexpr (std::is_same_v<T, Fixed>) return Fixed::fromRaw((std::int64_t{a.raw} * b.raw) >> Fixed::kFractionBits);
+        else if constexpr (std::is_integral_v<T>) return wrapping(a, b, [](auto x, auto y) { return x * y; });
+        else return a * b;
+    }
+};
+
+// Fixed division by zero saturates (0 / 0 gives 0); floating point follows IEEE
+struct DivOp {
+    template <typename T>
+    static constexpr T apply(T a, T b) {
+        if constexpr (std::is_same_v<T, Fixed>) {
+            if (b.raw == 0) {
+                return Fixed{a.raw > 0 ? std::numeric_limits<std::int32_t>::max()
+                                       : a.raw < 0 ? std::numeric_limits<std::int32_t>::min() : 0};
+            }
+            return Fixed::fromRaw((std::int64_t{a.raw} * Fixed::kOne) / b.raw);
+        }
+        else {
+            return a / b;
+        }
+    }
+};
+
+template <typename Op, typename A, typename B>
+using ResultOf = std::conditional_t<std::is_same_v<Op, DivOp> && std::is_integral_v<A> && std::is_integral_v<B>,
+                                    double, PromoteT<A, B>>;
+
+template <typename Op, typename A, typename B>
+constexpr ResultOf<Op, A, B> compute(A a, B b) {
+    using R = ResultOf<Op, A, B>;
+    return Op::template apply<R>(convertTo<R>(a), convertTo<R>(b));
+}
+
+static_assert(std::is_same_v<ResultOf<DivOp, double, std::int32_t>, double>, "divisionFunction(double, int)");
+static_assert(std::is_same_v<ResultOf<AddOp, std::int32_t, std::int64_t>, std::int64_t>);
+static_assert(std::is_same_v<ResultOf<MulOp, float, std::int64_t>, double>);
+static_assert(std::is_same_v<ResultOf<AddOp, Fixed, std::int32_t>, double>);
+static_assert(compute<AddOp>(10, 20) == 30);
+static_assert(compute<AddOp>(std::numeric_limits<std::int32_t>::max(), 1) == std::numeric_limits<std::int32_t>::min());
+static_assert(compute<SubOp>(std::numeric_limits<std::int64_t>::min(), std::int64_t{1}) == std::numeric_limits<std::int64_t>::max());
+static_assert(compute<MulOp>(65536, 65536) == 0);
+static_assert(compute<DivOp>(10, 20) == 0.5);
+static_assert(compute<MulOp>(Fixed::fromDouble(1.5), 4) == 6.0);
+static_assert(compute<AddOp>(40000, Fixed::fromDouble(0.5)) == 40000.5);
+static_assert(compute<AddOp>(std::int64_t{1} << 50, Fixed::fromInt(1)) == 1125899906842625.0);
+static_assert(Fixed::fromInt(40000) == Fixed{std::numeric_limits<std::int32_t>::max()});
+static_assert(Fixed::fromInt(std::numeric_limits<std::int64_t>::min()) == Fixed{std::numeric_limits<std::int32_t>::min()});
+static_assert(Fixed::fromDouble(1e300) == Fixed{std::numeric_limits<std::int32_t>::max()});
+static_assert(Fixed::fromDouble(-40000.0) == Fixed{std::numeric_limits<std::int32_t>::min()});
+static_assert(Fixed::fromDouble(-1.5) == Fixed{-3 * Fixed::kOne / 2});
+
+// ---- batch runtime ----
+
+// Same element-wise operation over spans (trimmed to the shortest). int32 add / subtract /
+// multiply go to the AVX2 kernels in batchArithmetic.h, everything else is a straight loop
+// over compute<Op>, which the compiler vectorizes like a hand written one.
+template <typename Op, typename A, typename B>
+void computeBatch(std::span<const A> a, std::span<const B> b, std::span<ResultOf<Op, A, B>> out) {
+    const std::size_t n = std::min({a.size(), b.size(), out.size()});
+    if constexpr (std::is_same_v<A, std::int32_t> && std::is_same_v<B, std::int32_t>) {
+        if constexpr (std::is_same_v<Op, AddOp>) return addBatch(a.first(n), b.first(n), out.first(n));
+        else if constexpr (std::is_same_v<Op, SubOp>) return subtractBatch(a.first(n), b.first(n), out.first(n));
+        else if constexpr (std::is_same_v<Op, MulOp>) return multiplyBatch(a.first(n), b.first(n), out.first(n));
+    }
+    const A* x = a.data();
+    const B* y = b.data();
+    ResultOf<Op, A, B>* d = out.data();
+    for (std::size_t i = 0; i < n; ++i) d[i] = compute<Op>(x[i], y[i]);
+}
+
+#endif //EMPLOYEE_VALIDATION_C_ARITHMETICKERNELS_H
@@ -0,0 +1,132 @@
+//
+// ASCII case folding without copies or locale lookups, and a case-insensitive matcher for the
+// short yes/no style answers in the citizen data. Only A-Z are folded; other bytes (including
+// UTF-8) pass through untouched.
+//
+
+#ifndef EMPLOYEE_VALIDATION_C_ASCIIFOLD_H
+#define EMPLOYEE_VALIDATION_C_ASCIIFOLD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include "simd.h"
+
+inline char foldAscii(char c) {
+    return static_cast<char>(c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c);
+}
+
+inline void toLowerAsciiScalar(char* data, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) data[i] = foldAscii(data[i]);
+}
+
+#if EV_X86_SIMD
+// SSE2 is always there on x86-64, 16 bytes per step (same trick as the AVX2 version below)
+inline void toLowerAsciiSse2(char* data, std::size_t n) {
+    const __m128i shift = _mm_set1_epi8(static_cast<char>(-'A' - 128));
+    const __m128i bound = _mm_set1_epi8(static_cast<char>(-128 + 26));
+    const __m128i bit = _mm_set1_epi8(0x20);
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i upper = _mm_cmplt_epi8(_mm_add_epi8(v, shift), bound);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), _mm_or_si128(v, _mm_and_si128(upper, bit)));
+    }
+    toLowerAsciiScalar(data + i, n - i);
+}
+
+// 'A'..'Z' shifted down by 'A' + 128 lands on the 26 smallest signed bytes, so one compare finds them
+EV_TARGET_AVX2 inline void toLowerAsciiAvx2(char* data, std::size_t n) {
+    const __m256i shift = _mm256_set1_epi8(static_cast<char>(-'A' - 128));
+    const __m256i bound = _mm256_set1_epi8(static_cast<char>(-128 + 26));
+    const __m256i bit = _mm256_set1_epi8(0x20);
+    std::size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i upper = _mm256_cmpgt_epi8(bound, _mm256_add_epi8(v, shift));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), _mm256_or_si256(v, _mm256_and_si256(upper, bit)));
+    }
+    toLowerAsciiSse2(data + i, n - i);
+}
+#endif
+
+inline void toLowerAsciiInPlace(char* data, std::size_t n) {
+#if EV_X86_SIMD
+    if (n >= 32 && cpuHasAvx2()) {
+        toLowerAsciiAvx2(data, n);
+        return;
+    }
+    toLowerAsciiSse2(data, n);
+#else
+    toLowerAsciiScalar(data, n);
+#endif
+}
+
+inline void toLowerAsciiInPlace(std::string& text) {
+    toLowerAsciiInPlace(&text[0], text.size());
+}
+
+// Folds into a caller supplied buffer (at least text.size() bytes) and returns a view of it
+inline std::string_view toLowerAscii(std::string_view text, char* out) {
+    std::memcpy(out, text.data(), text.size());
+    toLowerAsciiInPlace(out, text.size());
+    return std::string_view(out, text.size());
+}
+
+enum class Keyword : std::uint8_t { None, Yes, No, True, False };
+
+// Up to 8 bytes packed little-endian into one word, so a keyword compare is a single integer compare
+constexpr std::uint64_t packWord(std::string_view text) {
+    std::uint64_t word = 0;
+    for (std::size_t i = 0; i < text.size() && i < 8; ++i) {
+        word |= static_cast<std::uint64_t>(static_cast<unsigned char>(text[i])) << (8 * i);
+    }
+    return word;
+}
+
+// SWAR fold of 8 bytes: sets bit 5 only in bytes that are 'A'..'Z'
+inline std::uint64_t foldWord(std::uint64_t word) {
+    constexpr std::uint64_t ones = 0x0101010101010101ull;
+    constexpr std::uint64_t high = 0x8080808080808080ull;
+    std::uint64_t aboveA = (word | high) - ones * 'A';         // high bit stays set where byte >= 'A'
+    std::uint64_t aboveZ = (word | high) - ones * ('Z' + 1);   // high bit stays set where byte > 'Z'
+    std::uint64_t upper = aboveA & ~aboveZ & ~word & high;     // ascii bytes in 'A'..'Z'
+    return word | (upper >> 2);
+}
+
+// yes / no / y / n / true / false in any case, without allocating or folding the input first
+inline Keyword matchKeyword(std::string_view token) {
+    if (token.empty() || token.size() > 5) return Keyword::None;
+    std::uint64_t word = 0;
+    std::memcpy(&word, token.data(), token.size());
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = packWord(token);
+#endif
+    word = foldWord(word);
+    switch (token.size()) {
+    case 1:
+        if (word == packWord("y")) return Keyword::Yes;
+        if (word == packWord("n")) return Keyword::No;
+        break;
+    case 2:
+        if (word == packWord("no")) return Keyword::No;
+        break;
+    case 3:
+        if (word == packWord("yes")) return Keyword::Yes;
+        break;
+    case 4:
+        if (word == packWord("true")) return Keyword::True;
+        break;
+    case 5:
+        if (word == packWord("false")) return Keyword::False;
+        break;
+    default:
+        break;
+    }
+    return Keyword::None;
+}
+
+#endif //EMPLOYEE_VALIDATION_C_ASCIIFOLD_H
@@ -0,0 +1,263 @@
+//
+// Batch versions of the learning.cpp arithmetic - one call applies the operation across whole
+// arrays instead of one pair per call. Same layout as the forecast kernels: a scalar reference,
+// an AVX2 version for 8 ints / 4 doubles per step, and a dispatcher that takes spans.
+//
+// Errors are reported per element in a byte mask (1 = flagged) instead of aborting the batch:
+// division by zero writes 0 and flags the slot, the checked add/multiply flag int32 overflow
+// (the wrapped value is still written). Each of those returns how many slots were flagged.
+//
+// Spans are trimmed to the shortest one passed in.
+//
+
+#ifndef EMPLOYEE_VALIDATION_C_BATCHARITHMETIC_H
+#define EMPLOYEE_VALIDATION_C_BATCHARITHMETIC_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include "simd.h"
+
+// ---- scalar kernels (fallback and reference) ----
+
+inline void addBatchScalar(const std::int32_t* a, const std::int32_t* b, std::int32_t* out, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = static_cast<std::int32_t>(static_cast<std::uint32_t>(a[i]) + static_cast<std::uint32_t>(b[i]));
+    }
+}
+
+inline void subtractBatchScalar(const std::int32_t* a, const std::int32_t* b, std::int32_t* out, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = static_cast<std::int32_t>(static_cast<std::uint32_t>(a[i]) - static_cast<std::uint32_t>(b[i]));
+    }
+}
+
+inline void multiplyBatchScalar(const std::int32_t* a, const std::int32_t* b, std::int32_t* out, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = static_cast<std::int32_t>(static_cast<std::uint32_t>(a[i]) * static_cast<std::uint32_t>(b[i]));
+    }
+}
+
+// divisionFunction(double a, int b) over arrays; b == 0 gives 0 and a flag instead of inf
+inline std::size_t divideBatchScalar(const double* a, const std::int32_t* b, double* out, std::uint8_t* divByZero,
+                                     std::size_t n) {
+    std::size_t flagged = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        std::uint8_t zero = b[i] == 0;
+        out[i] = zero ? 0.0 : a[i] / b[i];
+        divByZero[i] = zero;
+        flagged += zero;
+    }
+    return flagged;
+}
+
+inline std::size_t addCheckedScalar(const std::int32_t* a, const std::int32_t* b, std::int32_t* out,
+                                    std::uint8_t* overflow, std::size_t n) {
+    std::size_t flagged = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        std::int64_t wide = static_cast<std::int64_t>(a[i]) + b[i];
+        out[i] = static_cast<std::int32_t>(wide);
+        overflow[i] = wide != out[i];
+        flagged += overflow[i];
+    }
+    return flagged;
+}
+
+inline std::size_t multiplyCheckedScalar(const std::int32_t* a, const std::int32_t* b, std::int32_t* out,
+                                         std::uint8_t* overflow, std::size_t n) {
+    std::size_t flagged = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        std::int64_t wide = static_cast<std::int64_t>(a[i]) * b[i];
+        out[i] = static_cast<std::int32_t>(wide);
+        overflow[i] = wide != out[i];
+        flagged += overflow[i];
+    }
+    return flagged;
+}
+
+// ---- AVX2 kernels - scalar loop finishes the tail ----
+
+#if EV_X86_SIMD
+// bit i of an 8 bit lane mask -> byte i of a 64 bit word, so one store writes 8 mask bytes
+inline const std::array<std::uint64_t, 256>& maskByteTable() {
+    static const std::array<std::uint64_t, 256> table = [] {
+        std::array<std::uint64_t, 256> t{};
+        for (unsigned bits = 0; bits < 256; ++bits) {
+            for (unsigned i = 0; i < 8; ++i) {
+                if (bits & (1u << i)) t[bits] |= std::uint64_t{1} << (8 * i);
+            }
+        }
+        return t;
+    }();
+    return table;
+}
+
+inline unsigned storeMaskBytes(unsigned bits, std::uint8_t* mask) {
+    std::memcpy(mask, &maskByteTable()[bits], 8);
+    return static_cast<unsigned>(__builtin_popcount(bits));
+}
+
+EV_TARGET_AVX2 inline void addBatchAvx2(const std::int32_t* a, const std::int32_t* b, std::int32_t* out,
+                                        std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_add_epi32(x, y));
+    }
+    addBatchScalar(a + i, b + i, out + i, n - i);
+}
+
+EV_TARGET_AVX2 inline void subtractBatchAvx2(const std::int32_t* a, const std::int32_t* b, std::int32_t* out,
+                                             std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_sub_epi32(x, y));
+    }
+    subtractBatchScalar(a + i, b + i, out + i, n - i);
+}
+
+EV_TARGET_AVX2 inline void multiplyBatchAvx2(const std::int32_t* a, const std::int32_t* b, std::int32_t* out,
+                                             std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_mullo_epi32(x, y));
+    }
+    multiplyBatchScalar(a + i, b + i, out + i, n - i);
+}
+
+// divisors are widened 4 at a time; zero lanes are divided by 1 and then masked to 0
+EV_TARGET_AVX2 inline std::size_t divideBatchAvx2(const double* a, const std::int32_t* b, double* out,
+                                                  std::uint8_t* divByZero, std::size_t n) {
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d zero = _mm256_setzero_pd();
+    std::size_t flagged = 0;
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256d lo = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+        __m256d hi = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i + 4)));
+        __m256d zeroLo = _mm256_cmp_pd(lo, zero, _CMP_EQ_OQ);
+        __m256d zeroHi = _mm256_cmp_pd(hi, zero, _CMP_EQ_OQ);
+        __m256d qLo = _mm256_div_pd(_mm256_loadu_pd(a + i), _mm256_blendv_pd(lo, one, zeroLo));
+        __m256d qHi = _mm256_div_pd(_mm256_loadu_pd(a + i + 4), _mm256_blendv_pd(hi, one, zeroHi));
+        _mm256_storeu_pd(out + i, _mm256_andnot_pd(zeroLo, qLo));
+        _mm256_storeu_pd(out + i + 4, _mm256_andnot_pd(zeroHi, qHi));
+        unsigned bits = static_cast<unsigned>(_mm256_movemask_pd(zeroLo) | (_mm256_movemask_pd(zeroHi) << 4));
+        flagged += storeMaskBytes(bits, divByZero + i);
+    }
+    return flagged + divideBatchScalar(a + i, b + i, out + i, divByZero + i, n - i);
+}
+
+// signed overflow happened when both inputs have the same sign and the sum's sign differs
+EV_TARGET_AVX2 inline std::size_t addCheckedAvx2(const std::int32_t* a, const std::int32_t* b, std::int32_t* out,
+                                                 std::uint8_t* overflow, std::size_t n) {
+    std::size_t flagged = 0;
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        __m256i sum = _mm256_add_epi32(x, y);
+        __m256i bad = _mm256_and_si256(_mm256_xor_si256(x, sum), _mm256_xor_si256(y, sum));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), sum);
+        unsigned bits = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(bad)));
+        flagged += storeMaskBytes(bits, overflow + i);
+    }
+    return flagged + addCheckedScalar(a + i, b + i, out + i, overflow + i, n - i);
+}
+
+// full 64 bit products of the even and odd lanes; the product fits when its high half is
+// just the sign extension of the low half
+EV_TARGET_AVX2 inline std::size_t multiplyCheckedAvx2(const std::int32_t* a, const std::int32_t* b,
+                                                      std::int32_t* out, std::uint8_t* overflow, std::size_t n) {
+    std::size_t flagged = 0;
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        __m256i low = _mm256_mullo_epi32(x, y);
+        __m256i even = _mm256_mul_epi32(x, y);
+        __m256i odd = _mm256_mul_epi32(_mm256_srli_epi64(x, 32), _mm256_srli_epi64(y, 32));
+        __m256i high = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+        __m256i bad = _mm256_xor_si256(high, _mm256_srai_epi32(low, 31));
+        bad = _mm256_xor_si256(_mm256_cmpeq_epi32(bad, _mm256_setzero_si256()), _mm256_set1_epi32(-1));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), low);
+        unsigned bits = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(bad)));
+        flagged += storeMaskBytes(bits, overflow + i);
+    }
+    return flagged + multiplyCheckedScalar(a + i, b + i, out + i, overflow + i, n - i);
+}
+#endif
+
+// ---- dispatchers ----
+
+inline void addBatch(std::span<const std::int32_t> a, std::span<const std::int32_t> b, std::span<std::int32_t> out) {
+    std::size_t n = std::min({a.size(), b.size(), out.size()});
+#if EV_X86_SIMD
+    if (cpuHasAvx2()) {
+        addBatchAvx2(a.data(), b.data(), out.data(), n);
+        return;
+    }
+#endif
+    addBatchScalar(a.data(), b.data(), out.data(), n);
+}
+
+inline void subtractBatch(std::span<const std::int32_t> a, std::span<const std::int32_t> b,
+                          std::span<std::int32_t> out) {
+    std::size_t n = std::min({a.size(), b.size(), out.size()});
+#if EV_X86_SIMD
+    if (cpuHasAvx2()) {
+        subtractBatchAvx2(a.data(), b.data(), out.data(), n);
+        return;
+    }
+#endif
+    subtractBatchScalar(a.data(), b.data(), out.data(), n);
+}
+
+inline void multiplyBatch(std::span<const std::int32_t> a, std::span<const std::int32_t> b,
+                          std::span<std::int32_t> out) {
+    std::size_t n = std::min({a.size(), b.size(), out.size()});
+#if EV_X86_SIMD
+    if (cpuHasAvx2()) {
+        multiplyBatchAvx2(a.data(), b.data(), out.data(), n);
+        return;
+    }
+#endif
+    multiplyBatchScalar(a.data(), b.data(), out.data(), n);
+}
+
+inline std::size_t divideBatch(std::span<const double> a, std::span<const std::int32_t> b, std::span<double> out,
+                               std::span<std::uint8_t> divByZero) {
+    std::size_t n = std::min({a.size(), b.size(), out.size(), divByZero.size()});
+#if EV_X86_SIMD
+    if (cpuHasAvx2()) return divideBatchAvx2(a.data(), b.data(), out.data(), divByZero.data(), n);
+#endif
+    return divideBatchScalar(a.data(), b.data(), out.data(), divByZero.data(), n);
+}
+
+inline std::size_t addChecked(std::span<const std::int32_t> a, std::span<const std::int32_t> b,
+                              std::span<std::int32_t> out, std::span<std::uint8_t> overflow) {
+    std::size_t n = std::min({a.size(), b.size(), out.size(), overflow.size()});
+#if EV_X86_SIMD
+    if (cpuHasAvx2()) return addCheckedAvx2(a.data(), b.data(), out.data(), overflow.data(), n);
+#endif
+    return addCheckedScalar(a.data(), b.data(), out.data(), overflow.data(), n);
+}
+
+inline std::size_t multiplyChecked(std::span<const std::int32_t> a, std::span<const std::int32_t> b,
+                                   std::span<std::int32_t> out, std::span<std::uint8_t> overflow) {
+    std::size_t n = std::min({a.size(), b.size(), out.size(), overflow.size()});
+#if EV_X86_SIMD
+    if (cpuHasAvx2()) return multiplyCheckedAvx2(a.data(), b.data(), out.data(), overflow.data(), n);
+#endif
+    return multiplyCheckedScalar(a.data(), b.data(), out.data(), overflow.data(), n);
+}
+
+#endif //EMPLOYEE_VALIDATION_C_BATCHARITHMETIC_H
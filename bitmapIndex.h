@@ -0,0 +1,368 @@
+//
+// Compressed bitmap index over 32 bit person ids (roaring style).
+// Ids are grouped by their high 16 bits; each group is either a sorted array of the low 16 bits
+// (sparse, up to 4096 entries) or a 65536 bit bitmap (dense). Dense-dense AND/OR/ANDNOT and
+// popcount run 256 bits at a time with AVX2.
+//
+
+#ifndef EMPLOYEE_VALIDATION_C_BITMAPINDEX_H
+#define EMPLOYEE_VALIDATION_C_BITMAPINDEX_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "simd.h"
+
+inline unsigned popcount64(std::uint64_t x) {
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_popcountll(x));
+#else
+    unsigned n = 0;
+    for (; x != 0; x &= x - 1) ++n;
+    return n;
+#endif
+}
+
+inline unsigned trailingZeros64(std::uint64_t x) {
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_ctzll(x));
+#else
+    unsigned n = 0;
+    for (; (x & 1) == 0; x >>= 1) ++n;
+    return n;
+#endif
+}
+
+// ---- word kernels: out = a OP b, returns popcount of out (out may be nullptr to only count) ----
+
+enum class BitOp { And, Or, AndNot };
+
+template <BitOp Op>
+inline std::uint64_t combineWord(std::uint64_t a, std::uint64_t b) {
+    if (Op == BitOp::And) return a & b;
+    if (Op == BitOp::Or) return a | b;
+    return a & ~b;
+}
+
+template <BitOp Op>
+inline std::uint64_t combineWordsScalar(const std::uint64_t* a, const std::uint64_t* b, std::uint64_t* out,
+                                        std::size_t words) {
+    std::uint64_t count = 0;
+    for (std::size_t i = 0; i < words; ++i) {
+        std::uint64_t w = combineWord<Op>(a[i], b[i]);
+        if (out != nullptr) out[i] = w;
+        count += popcount64(w);
+    }
+    return count;
+}
+
+#if EV_X86_SIMD
+// popcount of each byte through a 16 entry nibble table (vpshufb), summed with vpsadbw
+EV_TARGET_AVX2 inline __m256i popcountBytesAvx2(__m256i v) {
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                           0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0f);
+    __m256i lo = _mm256_shuffle_epi8(table, _mm256_and_si256(v, low));
+    __m256i hi = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), low));
+    return _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256());
+}
+
+template <BitOp Op>
+EV_TARGET_AVX2 inline std::uint64_t combineWordsAvx2(const std::uint64_t* a, const std::uint64_t* b,
+                                                     std::uint64_t* out, std::size_t words) {
+    __m256i total = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + 4 <= words; i += 4) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        __m256i r;
+        if (Op == BitOp::And) r = _mm256_and_si256(x, y);
+        else if (Op == BitOp::Or) r = _mm256_or_si256(x, y);
+        else r = _mm256_andnot_si256(y, x);
+        if (out != nullptr) _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), r);
+        total = _mm256_add_epi64(total, popcountBytesAvx2(r));
+    }
+    std::uint64_t count = static_cast<std::uint64_t>(_mm256_extract_epi64(total, 0)) +
+                          static_cast<std::uint64_t>(_mm256_extract_epi64(total, 1)) +
+                          static_cast<std::uint64_t>(_mm256_extract_epi64(total, 2)) +
+                          static_cast<std::uint64_t>(_mm256_extract_epi64(total, 3));
+    return count + combineWordsScalar<Op>(a + i, b + i, out == nullptr ? nullptr : out + i, words - i);
+}
+#endif
+
+template <BitOp Op>
+inline std::uint64_t combineWords(const std::uint64_t* a, const std::uint64_t* b, std::uint64_t* out,
+                                  std::size_t words) {
+#if EV_X86_SIMD
+    if (cpuHasAvx2()) return combineWordsAvx2<Op>(a, b, out, words);
+#endif
+    return combineWordsScalar<Op>(a, b, out, words);
+}
+
+// ---- containers ----
+
+struct IdContainer {
+    static constexpr std::size_t kWords = 1024;          // 65536 bits
+    static constexpr std::size_t kArrayLimit = 4096;     // past this a bitmap is smaller
+
+    using Words = std::vector<std::uint64_t, AlignedAllocator<std::uint64_t>>;
+
+    bool dense = false;
+    std::vector<std::uint16_t> array;   // sorted, used when !dense
+    Words bits;                         // used when dense
+    std::uint32_t cardinality = 0;
+
+    bool contains(std::uint16_t low) const {
+        if (dense) return (bits[low >> 6] >> (low & 63)) & 1;
+        return std::binary_search(array.begin(), array.end(), low);
+    }
+
+    void add(std::uint16_t low) {
+        if (dense) {
+            std::uint64_t& word = bits[low >> 6];
+            std::uint64_t mask = std::uint64_t{1} << (low & 63);
+            cardinality += (word & mask) == 0;
+            word |= mask;
+            return;
+        }
+        // ids usually arrive in order, so check the end first
+        if (array.empty() || array.back() < low) {
+            array.push_back(low);
+        }
+        else {
+            auto at = std::lower_bound(array.begin(), array.end(), low);
+            if (at != array.end() && *at == low) return;
+            array.insert(at, low);
+        }
+        ++cardinality;
+        if (array.size() > kArrayLimit) toDense();
+    }
+
+    void toDense() {
+        bits.assign(kWords, 0);
+        for (std::uint16_t low : array) bits[low >> 6] |= std::uint64_t{1} << (low & 63);
+        array.clear();
+        array.shrink_to_fit();
+        dense = true;
+    }
+
+    // dense containers that became sparse go back to arrays
+    void shrinkIfSparse() {
+        if (!dense || cardinality > kArrayLimit) return;
+        array.clear();
+        array.reserve(cardinality);
+        for (std::size_t w = 0; w < kWords; ++w) {
+            for (std::uint64_t word = bits[w]; word != 0; word &= word - 1) {
+                array.push_back(static_cast<std::uint16_t>(w * 64 + trailingZeros64(word)));
+            }
+        }
+        bits = Words();
+        dense = false;
+    }
+
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        if (!dense) {
+            for (std::uint16_t low : array) fn(low);
+            return;
+        }
+        for (std::size_t w = 0; w < kWords; ++w) {
+            for (std::uint64_t word = bits[w]; word != 0; word &= word - 1) {
+                fn(static_cast<std::uint16_t>(w * 64 + trailingZeros64(word)));
+            }
+        }
+    }
+};
+
+template <BitOp Op>
+inline IdContainer combineContainers(const IdContainer& a, const IdContainer& b) {
+    IdContainer out;
+    if (a.dense && b.dense) {
+        out.dense = true;
+        out.bits.resize(IdContainer::kWords);
+        out.cardinality = static_cast<std::uint32_t>(combineWords<Op>(a.bits.data(), b.bits.data(), out.bits.data(), IdContainer::kWords));
+        out.shrinkIfSparse();
+        return out;
+    }
+    if (!a.dense && !b.dense) {
+        if (Op == BitOp::And) {
+            std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), std::back_inserter(out.array));
+        }
+        else if (Op == BitOp::Or) {
+            std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), std::back_inserter(out.array));
+        }
+        else {
+            std::set_difference(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), std::back_inserter(out.array));
+        }
+        out.cardinality = static_cast<std::uint32_t>(out.array.size());
+        if (out.array.size() > IdContainer::kArrayLimit) out.toDense();
+        return out;
+    }
+    // one sparse, one dense
+    if (Op == BitOp::And) {
+        const IdContainer& sparse = a.dense ? b : a;
+        const IdContainer& dense = a.dense ? a : b;
+        for (std::uint16_t low : sparse.array) {
+            if (dense.contains(low)) out.array.push_back(low);
+        }
+        out.cardinality = static_cast<std::uint32_t>(out.array.size());
+        return out;
+    }
+    if (Op == BitOp::Or) {
+        out = a.dense ? a : b;
+        for (std::uint16_t low : (a.dense ? b : a).array) out.add(low);
+        return out;
+    }
+    // AndNot
+    if (a.dense) {
+        out = a;
+        for (std::uint16_t low : b.array) {
+            std::uint64_t& word = out.bits[low >> 6];
+            std::uint64_t mask = std::uint64_t{1} << (low & 63);
+            out.cardinality -= (word & mask) != 0;
+            word &= ~mask;
+        }
+        out.shrinkIfSparse();
+        return out;
+    }
+    for (std::uint16_t low : a.array) {
+        if (!b.contains(low)) out.array.push_back(low);
+    }
+    out.cardinality = static_cast<std::uint32_t>(out.array.size());
+    return out;
+}
+
+// popcount of a OP b without building the result
+template <BitOp Op>
+inline std::uint64_t combineContainersCount(const IdContainer& a, const IdContainer& b) {
+    if (a.dense && b.dense) return combineWords<Op>(a.bits.data(), b.bits.data(), nullptr, IdContainer::kWords);
+    if (Op == BitOp::And) {
+        const IdContainer& sparse = a.dense ? b : a;
+        const IdContainer& other = a.dense ? a : b;
+        std::uint64_t count = 0;
+        for (std::uint16_t low : sparse.array) count += other.contains(low);
+        return count;
+    }
+    return combineContainers<Op>(a, b).cardinality;
+}
+
+// ---- the bitmap ----
+
+class IdBitmap {
+public:
+    void add(std::uint32_t id) {
+        std::uint16_t high = static_cast<std::uint16_t>(id >> 16);
+        containerFor(high).add(static_cast<std::uint16_t>(id & 0xFFFF));
+    }
+
+    bool contains(std::uint32_t id) const {
+        std::uint16_t high = static_cast<std::uint16_t>(id >> 16);
+        auto at = std::lower_bound(keys.begin(), keys.end(), high);
+        if (at == keys.end() || *at != high) return false;
+        return containers[static_cast<std::size_t>(at - keys.begin())].contains(static_cast<std::uint16_t>(id & 0xFFFF));
+    }
+
+    std::uint64_t cardinality() const {
+        std::uint64_t total = 0;
+        for (const IdContainer& c : containers) total += c.cardinality;
+        return total;
+    }
+
+    std::size_t memoryBytes() const {
+        std::size_t bytes = keys.size() * sizeof(std::uint16_t);
+        for (const IdContainer& c : containers) {
+            bytes += sizeof(IdContainer) + c.array.size() * sizeof(std::uint16_t) + c.bits.size() * sizeof(std::uint64_t);
+        }
+        return bytes;
+    }
+
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            std::uint32_t high = static_cast<std::uint32_t>(keys[i]) << 16;
+            containers[i].forEach([&](std::uint16_t low) { fn(high | low); });
+        }
+    }
+
+    friend IdBitmap operator&(const IdBitmap& a, const IdBitmap& b) { return combine<BitOp::And>(a, b); }
+    friend IdBitmap operator|(const IdBitmap& a, const IdBitmap& b) { return combine<BitOp::Or>(a, b); }
+    friend IdBitmap andNot(const IdBitmap& a, const IdBitmap& b) { return combine<BitOp::AndNot>(a, b); }
+
+    friend std::uint64_t andCount(const IdBitmap& a, const IdBitmap& b) { return combineCount<BitOp::And>(a, b); }
+    friend std::uint64_t andNotCount(const IdBitmap& a, const IdBitmap& b) { return combineCount<BitOp::AndNot>(a, b); }
+
+private:
+    IdContainer& containerFor(std::uint16_t high) {
+        if (!keys.empty() && keys.back() == high) return containers.back();
+        auto at = std::lower_bound(keys.begin(), keys.end(), high);
+        std::size_t index = static_cast<std::size_t>(at - keys.begin());
+        if (at == keys.end() || *at != high) {
+            keys.insert(at, high);
+            containers.insert(containers.begin() + static_cast<std::ptrdiff_t>(index), IdContainer());
+        }
+        return containers[index];
+    }
+
+    // walks both key lists like a merge
+    template <BitOp Op>
+    static IdBitmap combine(const IdBitmap& a, const IdBitmap& b) {
+        IdBitmap out;
+        std::size_t i = 0, j = 0;
+        while (i < a.keys.size() || j < b.keys.size()) {
+            bool takeA = j == b.keys.size() || (i < a.keys.size() && a.keys[i] < b.keys[j]);
+            bool takeB = i == a.keys.size() || (j < b.keys.size() && b.keys[j] < a.keys[i]);
+            if (takeA) {
+                if (Op != BitOp::And) out.push(a.keys[i], a.containers[i]);
+                ++i;
+            }
+            else if (takeB) {
+                if (Op == BitOp::Or) out.push(b.keys[j], b.containers[j]);
+                ++j;
+            }
+            else {
+                IdContainer c = combineContainers<Op>(a.containers[i], b.containers[j]);
+                if (c.cardinality != 0) out.push(a.keys[i], std::move(c));
+                ++i;
+                ++j;
+            }
+        }
+        return out;
+    }
+
+    template <BitOp Op>
+    static std::uint64_t combineCount(const IdBitmap& a, const IdBitmap& b) {
+        std::uint64_t count = 0;
+        std::size_t i = 0, j = 0;
+        while (i < a.keys.size() && j < b.keys.size()) {
+            if (a.keys[i] < b.keys[j]) {
+                if (Op == BitOp::AndNot) count += a.containers[i].cardinality;
+                ++i;
+            }
+            else if (b.keys[j] < a.keys[i]) {
+                ++j;
+            }
+            else {
+                count += combineContainersCount<Op>(a.containers[i], b.containers[j]);
+                ++i;
+                ++j;
+            }
+        }
+        if (Op == BitOp::AndNot) {
+            for (; i < a.keys.size(); ++i) count += a.containers[i].cardinality;
+        }
+        return count;
+    }
+
+    void push(std::uint16_t key, IdContainer container) {
+        keys.push_back(key);
+        containers.push_back(std::move(container));
+    }
+
+    std::vector<std::uint16_t> keys;   // sorted high halves
+    std::vector<IdContainer> containers;
+};
+
+#endif //EMPLOYEE_VALIDATION_C_BITMAPINDEX_H
@@ -0,0 +1,34 @@
+//
+// Car record shared by the learning_2 demo and the inventory engine.
+//
+
+#ifndef EMPLOYEE_VALIDATION_C_CAR_H
+#define EMPLOYEE_VALIDATION_C_CAR_H
+
+#include <string>
+#include <tuple>
+
+#include "registry.h"
+
+// Car structure Defined and named as Car
+struct Car {
+    int id;
+    std::string brand;
+    std::string model;
+    int year;
+};
+
+// Field descriptors for Registry<Car> - ids are unique, brands grouped, years ordered
+template <> struct RecordTraits<Car> {
+    static constexpr auto fields = std::make_tuple(field<FieldIndex::unique>("ID", &Car::id),
+                                                   field<FieldIndex::grouped>("Brand", &Car::brand),
+                                                   field("Model", &Car::model),
+                                                   field<FieldIndex::ordered>("Year", &Car::year));
+};
+
+// Display car - we displayed car as const so the data cant be modified and referred to c
+inline void displayCar(const Car& c) {
+    displayRecord(c);
+}
+
+#endif //EMPLOYEE_VALIDATION_C_CAR_H
@@ -0,0 +1,166 @@
+//
+// Bulk loading of vehicle catalog files into Registry<Car>.
+//
+// Catalog files have one car per line:   id,brand,model,year     e.g.  2,Ford,Mustang,1969
+// (spaces around the commas are allowed, an optional header line is skipped).
+//
+// The file is mapped, cut into chunks on line boundaries and the chunks are parsed by a pool of
+// threads straight out of the mapping - fields are string_views until the Car is built. The
+// registry then gets its capacity for every row up front and each car is moved in.
+//
+// The FileReadOptions overload reads through fileReader.h instead (read / mmap / io_uring
+// backends), parsing each block's whole lines in the buffer the block was read into.
+//
+
+#ifndef EMPLOYEE_VALIDATION_C_CARCATALOG_H
+#define EMPLOYEE_VALIDATION_C_CARCATALOG_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "car.h"
+#include "fileReader.h"
+#include "mappedFile.h"
+#include "registry.h"
+
+struct CatalogLoadStats {
+    std::uint64_t rows = 0;         // cars now in the registry
+    std::uint64_t malformed = 0;    // lines that are not id,brand,model,year
+    std::uint64_t duplicates = 0;   // well formed lines whose id was already taken
+};
+
+inline bool isFieldSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+// [-]digits with spaces around them, ending at a comma (separator) or the end of the line
+inline bool scanIntField(const char*& p, const char* end, char separator, int& value) {
+    while (p < end && isFieldSpace(*p)) ++p;
+    bool negative = p < end && *p == '-';
+    p += negative;
+    const char* digits = p;
+    std::int64_t number = 0;
+    while (p < end && *p >= '0' && *p <= '9' && p - digits < 10) number = number * 10 + (*p++ - '0');
+    if (p == digits) return false;
+    while (p < end && isFieldSpace(*p)) ++p;
+    if ((p < end && *p != separator) || number > 2147483647 + std::int64_t{negative}) return false;
+    value = static_cast<int>(negative ? -number : number);
+    return true;
+}
+
+// text up to the next comma, without the spaces around it
+inline bool scanTextField(const char*& p, const char* end, std::string& value) {
+    const char* comma = static_cast<const char*>(std::memchr(p, ',', static_cast<std::size_t>(end - p)));
+    if (comma == nullptr) return false;
+    const char* first = p;
+    const char* last = comma;
+    p = comma;
+    while (first < last && isFieldSpace(*first)) ++first;
+    while (last > first && isFieldSpace(last[-1])) --last;
+    if (first == last) return false;
+    value.assign(first, last);
+    return true;
+}
+
+// steps over the comma a field stopped on; false at the end of the line (a field is missing)
+inline bool skipComma(const char*& p, const char* end) {
+    if (p == end || *p != ',') return false;
+    ++p;
+    return true;
+}
+
+// One catalog line (without its newline), in a single pass; false when it is malformed
+inline bool parseCarLine(std::string_view line, Car& car) {
+    const char* p = line.data();
+    const char* end = p + line.size();
+    return scanIntField(p, end, ',', car.id) && skipComma(p, end) &&
+           scanTextField(p, end, car.brand) && skipComma(p, end) &&
+           scanTextField(p, end, car.model) && skipComma(p, end) &&
+           scanIntField(p, end, ',', car.year) && p == end;
+}
+
+inline void parseCarChunk(std::string_view chunk, std::vector<Car>& cars, std::uint64_t& malformed) {
+    cars.reserve(chunk.size() / 16);   // first guess at the line count, short lines just grow it
+    const char* p = chunk.data();
+    const char* end = p + chunk.size();
+    Car car{};
+    while (p < end) {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+        if (newline == nullptr) newline = end;
+        std::string_view line(p, static_cast<std::size_t>(newline - p));
+        p = newline + 1;
+        if (line.empty() || (line.size() == 1 && line[0] == '\r')) continue;
+        if (parseCarLine(line, car)) cars.push_back(std::move(car));
+        else ++malformed;
+    }
+}
+
+// Moves the parsed parts into the registry in order, freeing each part as it goes
+inline bool addCarParts(std::vector<std::vector<Car>>& parts, const std::vector<std::uint64_t>& bad,
+                        Registry<Car>& cars, CatalogLoadStats& stats, std::string& error) {
+    std::size_t total = cars.size();
+    for (const auto& part : parts) total += part.size();
+    if (total >= Registry<Car>::npos) {
+        error = "too many cars for one registry";
+        return false;
+    }
+    stats = CatalogLoadStats{};
+    cars.reserve(total);
+    for (std::size_t c = 0; c < parts.size(); ++c) {
+        stats.duplicates += cars.addAll(parts[c]);
+        std::vector<Car>().swap(parts[c]);   // give each part back as soon as it is moved in
+        stats.malformed += bad[c];
+    }
+    stats.rows = cars.size();
+    return true;
+}
+
+// Loads every car of the catalog into cars (appended to what is there already)
+inline bool loadCarCatalog(const std::string& path, unsigned threads, Registry<Car>& cars,
+                           CatalogLoadStats& stats, std::string& error) {
+    MappedFile input;
+    if (!input.open(path)) {
+        error = "cannot read " + path;
+        return false;
+    }
+    if (threads == 0) threads = 1;
+
+    // more chunks than threads: a slow chunk does not hold up a whole thread's share, and the
+    // parsed cars are handed to the registry (and freed) a chunk at a time
+    std::vector<std::string_view> chunks = splitOnLineBoundaries(skipHeader(input.view()), static_cast<std::size_t>(threads) * 8);
+    std::vector<std::vector<Car>> parts(chunks.size());
+    std::vector<std::uint64_t> bad(chunks.size(), 0);
+    std::atomic<std::size_t> nextChunk{0};
+    auto worker = [&] {
+        for (std::size_t c = nextChunk.fetch_add(1); c < chunks.size(); c = nextChunk.fetch_add(1)) {
+            parseCarChunk(chunks[c], parts[c], bad[c]);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& thread : pool) thread.join();
+
+    return addCarParts(parts, bad, cars, stats, error);
+}
+
+// Same, read block by block with the chosen backend; options.workers threads parse
+inline bool loadCarCatalog(const std::string& path, const FileReadOptions& options, Registry<Car>& cars,
+                           CatalogLoadStats& stats, FileReadStats& readStats, std::string& error) {
+    std::vector<std::vector<Car>> parts;
+    std::vector<std::uint64_t> bad;
+    bool ok = readFileLines(path, options, [&](std::size_t slots) {
+        parts.resize(slots);
+        bad.assign(slots, 0);
+    }, [&](std::size_t slot, std::string_view lines) {
+        parseCarChunk(slot == 0 ? skipHeader(lines) : lines, parts[slot], bad[slot]);
+    }, readStats, error);
+    return ok && addCarParts(parts, bad, cars, stats, error);
+}
+
+#endif //EMPLOYEE_VALIDATION_C_CARCATALOG_H
@@ -0,0 +1,255 @@
+//
+// Voter eligibility rules shared by the interactive prompts and the batch screener.
+//
+// Population files have one person per line:   id,age,citizen     e.g.  1001,34,yes
+// The same rules as the prompts apply: age must be digits and > 0, 18 or older can vote,
+// citizen must be yes or no (any case, y/n and true/false are accepted too).
+//
+
+#ifndef EMPLOYEE_VALIDATION_C_ELIGIBILITY_H
+#define EMPLOYEE_VALIDATION_C_ELIGIBILITY_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "asciiFold.h"
+#include "bitmapIndex.h"
+#include "mappedFile.h"
+
+enum class AgeStatus : std::uint8_t { Invalid, Minor, Adult };
+
+inline AgeStatus classifyAge(int age) {
+    if (age <= 0) return AgeStatus::Invalid;
+    if (age < 18) return AgeStatus::Minor;
+    return AgeStatus::Adult;
+}
+
+enum class CitizenAnswer : std::uint8_t { No, Yes, Unknown };
+
+// yes/y/true or no/n/false in any case, matched without building a lowered copy
+inline CitizenAnswer parseCitizenAnswer(std::string_view text) {
+    switch (matchKeyword(text)) {
+    case Keyword::Yes:
+    case Keyword::True:
+        return CitizenAnswer::Yes;
+    case Keyword::No:
+    case Keyword::False:
+        return CitizenAnswer::No;
+    default:
+        return CitizenAnswer::Unknown;
+    }
+}
+
+struct PersonRow {
+    std::uint64_t id = 0;
+    int age = 0;
+    CitizenAnswer citizen = CitizenAnswer::Unknown;
+    std::string_view idText;   // points into the input buffer
+};
+
+// Parses the line starting at cursor and moves cursor past its newline.
+// Returns false for malformed lines (cursor still moves on).
+inline bool parsePersonRow(const char*& cursor, const char* end, PersonRow& row) {
+    const char* p = cursor;
+    const char* lineEnd = p;
+    while (lineEnd < end && *lineEnd != '\n') ++lineEnd;
+    cursor = lineEnd < end ? lineEnd + 1 : end;
+    if (lineEnd > p && lineEnd[-1] == '\r') --lineEnd;
+
+    // id
+    const char* idStart = p;
+    std::uint64_t id = 0;
+    while (p < lineEnd && *p >= '0' && *p <= '9') id = id * 10 + static_cast<std::uint64_t>(*p++ - '0');
+    if (p == idStart || p == lineEnd || *p != ',') return false;
+    row.idText = std::string_view(idStart, static_cast<std::size_t>(p - idStart));
+    row.id = id;
+    ++p;
+
+    // age - digits only, like isAllDigits in the prompt
+    const char* ageStart = p;
+    int age = 0;
+    while (p < lineEnd && *p >= '0' && *p <= '9' && p - ageStart < 9) age = age * 10 + (*p++ - '0');
+    if (p == ageStart || p == lineEnd || *p != ',') return false;
+    row.age = age;
+    ++p;
+
+    row.citizen = parseCitizenAnswer(std::string_view(p, static_cast<std::size_t>(lineEnd - p)));
+    return row.citizen != CitizenAnswer::Unknown;
+}
+
+struct EligibilityCounts {
+    std::uint64_t rows = 0;
+    std::uint64_t malformed = 0;
+    std::uint64_t invalidAge = 0;
+    std::uint64_t minors = 0;
+    std::uint64_t nonCitizens = 0;   // adults who answered no
+    std::uint64_t eligible = 0;
+
+    void merge(const EligibilityCounts& other) {
+        rows += other.rows;
+        malformed += other.malformed;
+        invalidAge += other.invalidAge;
+        minors += other.minors;
+        nonCitizens += other.nonCitizens;
+        eligible += other.eligible;
+    }
+};
+
+// Screens one chunk of lines, appends "id\n" for every eligible person to eligibleIds
+inline void screenChunk(std::string_view chunk, EligibilityCounts& counts, std::string& eligibleIds) {
+    const char* cursor = chunk.data();
+    const char* end = cursor + chunk.size();
+    PersonRow row;
+    while (cursor < end) {
+        if (*cursor == '\n' || *cursor == '\r') {   // blank line
+            ++cursor;
+            continue;
+        }
+        ++counts.rows;
+        if (!parsePersonRow(cursor, end, row)) {
+            ++counts.malformed;
+            continue;
+        }
+        AgeStatus status = classifyAge(row.age);
+        if (status == AgeStatus::Invalid) {
+            ++counts.invalidAge;
+        }
+        else if (status == AgeStatus::Minor) {
+            ++counts.minors;
+        }
+        else if (row.citizen != CitizenAnswer::Yes) {
+            ++counts.nonCitizens;
+        }
+        else {
+            ++counts.eligible;
+            eligibleIds.append(row.idText.data(), row.idText.size());   // the id text is copied as is, no formatting
+            eligibleIds.push_back('\n');
+        }
+    }
+}
+
+// Parallel batch screening of a population file. Chunks are handed out dynamically so a slow
+// chunk does not hold up a whole thread's share; eligible ids are written in input order.
+inline bool runEligibilityBatch(const std::string& inputPath, const std::string& outputPath,
+                                unsigned threads, EligibilityCounts& total) {
+    MappedFile input;
+    if (!input.open(inputPath)) return false;
+    if (threads == 0) threads = 1;
+
+    std::string_view text = skipHeader(input.view());
+    std::vector<std::string_view> chunks = splitOnLineBoundaries(text, static_cast<std::size_t>(threads) * 8);
+    std::vector<std::string> outputs(chunks.size());
+    std::vector<EligibilityCounts> perThread(threads);
+    std::atomic<std::size_t> nextChunk{0};
+
+    auto worker = [&](unsigned t) {
+        for (std::size_t c = nextChunk.fetch_add(1); c < chunks.size(); c = nextChunk.fetch_add(1)) {
+            outputs[c].reserve(chunks[c].size() / 2);
+            screenChunk(chunks[c], perThread[t], outputs[c]);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker, t);
+    worker(0);
+    for (auto& thread : pool) thread.join();
+
+    total = EligibilityCounts{};
+    for (const auto& counts : perThread) total.merge(counts);
+
+    std::FILE* out = std::fopen(outputPath.c_str(), "wb");
+    if (out == nullptr) return false;
+    bool ok = true;
+    for (const std::string& ids : outputs) {
+        if (!ids.empty() && std::fwrite(ids.data(), 1, ids.size(), out) != ids.size()) ok = false;
+    }
+    return std::fclose(out) == 0 && ok;
+}
+
+// One bitmap per predicate, all over person ids. Questions like
+// "citizens who are 18+ and not registered yet" become (citizens & adults) minus registered.
+struct EligibilityIndexes {
+    IdBitmap people;     // every well formed row
+    IdBitmap validAge;   // age > 0
+    IdBitmap adults;     // age >= 18
+    IdBitmap citizens;   // answered yes
+    std::uint64_t skippedIds = 0;   // ids that do not fit in 32 bits
+};
+
+inline void indexChunk(std::string_view chunk, EligibilityIndexes& indexes) {
+    const char* cursor = chunk.data();
+    const char* end = cursor + chunk.size();
+    PersonRow row;
+    while (cursor < end) {
+        if (*cursor == '\n' || *cursor == '\r') {
+            ++cursor;
+            continue;
+        }
+        if (!parsePersonRow(cursor, end, row)) continue;
+        if (row.id > 0xFFFFFFFFull) {
+            ++indexes.skippedIds;
+            continue;
+        }
+        std::uint32_t id = static_cast<std::uint32_t>(row.id);
+        indexes.people.add(id);
+        AgeStatus status = classifyAge(row.age);
+        if (status != AgeStatus::Invalid) indexes.validAge.add(id);
+        if (status == AgeStatus::Adult) indexes.adults.add(id);
+        if (row.citizen == CitizenAnswer::Yes) indexes.citizens.add(id);
+    }
+}
+
+// Builds the predicate bitmaps in parallel (one set per chunk, OR-ed together at the end)
+inline bool buildEligibilityIndexes(const std::string& inputPath, unsigned threads, EligibilityIndexes& indexes) {
+    MappedFile input;
+    if (!input.open(inputPath)) return false;
+    if (threads == 0) threads = 1;
+
+    std::vector<std::string_view> chunks = splitOnLineBoundaries(skipHeader(input.view()), threads);
+    std::vector<EligibilityIndexes> partial(chunks.size());
+    std::vector<std::thread> pool;
+    for (std::size_t c = 1; c < chunks.size(); ++c) {
+        pool.emplace_back([&, c] { indexChunk(chunks[c], partial[c]); });
+    }
+    if (!chunks.empty()) indexChunk(chunks[0], partial[0]);
+    for (auto& thread : pool) thread.join();
+
+    indexes = EligibilityIndexes{};
+    for (EligibilityIndexes& part : partial) {
+        indexes.people = indexes.people | part.people;
+        indexes.validAge = indexes.validAge | part.validAge;
+        indexes.adults = indexes.adults | part.adults;
+        indexes.citizens = indexes.citizens | part.citizens;
+        indexes.skippedIds += part.skippedIds;
+    }
+    return true;
+}
+
+// A plain list of ids, one per line (e.g. people already registered to vote)
+inline bool loadIdBitmap(const std::string& path, IdBitmap& ids) {
+    MappedFile input;
+    if (!input.open(path)) return false;
+    std::string_view text = input.view();
+    std::uint64_t value = 0;
+    bool inNumber = false;
+    for (char c : text) {
+        if (c >= '0' && c <= '9') {
+            value = value * 10 + static_cast<std::uint64_t>(c - '0');
+            inNumber = true;
+        }
+        else {
+            if (inNumber && value <= 0xFFFFFFFFull) ids.add(static_cast<std::uint32_t>(value));
+            value = 0;
+            inNumber = false;
+        }
+    }
+    if (inNumber && value <= 0xFFFFFFFFull) ids.add(static_cast<std::uint32_t>(value));
+    return true;
+}
+
+#endif //EMPLOYEE_VALIDATION_C_ELIGIBILITY_H
@@ -0,0 +1,338 @@
+//
+// Eligibility rules loaded from a text file at runtime and compiled into a flat decision table,
+// so a jurisdiction with different rules is a new rules file, not a rebuild.
+//
+// Rules file, first matching rule wins:
+//
+//     # comment
+//     reject invalid_age when age <= 0
+//     reject minor       when age < 18
+//     reject non_citizen when citizen == no
+//     accept eligible
+//
+// Conditions are  <field> <op> <value>  joined with "and"; fields are age and citizen
+// (yes/no), ops are < <= > >= == !=. Every condition compiles to an inclusive range check
+// (optionally negated), and evaluation runs rule by rule over a block of rows with no
+// per-row branches, which lets the compiler vectorize it.
+//
+
+#ifndef EMPLOYEE_VALIDATION_C_ELIGIBILITYRULES_H
+#define EMPLOYEE_VALIDATION_C_ELIGIBILITYRULES_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "asciiFold.h"
+#include "eligibility.h"
+#include "mappedFile.h"
+
+// the getValidAge / isCitizenValidation rules, used when no rules file is given
+constexpr const char* kDefaultEligibilityRules =
+    "reject invalid_age when age <= 0\n"
+    "reject minor when age < 18\n"
+    "reject non_citizen when citizen == no\n"
+    "accept eligible\n";
+
+enum class RuleField : std::uint8_t { Age, Citizen, Count };
+
+struct RuleCondition {
+    RuleField field;
+    std::int32_t low;    // inclusive
+    std::int32_t high;   // inclusive
+    std::uint8_t negate;
+};
+
+struct CompiledRules {
+    static constexpr std::uint8_t kUndecided = 0xFF;
+
+    std::vector<std::string> outcomeNames;
+    std::vector<std::uint8_t> outcomeAccepts;   // 1 for accept rules
+
+    // flat decision table: rule r owns conditions[ruleStart[r] .. ruleStart[r + 1])
+    std::vector<RuleCondition> conditions;
+    std::vector<std::uint32_t> ruleStart{0};
+    std::vector<std::uint8_t> ruleOutcome;
+    std::uint8_t unmatchedOutcome = kUndecided;   // outcome of rows no rule matched
+
+    std::size_t ruleCount() const { return ruleOutcome.size(); }
+
+    std::uint8_t outcomeId(const std::string& name, bool accepts) {
+        for (std::size_t i = 0; i < outcomeNames.size(); ++i) {
+            if (outcomeNames[i] == name) return static_cast<std::uint8_t>(i);
+        }
+        outcomeNames.push_back(name);
+        outcomeAccepts.push_back(accepts ? 1 : 0);
+        return static_cast<std::uint8_t>(outcomeNames.size() - 1);
+    }
+};
+
+inline bool compileCondition(const std::string& fieldText, const std::string& op, const std::string& valueText,
+                             RuleCondition& condition, std::string& error) {
+    if (fieldText == "age") condition.field = RuleField::Age;
+    else if (fieldText == "citizen") condition.field = RuleField::Citizen;
+    else {
+        error = "unknown field '" + fieldText + "'";
+        return false;
+    }
+
+    std::int32_t value;
+    Keyword keyword = matchKeyword(valueText);
+    if (keyword == Keyword::Yes || keyword == Keyword::True) value = 1;
+    else if (keyword == Keyword::No || keyword == Keyword::False) value = 0;
+    else {
+        std::size_t used = 0;
+        try {
+            value = std::stoi(valueText, &used);
+        }
+        catch (...) {
+            used = 0;
+        }
+        if (used == 0 || used != valueText.size()) {
+            error = "bad value '" + valueText + "'";
+            return false;
+        }
+    }
+
+    const std::int32_t lowest = std::numeric_limits<std::int32_t>::min();
+    const std::int32_t highest = std::numeric_limits<std::int32_t>::max();
+    condition.negate = 0;
+    // < lowest and > highest match nothing: low above high is an empty range
+    if (op == "<") {
+        condition.low = value == lowest ? highest : lowest;
+        condition.high = value == lowest ? lowest : value - 1;
+    }
+    else if (op == "<=") { condition.low = lowest; condition.high = value; }
+    else if (op == ">") {
+        condition.low = value == highest ? highest : value + 1;
+        condition.high = value == highest ? lowest : highest;
+    }
+    else if (op == ">=") { condition.low = value; condition.high = highest; }
+    else if (op == "==") { condition.low = value; condition.high = value; }
+    else if (op == "!=") { condition.low = value; condition.high = value; condition.negate = 1; }
+    else {
+        error = "unknown operator '" + op + "'";
+        return false;
+    }
+    return true;
+}
+
+inline bool compileRules(std::string_view text, CompiledRules& rules, std::string& error) {
+    rules = CompiledRules{};
+    std::istringstream lines{std::string(text)};
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(lines, line)) {
+        ++lineNumber;
+        std::size_t hash = line.find('#');
+        if (hash != std::string::npos) line.resize(hash);
+        std::istringstream words(line);
+        std::string action, name;
+        if (!(words >> action)) continue;   // blank line
+
+        auto fail = [&](const std::string& message) {
+            error = "line " + std::to_string(lineNumber) + ": " + message;
+            return false;
+        };
+        if ((action != "accept" && action != "reject") || !(words >> name)) {
+            return fail("expected 'accept <name>' or 'reject <name>'");
+        }
+        if (name == "unmatched") return fail("'unmatched' is reserved for rows no rule matches");
+        if (rules.ruleCount() >= CompiledRules::kUndecided) return fail("too many rules");
+
+        std::string keyword;
+        if (words >> keyword) {
+            if (keyword != "when") return fail("expected 'when'");
+            do {
+                std::string field, op, value;
+                if (!(words >> field >> op >> value)) return fail("expected '<field> <op> <value>'");
+                RuleCondition condition;
+                std::string conditionError;
+                if (!compileCondition(field, op, value, condition, conditionError)) return fail(conditionError);
+                rules.conditions.push_back(condition);
+                keyword.clear();
+            } while (words >> keyword && keyword == "and");
+            if (!keyword.empty()) return fail("unexpected '" + keyword + "'");
+        }
+        rules.ruleOutcome.push_back(rules.outcomeId(name, action == "accept"));
+        rules.ruleStart.push_back(static_cast<std::uint32_t>(rules.conditions.size()));
+    }
+    if (rules.ruleCount() == 0) {
+        error = "no rules";
+        return false;
+    }
+    // rows no rule matched
+    rules.unmatchedOutcome = rules.outcomeId("unmatched", false);
+    return true;
+}
+
+inline bool loadRules(const std::string& path, CompiledRules& rules, std::string& error) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::stringstream text;
+    text << in.rdbuf();
+    return compileRules(text.str(), rules, error);
+}
+
+// Evaluates every row of a columnar batch; outcome[i] gets the outcome id of the first matching rule.
+// columns[field] points at that field's values (citizen is 1 for yes, 0 for no).
+inline void evaluateRules(const CompiledRules& rules, const std::int32_t* const columns[],
+                          std::size_t n, std::uint8_t* outcome) {
+    constexpr std::size_t kBlock = 256;
+    const std::uint8_t unmatched = rules.unmatchedOutcome;
+    std::uint8_t match[kBlock];
+
+    for (std::size_t base = 0; base < n; base += kBlock) {
+        const std::size_t count = std::min(kBlock, n - base);
+        std::uint8_t* out = outcome + base;
+        for (std::size_t i = 0; i < count; ++i) out[i] = CompiledRules::kUndecided;
+
+        for (std::size_t r = 0; r < rules.ruleCount(); ++r) {
+            for (std::size_t i = 0; i < count; ++i) match[i] = 1;
+            for (std::uint32_t c = rules.ruleStart[r]; c < rules.ruleStart[r + 1]; ++c) {
+                const RuleCondition& condition = rules.conditions[c];
+                const std::int32_t* values = columns[static_cast<std::size_t>(condition.field)] + base;
+                const std::int32_t low = condition.low;
+                const std::int32_t high = condition.high;
+                const std::uint8_t negate = condition.negate;
+                for (std::size_t i = 0; i < count; ++i) {
+                    std::uint8_t inRange = static_cast<std::uint8_t>((values[i] >= low) & (values[i] <= high));
+                    match[i] &= static_cast<std::uint8_t>(inRange ^ negate);
+                }
+            }
+            const std::uint8_t ruleOutcome = rules.ruleOutcome[r];
+            std::uint8_t pending = 0;
+            for (std::size_t i = 0; i < count; ++i) {
+                std::uint8_t take = static_cast<std::uint8_t>((out[i] == CompiledRules::kUndecided) & match[i]);
+                out[i] = take ? ruleOutcome : out[i];
+                pending |= static_cast<std::uint8_t>(out[i] == CompiledRules::kUndecided);
+            }
+            if (!pending) break;   // whole block decided, later rules cannot change anything
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            out[i] = out[i] == CompiledRules::kUndecided ? unmatched : out[i];
+        }
+    }
+}
+
+// One block of rows in columnar form; ids point into the mapped input
+struct RuleBatch {
+    std::vector<std::int32_t> ages;
+    std::vector<std::int32_t> citizens;
+    std::vector<std::string_view> ids;
+    std::vector<std::uint8_t> outcomes;
+
+    void clear() {
+        ages.clear();
+        citizens.clear();
+        ids.clear();
+    }
+};
+
+// Parses rows until the batch holds maxRows; returns bytes consumed
+inline std::size_t fillRuleBatch(std::string_view text, RuleBatch& batch, std::size_t maxRows, std::uint64_t& malformed) {
+    const char* cursor = text.data();
+    const char* end = cursor + text.size();
+    PersonRow row;
+    while (cursor < end && batch.ages.size() < maxRows) {
+        if (*cursor == '\n' || *cursor == '\r') {
+            ++cursor;
+            continue;
+        }
+        if (!parsePersonRow(cursor, end, row)) {
+            ++malformed;
+            continue;
+        }
+        batch.ages.push_back(row.age);
+        batch.citizens.push_back(row.citizen == CitizenAnswer::Yes ? 1 : 0);
+        batch.ids.push_back(row.idText);
+    }
+    return static_cast<std::size_t>(cursor - text.data());
+}
+
+inline void evaluateRules(const CompiledRules& rules, RuleBatch& batch) {
+    const std::int32_t* columns[static_cast<std::size_t>(RuleField::Count)];
+    columns[static_cast<std::size_t>(RuleField::Age)] = batch.ages.data();
+    columns[static_cast<std::size_t>(RuleField::Citizen)] = batch.citizens.data();
+    batch.outcomes.resize(batch.ages.size());
+    evaluateRules(rules, columns, batch.ages.size(), batch.outcomes.data());
+}
+
+struct RuleRunCounts {
+    std::vector<std::uint64_t> outcomes;   // indexed like CompiledRules::outcomeNames
+    std::uint64_t malformed = 0;
+
+    void merge(const RuleRunCounts& other) {
+        outcomes.resize(std::max(outcomes.size(), other.outcomes.size()), 0);
+        for (std::size_t i = 0; i < other.outcomes.size(); ++i) outcomes[i] += other.outcomes[i];
+        malformed += other.malformed;
+    }
+};
+
+// Like runEligibilityBatch but driven by a rules table: ids whose outcome is an accept rule are
+// written to outputPath in input order
+inline bool runRulesBatch(const std::string& inputPath, const std::string& outputPath, const CompiledRules& rules,
+                          unsigned threads, RuleRunCounts& total) {
+    MappedFile input;
+    if (!input.open(inputPath)) return false;
+    if (threads == 0) threads = 1;
+
+    std::vector<std::string_view> chunks = splitOnLineBoundaries(skipHeader(input.view()),
+                                                                 static_cast<std::size_t>(threads) * 8);
+    std::vector<std::string> outputs(chunks.size());
+    std::vector<RuleRunCounts> perThread(threads);
+    std::atomic<std::size_t> nextChunk{0};
+
+    auto worker = [&](unsigned t) {
+        constexpr std::size_t kBatchRows = 4096;
+        RuleBatch batch;
+        RuleRunCounts& counts = perThread[t];
+        counts.outcomes.assign(rules.outcomeNames.size(), 0);
+        for (std::size_t c = nextChunk.fetch_add(1); c < chunks.size(); c = nextChunk.fetch_add(1)) {
+            std::string_view rest = chunks[c];
+            while (!rest.empty()) {
+                batch.clear();
+                rest.remove_prefix(fillRuleBatch(rest, batch, kBatchRows, counts.malformed));
+                evaluateRules(rules, batch);
+                for (std::size_t i = 0; i < batch.ids.size(); ++i) {
+                    std::uint8_t outcome = batch.outcomes[i];
+                    ++counts.outcomes[outcome];
+                    if (rules.outcomeAccepts[outcome]) {
+                        outputs[c].append(batch.ids[i].data(), batch.ids[i].size());
+                        outputs[c].push_back('\n');
+                    }
+                }
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker, t);
+    worker(0);
+    for (auto& thread : pool) thread.join();
+
+    total = RuleRunCounts{};
+    total.outcomes.assign(rules.outcomeNames.size(), 0);
+    for (const auto& counts : perThread) total.merge(counts);
+
+    std::FILE* out = std::fopen(outputPath.c_str(), "wb");
+    if (out == nullptr) return false;
+    bool ok = true;
+    for (const std::string& ids : outputs) {
+        if (!ids.empty() && std::fwrite(ids.data(), 1, ids.size(), out) != ids.size()) ok = false;
+    }
+    return std::fclose(out) == 0 && ok;
+}
+
+#endif //EMPLOYEE_VALIDATION_C_ELIGIBILITYRULES_H
@@ -1,29 +1,20 @@
 ﻿#include <iostream>
 #include <string>
-#include <vector>
+#include <fstream>
 #include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <csignal>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <vector>
 
-// Helper: digits only - it will check to see if user enters only numbers as id not words
-bool isAllDigits(const std::string& s) {
-    if (s.empty()) return false;
-    for (char c : s) {
-        if (!std::isdigit(c)) {
-            return false;
-        }
-    }
-    return true;
-}
-
-// Helper: letters and spaces only -  it will check to see if user does not enter numbers
-bool isAllLetters(const std::string& s) {
-    if (s.empty()) return false;
-    for (char c : s) {
-        if (!std::isalpha(c) && c != ' ') {
-            return false;
-        }
-    }
-    return true;
-}
+#include "employee.h"
+#include "registrationSession.h"
+#include "registryServer.h"
+#include "registrySnapshot.h"
 
 // Helper: convert to uppercase will convert data entered by user to upper case to remove mismatch confusion
 // std::string toUpper(std::string s) {
@@ -33,126 +24,249 @@ bool isAllLetters(const std::string& s) {
 //     return s;
 // }
 
-//  Employee ID validation
-int getValidEmployeeId() {
-    std::string input;
-    /*entered string cause it will check if any un-necessary words entered by user if not
-     *our code will break if user enters "28jgh" instead of 28 it will be read here*/
-
-    while (true) {
-        std::cout << "Enter Employee ID: ";
-        std::cin >> input;
-
-        if (!isAllDigits(input)) {
-            /* we validated the string we have given above if user enters "28hgyd" it will be verified here and we call upon the
-             * function isAllDigits and prove it with ! not operator - we are passing the input data entyered by user to above function and validating*/
-            std::cout << "Invalid ID. Numbers only.\n";
-            continue;
-        }
-
-        int id = std::stoi(input); // since we stared with string to verify user input we need a conversion of string to int when user enters correct integer value
-
-        if (id <= 0) {              // making sure user enters positive integer
-            std::cout << "Employee ID must be positive.\n";
-            continue;
-        }
-        return id;
-    }
+// Registry files: compressed snapshots when the name ends in .evz, the plain binary format otherwise
+bool isSnapshotPath(const std::string& path) {
+    return path.size() > 4 && path.compare(path.size() - 4, 4, ".evz") == 0;
 }
 
-// Name validation
-std::string getValidName() {
-    std::string name;
+bool loadEmployees(Registry<Employee>& employees, const std::string& path, std::string& error) {
+    return isSnapshotPath(path) ? loadRegistrySnapshot(employees, path, std::max(1u, std::thread::hardware_concurrency()), error)
+                                : employees.load(path, error);
+}
 
-    std::cin.ignore(); //its is to support the getline code to remove the enter option after user enters the input
-    while (true) {
-        std::cout << "Enter Employee Name: ";
-        std::getline(std::cin, name);
-        /*we are using getline([&]std --> instead of cin>>name bacause th euser input can be more the multiple charaters
-        like std::cin >> name reads only "John" "Doe" stays in the buffer.*/
-
-        if (!isAllLetters(name)) {
-            std::cout << "Name must contain letters only.\n";
-            continue;
-        }
+bool saveEmployees(const Registry<Employee>& employees, const std::string& path, std::string& error) {
+    return isSnapshotPath(path) ? saveRegistrySnapshot(employees, path, std::max(1u, std::thread::hardware_concurrency()), error)
+                                : employees.save(path, error);
+}
 
-        return name;
+// synthetic staff: ascending ids, names from a few hundred first / last name pairs, 12 departments
+void fillSyntheticStaff(Registry<Employee>& employees, std::size_t rows) {
+    static const char* first[] = {"James", "Mary", "Robert", "Patricia", "John", "Jennifer", "Michael", "Linda",
+                                  "David", "Elizabeth", "William", "Barbara", "Richard", "Susan", "Joseph", "Jessica",
+                                  "Thomas", "Sarah", "Charles", "Karen"};
+    static const char* last[] = {"Smith", "Johnson", "Williams", "Brown", "Jones", "Garcia", "Miller", "Davis",
+                                 "Rodriguez", "Martinez", "Hernandez", "Lopez", "Gonzalez", "Wilson", "Anderson", "Thomas",
+                                 "Taylor", "Moore", "Jackson", "Martin"};
+    static const char* departments[] = {"Sales", "Engineering", "Finance", "Marketing", "Operations", "Support",
+                                        "Legal", "Research", "Logistics", "Procurement", "Security", "Training"};
+    std::vector<Employee> staff;
+    staff.reserve(rows);
+    std::uint32_t state = 2463534242u;
+    int id = 1000;
+    for (std::size_t r = 0; r < rows; ++r) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        id += 1 + static_cast<int>(state % 3);
+        staff.push_back(Employee{id, std::string(first[state % 20]) + " " + last[(state >> 5) % 20],
+                                 departments[(state >> 10) % 12], 30000.0 + 500.0 * static_cast<double>((state >> 14) % 240)});
     }
+    employees.addAll(staff);
 }
 
-//  Department validation
-std::string getValidDepartment() {
-    std::string dept;
+// --snapshot-bench [rows] [threads] - plain binary registry file against the compressed snapshot,
+// and a CSV export packed in blocks; load and decompression speeds use every thread
+int runSnapshotBenchmark(std::size_t rows, unsigned threads) {
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::time_point a, Clock::time_point b) { return std::chrono::duration<double, std::milli>(b - a).count(); };
+    auto mbPerSecond = [](std::size_t bytes, double millis) { return static_cast<double>(bytes) / (1024.0 * 1024.0) / (millis / 1000.0); };
+    Registry<Employee> employees;
+    fillSyntheticStaff(employees, rows);
+    std::string error;
 
-    while (true) {
-        std::cout << "Enter Department: ";
-        std::getline(std::cin, dept);
+    std::string plain;
+    auto t0 = Clock::now();
+    employees.serialize(plain);
+    auto t1 = Clock::now();
+    std::string snapshot = encodeRegistrySnapshot(employees, threads);
+    auto t2 = Clock::now();
+    Registry<Employee> fromPlain, fromSnapshot;
+    bool ok = fromPlain.deserialize(plain, error);
+    auto t3 = Clock::now();
+    ok = ok && decodeRegistrySnapshot(snapshot, threads, fromSnapshot, error);
+    auto t4 = Clock::now();
+    if (!ok) {
+        std::cout << error << "\n";
+        return 1;
+    }
+    // the codec alone: every block decompressed, nothing decoded
+    BlockDirectory directory;
+    readBlockDirectory(snapshot, directory, error);
+    auto t5 = Clock::now();
+    std::atomic<bool> intact{true};
+    forEachBlock(directory.blocks.size(), threads, [&](std::size_t b) {
+        thread_local std::string raw;
+        raw.resize(directory.blocks[b].rawSize);
+        if (!unpackBlock(snapshot, directory.blocks[b], raw.data())) intact.store(false);
+    });
+    auto t6 = Clock::now();
 
-        if (!isAllLetters(dept)) {
-            std::cout << "Department must contain letters only.\n";
-            continue;
-        }
+    std::string csv;
+    csv.reserve(rows * 40);
+    for (std::uint32_t row = 0; row < employees.size(); ++row) appendEmployeeRow(csv, employees.at(row));
+    auto t7 = Clock::now();
+    std::string packedCsv = packText(csv, 256 * 1024, threads);
+    auto t8 = Clock::now();
+    std::string unpackedCsv;
+    ok = unpackText(packedCsv, threads, unpackedCsv, error);
+    auto t9 = Clock::now();
 
-        return dept;
+    bool same = intact && ok && unpackedCsv == csv && fromSnapshot.size() == employees.size();
+    for (std::uint32_t row = 0; same && row < employees.size(); row += 997) {
+        Employee a = employees.at(row), b = fromSnapshot.at(row);
+        same = a.id == b.id && a.name == b.name && a.department == b.department && a.salary == b.salary;
     }
+    std::cout << rows << " employees, " << threads << " threads\n";
+    std::cout << "  plain     : " << plain.size() / 1024 << " KB | save " << ms(t0, t1) << " ms | load " << ms(t2, t3) << " ms\n";
+    std::cout << "  snapshot  : " << snapshot.size() / 1024 << " KB (" << static_cast<double>(plain.size()) / static_cast<double>(snapshot.size())
+              << "x smaller, " << directory.blocks.size() << " blocks) | save " << ms(t1, t2) << " ms | load " << ms(t3, t4) << " ms\n";
+    std::cout << "  decompress: " << mbPerSecond(directory.rawBytes, ms(t5, t6)) << " MB/s of block data\n";
+    std::cout << "  csv export: " << csv.size() / 1024 << " KB -> " << packedCsv.size() / 1024 << " KB | pack " << ms(t7, t8)
+              << " ms | unpack " << ms(t8, t9) << " ms (" << mbPerSecond(csv.size(), ms(t8, t9)) << " MB/s)\n";
+    std::cout << (same ? "  round trip matches\n" : "  MISMATCH\n");
+    return same ? 0 : 1;
 }
 
-//Salary validation
-double getValidSalary() {
-    std::string inputSalary;
-
-    while (true) {
-        std::cout << "Enter Salary: ";
-        std::cin >> inputSalary;
-
-        bool valid = true;
-        int dotCount = 0;
+// --session-bench [sessions] [threads] - that many registration dialogs alive at once, replayed
+// a line at a time round robin on a few threads; every dialog gets one wrong answer per question
+int runSessionBenchmark(std::size_t sessions, unsigned threads) {
+    struct Slot {
+        SessionInput input;
+        std::string out;
+        RegistrationSession session;
+    };
+    static const char* steps[] = {"12ab", nullptr, "J0hn", "Jane Doe", "Sales 2", "Sales", "5o000", "52000"};
+    SharedRegistry shared;
+    shared.employees.reserve(sessions);
+    std::atomic<std::uint64_t> outputBytes{0};
 
-        for (char c : inputSalary) {
-            if (c == '.') {
-                dotCount++;
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t] {
+            const std::size_t first = sessions * t / threads;
+            const std::size_t count = sessions * (t + 1) / threads - first;
+            std::unique_ptr<Slot[]> slots(new Slot[count]);
+            for (std::size_t i = 0; i < count; ++i) {
+                slots[i].session = registrationDialog(slots[i].input, slots[i].out, shared);
             }
-            else if (!std::isdigit(c)) {
-                valid = false;
+            std::uint64_t bytes = 0;
+            for (const char* step : steps) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    slots[i].input.feed(step != nullptr ? step : std::to_string(first + i + 1));
+                    bytes += slots[i].out.size();
+                    slots[i].out.clear();
+                }
             }
-        }
+            outputBytes.fetch_add(bytes);
+        });
+    }
+    for (auto& thread : pool) thread.join();
+    auto t1 = std::chrono::steady_clock::now();
 
-        if (!valid || dotCount > 1) {
-            std::cout << "Invalid salary format.\n";
-            continue;
-        }
+    double seconds = std::chrono::duration<double>(t1 - t0).count();
+    std::cout << sessions << " sessions on " << threads << " threads: " << seconds * 1000.0 << " ms | "
+              << static_cast<double>(sessions) / seconds << " registrations/s | "
+              << static_cast<double>(sessions * std::size(steps)) / seconds << " answers/s\n";
+    std::cout << "Coroutine frame " << RegistrationSession::frameSize() << " bytes + " << sizeof(Slot)
+              << " bytes of input / output per session | " << shared.employees.size() << " registered, "
+              << outputBytes.load() / (1024 * 1024) << " MB of prompts\n";
+    return shared.employees.size() == sessions ? 0 : 1;
+}
 
-        double salary = std::stod(inputSalary);
+#if defined(__linux__)
+std::atomic<bool> stopRequested{false};
 
-        if (salary <= 0) {
-            std::cout << "Salary must be greater than zero.\n";
-            continue;
-        }
+extern "C" void requestStop(int) {
+    stopRequested.store(true);
+}
 
-        return salary;
+// --serve <address> [loops] [file] - answers REGISTER / LOOKUP / LIST until SIGINT or SIGTERM,
+// loading the registry from file first and saving it back on the way out
+int runServer(const char* where, unsigned loops, const char* file) {
+    ServerAddress address;
+    SharedRegistry shared;
+    std::string error;
+    if (!parseServerAddress(where, address, error) ||
+        (file != nullptr && std::ifstream(file).good() && !loadEmployees(shared.employees, file, error))) {
+        std::cout << error << "\n";
+        return 1;
+    }
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+    RegistryServer server(shared);
+    if (!server.start(address, loops, error)) {
+        std::cout << error << "\n";
+        return 1;
+    }
+    std::cout << "Serving " << shared.employees.size() << " employees on " << where << " with " << loops << " event loops\n";
+    while (!stopRequested.load()) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    server.stop();
+    std::cout << "Stopped with " << shared.employees.size() << " employees\n";
+    if (file != nullptr && !saveEmployees(shared.employees, file, error)) {
+        std::cout << error << "\n";
+        return 1;
     }
+    return 0;
 }
 
-//  Employee structure - created a structure data type to combine all 4 elements in one place
-struct Employee {
-    int id;
-    std::string name;
-    std::string department;
-    double salary;
-};
-
-// Display employee
-void displayEmployee(const Employee& e) {
-    std::cout << "ID: " << e.id
-        << " | Name: " << e.name
-        << " | Department: " << e.department
-        << " | Salary: $" << e.salary << "\n";
+// --load-test <address> [requests per second] [seconds] [connections]
+int runLoadTest(const char* where, std::uint64_t rate, double seconds, unsigned connections) {
+    ServerAddress address;
+    LoadTestResult result;
+    std::string error;
+    if (!parseServerAddress(where, address, error) || !runRegistryLoadTest(address, rate, seconds, connections, result, error)) {
+        std::cout << error << "\n";
+        return 1;
+    }
+    auto us = [&](double p) { return static_cast<double>(result.latency.percentile(p)) / 1000.0; };
+    std::cout << "Sent " << result.sent << " | answered " << result.answered << " | "
+              << static_cast<double>(result.answered) / result.seconds << " requests/s (target " << rate << ")\n";
+    std::cout << "Latency us: p50 " << us(50) << " | p99 " << us(99) << " | p99.9 " << us(99.9)
+              << " | max " << static_cast<double>(result.latency.max) / 1000.0 << "\n";
+    if (!error.empty()) std::cout << error << "\n";
+    return 0;
 }
+#endif
 
-//  Main Program
-int main() {
-    std::vector<Employee> employees;
+//  Main Program - with a file argument the registry is loaded from it at start and saved on exit
+//  (a name ending in .evz is kept as a compressed snapshot)
+int main(int argc, char* argv[]) {
+    SharedRegistry shared; // stored by column, indexed by id and department
+    Registry<Employee>& employees = shared.employees;
     int choice;
+    std::string error;
+
+    if (argc > 2 && (std::strcmp(argv[1], "--serve") == 0 || std::strcmp(argv[1], "--load-test") == 0)) {
+#if defined(__linux__)
+        if (argv[1][2] == 's') {
+            return runServer(argv[2], argc > 3 ? static_cast<unsigned>(std::strtoul(argv[3], nullptr, 10)) : std::max(1u, std::thread::hardware_concurrency()),
+                             argc > 4 ? argv[4] : nullptr);
+        }
+        return runLoadTest(argv[2], argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 100000,
+                           argc > 4 ? std::strtod(argv[4], nullptr) : 10.0,
+                           argc > 5 ? static_cast<unsigned>(std::strtoul(argv[5], nullptr, 10)) : 32);
+#else
+        std::cout << "Server mode needs Linux (epoll).\n";
+        return 1;
+#endif
+    }
+
+    if (argc > 1 && std::strcmp(argv[1], "--snapshot-bench") == 0) {
+        return runSnapshotBenchmark(argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 2000000,
+                                    argc > 3 ? static_cast<unsigned>(std::strtoul(argv[3], nullptr, 10))
+                                             : std::max(1u, std::thread::hardware_concurrency()));
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--session-bench") == 0) {
+        return runSessionBenchmark(argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000000,
+                                   argc > 3 ? static_cast<unsigned>(std::strtoul(argv[3], nullptr, 10))
+                                            : std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    if (argc > 1 && std::ifstream(argv[1]).good() && !loadEmployees(employees, argv[1], error)) {
+        std::cout << error << "\n";
+        return 1;
+    }
 
     while (true) {
         std::cout << "\n===== Employee Registration Menu =====\n";
@@ -163,14 +277,23 @@ int main() {
         std::cin >> choice;
 
         if (choice == 1) {
-            Employee emp;
-            emp.id = getValidEmployeeId();
-            emp.name = getValidName();
-            emp.department = getValidDepartment();
-            emp.salary = getValidSalary();
-
-            employees.push_back(emp);
-            std::cout << " Employee registered successfully.\n";
+            // the same dialog the socket sessions run, fed from std::cin a line at a time
+            SessionInput input;
+            std::string prompt;
+            RegistrationSession session = registrationDialog(input, prompt, shared);
+            std::string line;
+            std::cin.ignore(); // the enter key after the menu choice
+            while (session.active()) {
+                std::cout << prompt;
+                prompt.clear();
+                if (!std::getline(std::cin, line)) {
+                    input.close();
+                    break;
+                }
+                input.feed(line);
+            }
+            std::cout << prompt;
+            if (session.failure()) std::cout << " Registration failed.\n";
         }
         else if (choice == 2) {
             if (employees.empty()) {
@@ -178,12 +301,13 @@ int main() {
             }
             else {
                 std::cout << "\n--- Employee List ---\n";
-                for (const auto& e : employees) {
-                    displayEmployee(e);
-                }
+                employees.print(std::cout);
             }
         }
         else if (choice == 3) {
+            if (argc > 1 && !saveEmployees(employees, argv[1], error)) {
+                std::cout << error << "\n";
+            }
             std::cout << " Exiting application.\n";
             break;
         }
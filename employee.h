@@ -0,0 +1,156 @@
+//
+// Employee record shared by the registration menu and the registry tools.
+//
+// Employee files have one employee per line:   id,name,department,salary     e.g.  1001,Jane Doe,Sales,52000
+//
+
+#ifndef EMPLOYEE_VALIDATION_C_EMPLOYEE_H
+#define EMPLOYEE_VALIDATION_C_EMPLOYEE_H
+
+#include <cctype>
+#include <charconv>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+
+#include "registry.h"
+
+//  Employee structure - created a structure data type to combine all 4 elements in one place
+struct Employee {
+    int id;
+    std::string name;
+    std::string department;
+    double salary;
+};
+
+// Field descriptors for Registry<Employee> - ids are unique, departments are grouped
+template <> struct RecordTraits<Employee> {
+    static constexpr auto fields = std::make_tuple(field<FieldIndex::unique>("ID", &Employee::id),
+                                                   field("Name", &Employee::name),
+                                                   field<FieldIndex::grouped>("Department", &Employee::department),
+                                                   field("Salary", &Employee::salary, "$"));
+};
+
+// Display employee
+inline void displayEmployee(const Employee& e) {
+    displayRecord(e);
+}
+
+// Helper: digits only - it will check to see if user enters only numbers as id not words
+inline bool isAllDigits(std::string_view s) {
+    if (s.empty()) return false;
+    for (char c : s) {
+        if (!std::isdigit(static_cast<unsigned char>(c))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Helper: letters and spaces only -  it will check to see if user does not enter numbers
+inline bool isAllLetters(std::string_view s) {
+    if (s.empty()) return false;
+    for (char c : s) {
+        if (!std::isalpha(static_cast<unsigned char>(c)) && c != ' ') {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Field checks shared by the console prompts, socket requests and registration sessions;
+// error gets the message the prompts show
+inline bool parseEmployeeId(std::string_view text, int& id, std::string& error) {
+    long long value = 0;
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (!isAllDigits(text) || ec != std::errc() || end != text.data() + text.size() || value > 2147483647) {
+        error = "Invalid ID. Numbers only.";
+        return false;
+    }
+    if (value <= 0) {
+        error = "Employee ID must be positive.";
+        return false;
+    }
+    id = static_cast<int>(value);
+    return true;
+}
+
+inline bool checkEmployeeName(std::string_view text, std::string& error) {
+    if (isAllLetters(text)) return true;
+    error = "Name must contain letters only.";
+    return false;
+}
+
+inline bool checkDepartment(std::string_view text, std::string& error) {
+    if (isAllLetters(text)) return true;
+    error = "Department must contain letters only.";
+    return false;
+}
+
+// digits with at most one '.', above zero
+inline bool parseSalary(std::string_view text, double& salary, std::string& error) {
+    double value = 0;
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value, std::chars_format::fixed);
+    if (text.empty() || text.find_first_not_of("0123456789.") != std::string_view::npos ||
+        ec != std::errc() || end != text.data() + text.size()) {
+        error = "Invalid salary format.";
+        return false;
+    }
+    if (value <= 0) {
+        error = "Salary must be greater than zero.";
+        return false;
+    }
+    salary = value;
+    return true;
+}
+
+// One "id,name,department,salary" record with the same rules as the registration prompts
+inline bool parseEmployeeFields(std::string_view text, Employee& e, std::string& error) {
+    std::string_view fields[4];
+    for (int f = 0; f < 3; ++f) {
+        std::size_t comma = text.find(',');
+        if (comma == std::string_view::npos) {
+            error = "expected id,name,department,salary";
+            return false;
+        }
+        fields[f] = text.substr(0, comma);
+        text.remove_prefix(comma + 1);
+    }
+    fields[3] = text;
+    int id = 0;
+    double salary = 0;
+    if (!parseEmployeeId(fields[0], id, error) || !checkEmployeeName(fields[1], error) ||
+        !checkDepartment(fields[2], error) || !parseSalary(fields[3], salary, error)) {
+        return false;
+    }
+    e.id = id;
+    e.name.assign(fields[1]);
+    e.department.assign(fields[2]);
+    e.salary = salary;
+    return true;
+}
+
+// The registry as shared by the server event loops and registration sessions: lookups and
+// listings take the lock shared, registrations take it exclusively
+struct SharedRegistry {
+    Registry<Employee> employees;
+    std::shared_mutex lock;
+};
+
+// One line of an employee file, appended to out
+inline void appendEmployeeRow(std::string& out, const Employee& e) {
+    out += std::to_string(e.id);
+    out += ',';
+    out += e.name;
+    out += ',';
+    out += e.department;
+    out += ',';
+    char salary[64];
+    auto [end, ec] = std::to_chars(salary, salary + sizeof(salary), e.salary, std::chars_format::fixed, 2);
+    out.append(salary, ec == std::errc() ? end : salary);   // cents kept, so the row reads back as e
+    out += '\n';
+}
+
+#endif //EMPLOYEE_VALIDATION_C_EMPLOYEE_H
@@ -0,0 +1,377 @@
+//
+// Arithmetic expressions over named variables, e.g.  "(a + b) * 2 - a / (b + 1)".
+//
+// The text is parsed into a small tree (constant subtrees are folded while parsing), then
+// compiled to register bytecode whose operands are registers, input columns or constants.
+// Evaluation runs one instruction at a time over a block of rows, so the dispatch cost is
+// paid once per block and each instruction is a plain loop the compiler vectorizes.
+// Division follows IEEE rules (x / 0 is inf), the same as the double math it replaces.
+//
+
+#ifndef EMPLOYEE_VALIDATION_C_EXPRESSIONENGINE_H
+#define EMPLOYEE_VALIDATION_C_EXPRESSIONENGINE_H
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+enum class ExprOp : std::uint8_t { Const, Var, Neg, Add, Sub, Mul, Div };
+
+struct ExprNode {
+    ExprOp op;
+    double value = 0.0;      // Const
+    std::uint32_t var = 0;   // Var
+    std::int32_t left = -1;
+    std::int32_t right = -1;
+    std::uint32_t height = 1;   // longest path down to a leaf, counting this node
+};
+
+inline double applyExprOp(ExprOp op, double a, double b) {
+    switch (op) {
+    case ExprOp::Neg: return -a;
+    case ExprOp::Add: return a + b;
+    case ExprOp::Sub: return a - b;
+    case ExprOp::Mul: return a * b;
+    case ExprOp::Div: return a / b;
+    default: return 0.0;
+    }
+}
+
+// Recursive descent:  sum := product (('+'|'-') product)*
+//                     product := unary (('*'|'/') unary)*
+//                     unary := '-' unary | number | name | '(' sum ')'
+// Nesting is capped at kMaxNesting and tree height at kMaxHeight, so neither the parser nor the
+// compiler can run out of stack on hostile input.
+class ExpressionParser {
+public:
+    static constexpr std::uint32_t kMaxNesting = 256;
+    static constexpr std::uint32_t kMaxHeight = 4096;   // a sum of 4096 terms is that tall
+
+    explicit ExpressionParser(std::string_view text) : text(text) {}
+
+    bool parse(std::string& error) {
+        root = parseSum();
+        skipSpaces();
+        if (root >= 0 && pos != text.size()) fail("unexpected '" + std::string(1, text[pos]) + "'");
+        if (!failure.empty()) {
+            error = failure;
+            return false;
+        }
+        return true;
+    }
+
+    std::vector<ExprNode> nodes;
+    std::vector<std::string> variables;   // in order of first use
+    std::int32_t root = -1;
+
+private:
+    std::int32_t fail(const std::string& message) {
+        if (failure.empty()) failure = message + " at position " + std::to_string(pos);
+        return -1;
+    }
+
+    void skipSpaces() {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+    }
+
+    std::int32_t add(ExprNode node) {
+        if (node.left >= 0) node.height = std::max(node.height, nodes[node.left].height + 1);
+        if (node.right >= 0) node.height = std::max(node.height, nodes[node.right].height + 1);
+        if (node.height > kMaxHeight) return fail("expression too long");
+        nodes.push_back(node);
+        return static_cast<std::int32_t>(nodes.size() - 1);
+    }
+
+    bool isConst(std::int32_t node, double value) const {
+        return nodes[node].op == ExprOp::Const && nodes[node].value == value;
+    }
+
+    // folds constant operands and the identities x+0, x-0, x*1, x/1
+    std::int32_t binary(ExprOp op, std::int32_t left, std::int32_t right) {
+        if (left < 0 || right < 0) return -1;
+        if (nodes[left].op == ExprOp::Const && nodes[right].op == ExprOp::Const) {
+            ExprNode folded{ExprOp::Const};
+            folded.value = applyExprOp(op, nodes[left].value, nodes[right].value);
+            return add(folded);
+        }
+        if ((op == ExprOp::Add || op == ExprOp::Sub) && isConst(right, 0.0)) return left;
+        if (op == ExprOp::Add && isConst(left, 0.0)) return right;
+        if ((op == ExprOp::Mul || op == ExprOp::Div) && isConst(right, 1.0)) return left;
+        if (op == ExprOp::Mul && isConst(left, 1.0)) return right;
+        ExprNode node{op};
+        node.left = left;
+        node.right = right;
+        return add(node);
+    }
+
+    std::int32_t parseSum() {
+        std::int32_t left = parseProduct();
+        while (left >= 0) {
+            skipSpaces();
+            if (pos >= text.size() || (text[pos] != '+' && text[pos] != '-')) break;
+            ExprOp op = text[pos++] == '+' ? ExprOp::Add : ExprOp::Sub;
+            left = binary(op, left, parseProduct());
+        }
+        return left;
+    }
+
+    std::int32_t parseProduct() {
+        std::int32_t left = parseUnary();
+        while (left >= 0) {
+            skipSpaces();
+            if (pos >= text.size() || (text[pos] != '*' && text[pos] != '/')) break;
+            ExprOp op = text[pos++] == '*' ? ExprOp::Mul : ExprOp::Div;
+            left = binary(op, left, parseUnary());
+        }
+        return left;
+    }
+
+    std::int32_t parseUnary() {
+        if (nesting == kMaxNesting) return fail("expression nested too deeply");
+        ++nesting;
+        std::int32_t node = parseOperand();
+        --nesting;
+        return node;
+    }
+
+    std::int32_t parseOperand() {
+        skipSpaces();
+        if (pos >= text.size()) return fail("expected a value");
+        char c = text[pos];
+        if (c == '-') {
+            ++pos;
+            std::int32_t operand = parseUnary();
+            if (operand < 0) return -1;
+            if (nodes[operand].op == ExprOp::Const) {
+                ExprNode folded{ExprOp::Const};
+                folded.value = -nodes[operand].value;
+                return add(folded);
+            }
+            ExprNode node{ExprOp::Neg};
+            node.left = operand;
+            return add(node);
+        }
+        if (c == '(') {
+            ++pos;
+            std::int32_t inner = parseSum();
+            skipSpaces();
+            if (inner >= 0 && (pos >= text.size() || text[pos] != ')')) return fail("expected ')'");
+            ++pos;
+            return inner;
+        }
+        if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+            std::string number;
+            while (pos < text.size() && (std::isdigit(static_cast<unsigned char>(text[pos])) || text[pos] == '.')) {
+                number += text[pos++];
+            }
+            char* end = nullptr;
+            ExprNode node{ExprOp::Const};
+            node.value = std::strtod(number.c_str(), &end);
+            if (end != number.c_str() + number.size()) return fail("bad number '" + number + "'");
+            return add(node);
+        }
+        if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            std::size_t start = pos;
+            while (pos < text.size() && (std::isalnum(static_cast<unsigned char>(text[pos])) || text[pos] == '_')) ++pos;
+            std::string name(text.substr(start, pos - start));
+            auto known = std::find(variables.begin(), variables.end(), name);
+            ExprNode node{ExprOp::Var};
+            node.var = static_cast<std::uint32_t>(known - variables.begin());
+            if (known == variables.end()) variables.push_back(name);
+            return add(node);
+        }
+        return fail("unexpected '" + std::string(1, c) + "'");
+    }
+
+    std::string_view text;
+    std::size_t pos = 0;
+    std::uint32_t nesting = 0;
+    std::string failure;
+};
+
+// ---- register bytecode ----
+
+enum class OperandKind : std::uint8_t { Register, Variable, Constant };
+
+struct ExprOperand {
+    OperandKind kind = OperandKind::Constant;
+    std::uint16_t index = 0;
+};
+
+struct ExprInstruction {
+    ExprOp op;
+    std::uint16_t dst;
+    ExprOperand a;
+    ExprOperand b;   // unused for Neg
+};
+
+struct CompiledExpression {
+    std::string text;
+    std::vector<std::string> variables;   // columns are passed in this order
+    std::vector<double> constants;
+    std::vector<ExprInstruction> code;
+    std::uint16_t registers = 0;
+    ExprOperand result;
+};
+
+class ExpressionCompiler {
+public:
+    explicit ExpressionCompiler(const ExpressionParser& parser, CompiledExpression& out) : parser(parser), out(out) {}
+
+    bool compile(std::string& error) {
+        out.variables = parser.variables;
+        if (parser.variables.size() > 0xFFFF) {
+            error = "too many variables";
+            return false;
+        }
+        out.result = emit(parser.root);
+        if (out.constants.size() > 0xFFFF) {
+            error = "too many constants";
+            return false;
+        }
+        if (out.registers > kMaxRegisters) {
+            error = "expression too deep";
+            return false;
+        }
+        return true;
+    }
+
+    static constexpr std::uint16_t kMaxRegisters = 64;
+
+private:
+    std::uint16_t allocate() {
+        if (!freeRegisters.empty()) {
+            std::uint16_t reg = freeRegisters.back();
+            freeRegisters.pop_back();
+            return reg;
+        }
+        return out.registers++;
+    }
+
+    void release(const ExprOperand& operand) {
+        if (operand.kind == OperandKind::Register) freeRegisters.push_back(operand.index);
+    }
+
+    ExprOperand emit(std::int32_t index) {
+        const ExprNode& node = parser.nodes[index];
+        ExprOperand operand;
+        if (node.op == ExprOp::Const) {
+            auto known = std::find(out.constants.begin(), out.constants.end(), node.value);
+            operand.kind = OperandKind::Constant;
+            operand.index = static_cast<std::uint16_t>(known - out.constants.begin());
+            if (known == out.constants.end()) out.constants.push_back(node.value);
+            return operand;
+        }
+        if (node.op == ExprOp::Var) {
+            operand.kind = OperandKind::Variable;
+            operand.index = static_cast<std::uint16_t>(node.var);
+            return operand;
+        }
+        // operands are released before the result is allocated, so dead registers get reused
+        ExprOperand a = emit(node.left);
+        ExprOperand b = node.right >= 0 ? emit(node.right) : ExprOperand{};
+        release(a);
+        release(b);
+        operand.kind = OperandKind::Register;
+        operand.index = allocate();
+        out.code.push_back(ExprInstruction{node.op, operand.index, a, b});
+        return operand;
+    }
+
+    const ExpressionParser& parser;
+    CompiledExpression& out;
+    std::vector<std::uint16_t> freeRegisters;
+};
+
+inline bool compileExpression(std::string_view text, CompiledExpression& out, std::string& error) {
+    out = CompiledExpression{};
+    out.text = std::string(text);
+    ExpressionParser parser(text);
+    if (!parser.parse(error)) return false;
+    ExpressionCompiler compiler(parser, out);
+    return compiler.compile(error);
+}
+
+// Evaluates rows [0, rows) into out; columns[i] holds the values of expression.variables[i]
+inline void evaluateExpression(const CompiledExpression& expression, std::span<const double* const> columns,
+                               std::size_t rows, double* out) {
+    constexpr std::size_t kBlock = 256;   // a register is 2 KB, a handful stay in L1
+    std::vector<double> registers(static_cast<std::size_t>(expression.registers) * kBlock);
+    std::vector<double> constants(expression.constants.size() * kBlock);
+    for (std::size_t c = 0; c < expression.constants.size(); ++c) {
+        std::fill_n(constants.begin() + static_cast<std::ptrdiff_t>(c * kBlock), kBlock, expression.constants[c]);
+    }
+
+    for (std::size_t base = 0; base < rows; base += kBlock) {
+        const std::size_t count = std::min(kBlock, rows - base);
+        auto source = [&](const ExprOperand& operand) -> const double* {
+            switch (operand.kind) {
+            case OperandKind::Register: return registers.data() + operand.index * kBlock;
+            case OperandKind::Variable: return columns[operand.index] + base;
+            default: return constants.data() + operand.index * kBlock;
+            }
+        };
+        for (const ExprInstruction& instruction : expression.code) {
+            const double* x = source(instruction.a);
+            const double* y = source(instruction.b);
+            double* d = registers.data() + instruction.dst * kBlock;
+            switch (instruction.op) {
+            case ExprOp::Neg: for (std::size_t i = 0; i < count; ++i) d[i] = -x[i]; break;
+            case ExprOp::Add: for (std::size_t i = 0; i < count; ++i) d[i] = x[i] + y[i]; break;
+            case ExprOp::Sub: for (std::size_t i = 0; i < count; ++i) d[i] = x[i] - y[i]; break;
+            case ExprOp::Mul: for (std::size_t i = 0; i < count; ++i) d[i] = x[i] * y[i]; break;
+            case ExprOp::Div: for (std::size_t i = 0; i < count; ++i) d[i] = x[i] / y[i]; break;
+            default: break;
+            }
+        }
+        std::copy_n(source(expression.result), count, out + base);
+    }
+}
+
+// Compiled expressions by their text; safe to share between threads
+class ExpressionCache {
+public:
+    explicit ExpressionCache(std::size_t capacity = 1024) : capacity(capacity) {}
+
+    // nullptr (and error set) when the text does not parse
+    std::shared_ptr<const CompiledExpression> get(std::string_view text, std::string& error) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = entries.find(std::string(text));
+        if (found != entries.end()) {
+            ++hitCount;
+            return found->second;
+        }
+        auto compiled = std::make_shared<CompiledExpression>();
+        if (!compileExpression(text, *compiled, error)) return nullptr;
+        if (entries.size() >= capacity) entries.clear();   // simple, expressions are cheap to rebuild
+        entries.emplace(compiled->text, compiled);
+        return compiled;
+    }
+
+    std::size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries.size();
+    }
+
+    std::uint64_t hits() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return hitCount;
+    }
+
+private:
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<const CompiledExpression>> entries;
+    std::size_t capacity;
+    std::uint64_t hitCount = 0;
+};
+
+#endif //EMPLOYEE_VALIDATION_C_EXPRESSIONENGINE_H
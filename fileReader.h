@@ -0,0 +1,467 @@
+//
+// Block-wise file reading for the bulk import paths, with three interchangeable backends:
+//
+//   blocking - pread of one block after another into a small pool of buffers
+//   mapped   - the file is mapped and blocks are slices of the mapping
+//   uring    - io_uring keeps `depth` block reads in flight at once (raw syscalls, no liburing)
+//
+// Whatever the backend, finished blocks are handed to a pool of worker threads as views into
+// the buffer the kernel filled - nothing is copied - and the buffer goes back into the pool
+// once the worker returns. When io_uring cannot be set up (old kernel, seccomp, not Linux) the
+// uring backend quietly falls back to blocking reads; stats.used says which one ran.
+//
+// readFileLines() cuts blocks on newlines for the line oriented parsers: the whole lines inside
+// a block go to the workers in place, and only the line that straddles two blocks is stitched
+// together (copied) at the end.
+//
+
+#ifndef EMPLOYEE_VALIDATION_C_FILEREADER_H
+#define EMPLOYEE_VALIDATION_C_FILEREADER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "mappedFile.h"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define EV_HAVE_IO_URING 1
+#endif
+#endif
+
+enum class FileBackend { blocking, mapped, uring };
+
+inline const char* fileBackendName(FileBackend backend) {
+    switch (backend) {
+        case FileBackend::blocking: return "read";
+        case FileBackend::mapped: return "mmap";
+        case FileBackend::uring: return "io_uring";
+    }
+    return "?";
+}
+
+inline bool parseFileBackend(std::string_view text, FileBackend& backend) {
+    if (text == "read") backend = FileBackend::blocking;
+    else if (text == "mmap") backend = FileBackend::mapped;
+    else if (text == "io_uring" || text == "uring") backend = FileBackend::uring;
+    else return false;
+    return true;
+}
+
+struct FileReadOptions {
+    FileBackend backend = FileBackend::uring;
+    std::size_t blockSize = 1 << 20;
+    unsigned depth = 8;     // buffers, and so reads in flight for io_uring
+    unsigned workers = 1;   // threads calling consume
+};
+
+struct FileReadStats {
+    std::uint64_t bytes = 0;
+    std::size_t blocks = 0;
+    FileBackend used = FileBackend::blocking;
+};
+
+#if defined(EV_HAVE_IO_URING)
+// The submission / completion rings of one io_uring instance, driven by a single thread
+class UringQueue {
+public:
+    UringQueue() = default;
+    UringQueue(const UringQueue&) = delete;
+    UringQueue& operator=(const UringQueue&) = delete;
+    ~UringQueue() { close(); }
+
+    bool open(unsigned entries) {
+        io_uring_params params{};
+        ringFd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        if (ringFd < 0) return false;
+        sqLength = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqLength = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single) sqLength = cqLength = std::max(sqLength, cqLength);
+        sqRing = ::mmap(nullptr, sqLength, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+        cqRing = single ? sqRing
+                        : ::mmap(nullptr, cqLength, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+        sqeLength = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqeMemory = ::mmap(nullptr, sqeLength, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+        if (sqRing == MAP_FAILED || cqRing == MAP_FAILED || sqeMemory == MAP_FAILED) {
+            if (sqeMemory != MAP_FAILED) ::munmap(sqeMemory, sqeLength);
+            if (cqRing == sqRing) cqRing = MAP_FAILED;
+            close();
+            return false;
+        }
+        char* sq = static_cast<char*>(sqRing);
+        char* cq = static_cast<char*>(cqRing);
+        sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqEntries = params.sq_entries;
+        sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sqes = static_cast<io_uring_sqe*>(sqeMemory);
+        cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    void close() {
+        if (sqes != nullptr) ::munmap(sqes, sqeLength);
+        if (cqRing != MAP_FAILED && cqRing != sqRing) ::munmap(cqRing, cqLength);
+        if (sqRing != MAP_FAILED) ::munmap(sqRing, sqLength);
+        if (ringFd >= 0) ::close(ringFd);
+        sqes = nullptr;
+        sqRing = cqRing = MAP_FAILED;
+        ringFd = -1;
+    }
+
+    // queues a readv of one iovec; false when the submission ring is full
+    bool queueRead(int fd, const iovec* target, std::uint64_t offset, std::uint64_t tag) {
+        unsigned tail = *sqTail;   // only this thread moves the tail
+        if (tail - std::atomic_ref<unsigned>(*sqHead).load(std::memory_order_acquire) == sqEntries) return false;
+        unsigned slot = tail & sqMask;
+        io_uring_sqe& sqe = sqes[slot];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READV;   // READV rather than READ: it goes back to the first io_uring kernels
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<std::uint64_t>(target);
+        sqe.len = 1;
+        sqe.off = offset;
+        sqe.user_data = tag;
+        sqArray[slot] = slot;
+        std::atomic_ref<unsigned>(*sqTail).store(tail + 1, std::memory_order_release);
+        ++unsubmitted;
+        return true;
+    }
+
+    // submits what is queued and waits for at least minComplete completions; false on error
+    bool submitAndWait(unsigned minComplete) {
+        while (true) {
+            long done = ::syscall(__NR_io_uring_enter, ringFd, unsubmitted, minComplete,
+                                  minComplete > 0 ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+            if (done >= 0) {
+                unsubmitted -= std::min<unsigned>(unsubmitted, static_cast<unsigned>(done));
+                return true;
+            }
+            if (errno != EINTR && errno != EAGAIN && errno != EBUSY) return false;
+        }
+    }
+
+    // onCompletion(tag, result) for every completion waiting in the ring
+    template <typename Fn>
+    void reap(Fn&& onCompletion) {
+        unsigned head = *cqHead;
+        unsigned tail = std::atomic_ref<unsigned>(*cqTail).load(std::memory_order_acquire);
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = cqes[head & cqMask];
+            onCompletion(cqe.user_data, cqe.res);
+        }
+        std::atomic_ref<unsigned>(*cqHead).store(head, std::memory_order_release);
+    }
+
+private:
+    int ringFd = -1;
+    void* sqRing = MAP_FAILED;
+    void* cqRing = MAP_FAILED;
+    std::size_t sqLength = 0, cqLength = 0, sqeLength = 0;
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned sqMask = 0, sqEntries = 0;
+    io_uring_sqe* sqes = nullptr;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned cqMask = 0;
+    io_uring_cqe* cqes = nullptr;
+    unsigned unsubmitted = 0;
+};
+#endif
+
+// Blocks that have been read, waiting for a worker; and the buffers the workers have given back
+class BlockHandoff {
+public:
+    struct Block {
+        std::size_t index = 0;
+        const char* data = nullptr;
+        std::size_t size = 0;
+        int buffer = -1;   // -1: a slice of the mapping, nothing to give back
+    };
+
+    void push(const Block& block) {
+        {
+            std::lock_guard guard(lock);
+            ready.push_back(block);
+        }
+        readyChanged.notify_one();
+    }
+
+    // false once the reader is finished and everything has been handed out
+    bool pop(Block& block) {
+        std::unique_lock guard(lock);
+        readyChanged.wait(guard, [&] { return !ready.empty() || finished; });
+        if (ready.empty()) return false;
+        block = ready.front();
+        ready.pop_front();
+        return true;
+    }
+
+    void finish() {
+        {
+            std::lock_guard guard(lock);
+            finished = true;
+        }
+        readyChanged.notify_all();
+    }
+
+    void giveBack(int buffer) {
+        {
+            std::lock_guard guard(lock);
+            free.push_back(buffer);
+        }
+        freeChanged.notify_one();
+    }
+
+    // the buffers given back so far; waits for one when wait is set
+    std::vector<int> takeFree(bool wait) {
+        std::unique_lock guard(lock);
+        if (wait) freeChanged.wait(guard, [&] { return !free.empty(); });
+        std::vector<int> taken;
+        taken.swap(free);
+        return taken;
+    }
+
+private:
+    std::mutex lock;
+    std::condition_variable readyChanged;
+    std::condition_variable freeChanged;
+    std::deque<Block> ready;
+    std::vector<int> free;
+    bool finished = false;
+};
+
+// consume(block index, bytes) once for every blockSize piece of the file (the last one shorter),
+// called from options.workers threads in no particular order. The bytes are only valid during
+// the call.
+template <typename Consume>
+bool readFileBlocks(const std::string& path, const FileReadOptions& options, Consume&& consume,
+                    FileReadStats& stats, std::string& error) {
+    stats = FileReadStats{};
+    const std::size_t blockSize = std::max<std::size_t>(options.blockSize, 4096);
+    const unsigned depth = std::max(1u, options.depth);
+    int fd = openReadOnly(path);
+    std::int64_t length = fd < 0 ? -1 : fileSize(fd);
+    if (length < 0) {
+        closeFile(fd);
+        error = "cannot read " + path;
+        return false;
+    }
+    const std::uint64_t bytes = static_cast<std::uint64_t>(length);
+    const std::size_t blocks = static_cast<std::size_t>((bytes + blockSize - 1) / blockSize);
+    auto blockLength = [&](std::size_t b) { return static_cast<std::size_t>(std::min<std::uint64_t>(blockSize, bytes - b * blockSize)); };
+
+    BlockHandoff handoff;
+    std::vector<std::thread> workers;
+    for (unsigned w = 0; w < std::max(1u, options.workers); ++w) {
+        workers.emplace_back([&] {
+            BlockHandoff::Block block;
+            while (handoff.pop(block)) {
+                consume(block.index, std::string_view(block.data, block.size));
+                if (block.buffer >= 0) handoff.giveBack(block.buffer);
+            }
+        });
+    }
+
+    bool ok = true;
+    stats.used = options.backend;
+    MappedRegion mapping;
+    std::vector<std::unique_ptr<char[]>> buffers;
+    if (options.backend == FileBackend::mapped) {
+        if (mapping.map(fd, 0, static_cast<std::size_t>(bytes))) {
+            std::string_view all = mapping.view();
+            for (std::size_t b = 0; b < blocks; ++b) handoff.push({b, all.data() + b * blockSize, blockLength(b), -1});
+        }
+        else {
+            ok = false;
+            error = "cannot map " + path;
+        }
+    }
+    else {
+        for (unsigned d = 0; d < depth; ++d) {
+            buffers.push_back(std::make_unique<char[]>(blockSize));
+            handoff.giveBack(static_cast<int>(d));
+        }
+#if defined(EV_HAVE_IO_URING)
+        UringQueue ring;
+        if (options.backend == FileBackend::uring && blocks > 0 && !ring.open(depth)) stats.used = FileBackend::blocking;
+        if (stats.used == FileBackend::uring && blocks > 0) {
+            struct Pending {
+                std::size_t block = 0;
+                std::size_t done = 0;
+                iovec target{};
+            };
+            std::vector<Pending> pending(depth);
+            std::vector<int> waiting;   // buffers with a read that did not fit the submission ring
+            std::size_t nextBlock = 0;
+            unsigned inFlight = 0;
+            auto queue = [&](int buffer) {
+                Pending& read = pending[static_cast<std::size_t>(buffer)];
+                read.target.iov_base = buffers[static_cast<std::size_t>(buffer)].get() + read.done;
+                read.target.iov_len = blockLength(read.block) - read.done;
+                if (!ring.queueRead(fd, &read.target, read.block * blockSize + read.done, static_cast<std::uint64_t>(buffer))) {
+                    waiting.push_back(buffer);
+                }
+            };
+            while (ok) {
+                std::vector<int> retry;
+                retry.swap(waiting);
+                for (int buffer : retry) queue(buffer);
+                for (int buffer : handoff.takeFree(inFlight == 0 && nextBlock < blocks)) {
+                    if (nextBlock == blocks) {
+                        handoff.giveBack(buffer);   // nothing left to read into it
+                        continue;
+                    }
+                    pending[static_cast<std::size_t>(buffer)] = Pending{nextBlock++, 0, {}};
+                    ++inFlight;
+                    queue(buffer);
+                }
+                if (inFlight == 0) break;
+                if (!ring.submitAndWait(1)) {
+                    ok = false;
+                    error = std::string("io_uring_enter: ") + std::strerror(errno);
+                    break;
+                }
+                ring.reap([&](std::uint64_t tag, std::int32_t result) {
+                    int buffer = static_cast<int>(tag);
+                    Pending& read = pending[static_cast<std::size_t>(buffer)];
+                    if (result == -EINTR || result == -EAGAIN) {
+                        queue(buffer);
+                        return;
+                    }
+                    if (result < 0) {
+                        ok = false;
+                        error = "read " + path + ": " + std::strerror(-result);
+                        --inFlight;
+                        return;
+                    }
+                    read.done += static_cast<std::size_t>(result);
+                    if (result > 0 && read.done < blockLength(read.block)) {
+                        queue(buffer);   // short read, ask for the rest
+                        return;
+                    }
+                    --inFlight;
+                    handoff.push({read.block, buffers[static_cast<std::size_t>(buffer)].get(), read.done, buffer});
+                });
+            }
+            // an error leaves reads in flight into our buffers: wait them out before freeing anything
+            inFlight -= static_cast<unsigned>(waiting.size());
+            while (inFlight > 0 && ring.submitAndWait(1)) ring.reap([&](std::uint64_t, std::int32_t) { --inFlight; });
+        }
+        else
+#endif
+        {
+            stats.used = FileBackend::blocking;
+            for (std::size_t b = 0; b < blocks && ok; ) {
+                for (int buffer : handoff.takeFree(true)) {
+                    if (b == blocks || !ok) {
+                        handoff.giveBack(buffer);
+                        continue;
+                    }
+                    char* target = buffers[static_cast<std::size_t>(buffer)].get();
+                    std::size_t done = 0;
+                    while (done < blockLength(b)) {
+#if defined(_WIN32)
+                        ::_lseeki64(fd, static_cast<__int64>(b * blockSize + done), SEEK_SET);
+                        int got = ::_read(fd, target + done, static_cast<unsigned>(blockLength(b) - done));
+#else
+                        ssize_t got = ::pread(fd, target + done, blockLength(b) - done, static_cast<off_t>(b * blockSize + done));
+                        if (got < 0 && errno == EINTR) continue;
+#endif
+                        if (got <= 0) break;
+                        done += static_cast<std::size_t>(got);
+                    }
+                    if (done == 0 && blockLength(b) != 0) {
+                        ok = false;
+                        error = "cannot read " + path;
+                        handoff.giveBack(buffer);
+                        continue;
+                    }
+                    handoff.push({b++, target, done, buffer});
+                }
+            }
+        }
+    }
+    handoff.finish();
+    for (auto& worker : workers) worker.join();
+    closeFile(fd);
+    stats.bytes = ok ? bytes : 0;
+    stats.blocks = blocks;
+    return ok;
+}
+
+// Slots of readFileLines for a file of this size
+inline std::size_t lineSlotCount(std::uint64_t bytes, std::size_t blockSize) {
+    blockSize = std::max<std::size_t>(blockSize, 4096);
+    return static_cast<std::size_t>((bytes + blockSize - 1) / blockSize) * 2 + 1;
+}
+
+// consume(slot, lines) with runs of whole lines (newlines included, the very last line perhaps
+// without one), every byte of the file exactly once. Ordering the runs by slot gives the file
+// order; slot 0 starts at the start of the file. onStart(slot count) is called before anything
+// is consumed, so the caller can set up per-slot results without locking.
+template <typename OnStart, typename Consume>
+bool readFileLines(const std::string& path, const FileReadOptions& options, OnStart&& onStart, Consume&& consume,
+                   FileReadStats& stats, std::string& error) {
+    int fd = openReadOnly(path);
+    std::int64_t length = fd < 0 ? -1 : fileSize(fd);
+    closeFile(fd);
+    if (length < 0) {
+        error = "cannot read " + path;
+        return false;
+    }
+    const std::size_t blocks = lineSlotCount(static_cast<std::uint64_t>(length), options.blockSize) / 2;
+    onStart(blocks * 2 + 1);
+
+    // per block: everything up to its first newline, whether it has one, and what follows its last
+    std::vector<std::string> heads(blocks), tails(blocks);
+    std::vector<char> hasNewline(blocks, 0);
+    bool ok = readFileBlocks(path, options, [&](std::size_t block, std::string_view data) {
+        if (block >= blocks) return;   // the file grew while we read it
+        std::size_t first = data.find('\n');
+        if (first == std::string_view::npos) {
+            heads[block].assign(data);
+            return;
+        }
+        std::size_t last = data.rfind('\n');
+        hasNewline[block] = 1;
+        heads[block].assign(data.substr(0, first + 1));
+        tails[block].assign(data.substr(last + 1));
+        if (last > first) consume(block * 2 + 1, data.substr(first + 1, last - first));
+    }, stats, error);
+    if (!ok) return false;
+
+    std::string carried;
+    for (std::size_t block = 0; block < blocks; ++block) {
+        carried += heads[block];
+        if (!hasNewline[block]) continue;
+        consume(block * 2, std::string_view(carried));
+        carried.swap(tails[block]);
+    }
+    if (!carried.empty()) consume(blocks * 2, std::string_view(carried));
+    return true;
+}
+
+#endif //EMPLOYEE_VALIDATION_C_FILEREADER_H
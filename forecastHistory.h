@@ -0,0 +1,436 @@
+//
+// Compressed per-station forecast history - every station keeps a ring of small blocks,
+// timestamps are stored as delta-of-delta and temperatures as XOR against the previous value
+// (same idea as the Gorilla time series format). Each block also keeps min/max/sum so
+// aggregate queries can skip decoding blocks that sit fully inside the requested range.
+//
+
+#ifndef EMPLOYEE_VALIDATION_C_FORECASTHISTORY_H
+#define EMPLOYEE_VALIDATION_C_FORECASTHISTORY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "forecastStore.h"
+
+struct HistorySample {
+    std::int64_t timestamp;   // seconds
+    float value;
+};
+
+// Aggregate over a time range
+struct HistorySummary {
+    std::size_t count = 0;
+    float min = std::numeric_limits<float>::max();
+    float max = std::numeric_limits<float>::lowest();
+    double sum = 0.0;
+
+    double average() const { return count == 0 ? 0.0 : sum / static_cast<double>(count); }
+
+    void add(float value) {
+        ++count;
+        min = std::min(min, value);
+        max = std::max(max, value);
+        sum += value;
+    }
+
+    void merge(const HistorySummary& other) {
+        count += other.count;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+        sum += other.sum;
+    }
+};
+
+// One downsampled bucket, bucketStart is the first second the bucket covers
+struct HistoryPoint {
+    std::int64_t bucketStart;
+    HistorySummary summary;
+};
+
+inline unsigned leadingZeros32(std::uint32_t x) {
+#if defined(__GNUC__)
+    return x == 0 ? 32 : static_cast<unsigned>(__builtin_clz(x));
+#else
+    unsigned n = 0;
+    for (std::uint32_t bit = 0x80000000u; bit != 0 && (x & bit) == 0; bit >>= 1) ++n;
+    return n;
+#endif
+}
+
+inline unsigned trailingZeros32(std::uint32_t x) {
+#if defined(__GNUC__)
+    return x == 0 ? 32 : static_cast<unsigned>(__builtin_ctz(x));
+#else
+    unsigned n = 0;
+    for (std::uint32_t bit = 1; bit != 0 && (x & bit) == 0; bit <<= 1) ++n;
+    return n;
+#endif
+}
+
+inline std::uint32_t floatBits(float value) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline float bitsToFloat(std::uint32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// A block of compressed samples - bits are packed most significant first into 64 bit words
+class HistoryBlock {
+public:
+    void reset() {
+        words.clear();   // keeps capacity, so a recycled ring slot does not allocate
+        bitCount = 0;
+        sampleCount = 0;
+        summary = HistorySummary{};
+        prevTimestamp = 0;
+        prevDelta = 0;
+        prevValue = 0;
+        prevLeading = kNoWindow;
+        prevTrailing = 0;
+    }
+
+    void append(std::int64_t timestamp, float value) {
+        std::uint32_t bits = floatBits(value);
+        if (sampleCount == 0) {
+            writeBits(static_cast<std::uint64_t>(timestamp), 64);
+            writeBits(bits, 32);
+            firstTimestamp = timestamp;
+        }
+        else {
+            encodeTimestamp(timestamp);
+            encodeValue(bits);
+        }
+        prevTimestamp = timestamp;
+        prevValue = bits;
+        lastTimestamp = timestamp;
+        summary.add(value);
+        ++sampleCount;
+    }
+
+    std::size_t size() const { return sampleCount; }
+    std::size_t encodedBytes() const { return (bitCount + 7) / 8; }
+    std::int64_t first() const { return firstTimestamp; }
+    std::int64_t last() const { return lastTimestamp; }
+    const HistorySummary& stats() const { return summary; }
+
+    // Walks samples in order; fn returns false to stop early (used when a query range ends mid block)
+    template <typename Fn>
+    void decode(Fn&& fn) const {
+        if (sampleCount == 0) return;
+        std::size_t pos = 0;
+        std::int64_t timestamp = static_cast<std::int64_t>(readBits(pos, 64));
+        std::uint32_t bits = static_cast<std::uint32_t>(readBits(pos, 32));
+        std::int64_t delta = 0;
+        unsigned leading = 0;
+        unsigned trailing = 0;
+        if (!fn(timestamp, bitsToFloat(bits))) return;
+
+        for (std::size_t i = 1; i < sampleCount; ++i) {
+            delta += decodeDeltaOfDelta(pos);
+            timestamp += delta;
+
+            if (readBits(pos, 1) != 0) {
+                if (readBits(pos, 1) != 0) {
+                    leading = static_cast<unsigned>(readBits(pos, 5));
+                    unsigned length = static_cast<unsigned>(readBits(pos, 5)) + 1;
+                    trailing = 32 - leading - length;
+                }
+                unsigned length = 32 - leading - trailing;
+                bits ^= static_cast<std::uint32_t>(readBits(pos, length) << trailing);
+            }
+            if (!fn(timestamp, bitsToFloat(bits))) return;
+        }
+    }
+
+private:
+    static constexpr unsigned kNoWindow = 255;
+
+    void writeBits(std::uint64_t value, unsigned n) {
+        if (n == 0) return;
+        if (n < 64) value &= (std::uint64_t{1} << n) - 1;
+        unsigned used = static_cast<unsigned>(bitCount & 63);
+        if (used == 0) words.push_back(0);
+        unsigned space = 64 - used;
+        if (n <= space) {
+            words.back() |= value << (space - n);
+        }
+        else {
+            words.back() |= value >> (n - space);
+            words.push_back(value << (64 - (n - space)));
+        }
+        bitCount += n;
+    }
+
+    std::uint64_t readBits(std::size_t& pos, unsigned n) const {
+        unsigned used = static_cast<unsigned>(pos & 63);
+        std::size_t word = pos >> 6;
+        unsigned available = 64 - used;
+        std::uint64_t result;
+        if (n <= available) {
+            result = (words[word] << used) >> (64 - n);
+        }
+        else {
+            unsigned rest = n - available;
+            result = (((words[word] << used) >> used) << rest) | (words[word + 1] >> (64 - rest));
+        }
+        pos += n;
+        return result;
+    }
+
+    // zig-zag the delta-of-delta so small negative jitter also gets a short code
+    void encodeTimestamp(std::int64_t timestamp) {
+        std::int64_t delta = timestamp - prevTimestamp;
+        std::int64_t dod = delta - prevDelta;
+        prevDelta = delta;
+        std::uint64_t zigzag = (static_cast<std::uint64_t>(dod) << 1) ^ static_cast<std::uint64_t>(dod >> 63);
+
+        if (zigzag == 0) {
+            writeBits(0b0, 1);
+        }
+        else if (zigzag < (1u << 7)) {
+            writeBits(0b10, 2);
+            writeBits(zigzag, 7);
+        }
+        else if (zigzag < (1u << 9)) {
+            writeBits(0b110, 3);
+            writeBits(zigzag, 9);
+        }
+        else if (zigzag < (1u << 12)) {
+            writeBits(0b1110, 4);
+            writeBits(zigzag, 12);
+        }
+        else {
+            writeBits(0b1111, 4);
+            writeBits(zigzag, 64);
+        }
+    }
+
+    std::int64_t decodeDeltaOfDelta(std::size_t& pos) const {
+        unsigned width;
+        if (readBits(pos, 1) == 0) return 0;
+        if (readBits(pos, 1) == 0) width = 7;
+        else if (readBits(pos, 1) == 0) width = 9;
+        else if (readBits(pos, 1) == 0) width = 12;
+        else width = 64;
+        std::uint64_t zigzag = readBits(pos, width);
+        return static_cast<std::int64_t>(zigzag >> 1) ^ -static_cast<std::int64_t>(zigzag & 1);
+    }
+
+    // 0 = same value, 10 = meaningful bits fit the previous window, 11 = new window
+    void encodeValue(std::uint32_t bits) {
+        std::uint32_t x = bits ^ prevValue;
+        if (x == 0) {
+            writeBits(0b0, 1);
+            return;
+        }
+        unsigned leading = std::min(leadingZeros32(x), 31u);
+        unsigned trailing = trailingZeros32(x);
+        if (prevLeading != kNoWindow && leading >= prevLeading && trailing >= prevTrailing) {
+            writeBits(0b10, 2);
+            writeBits(x >> prevTrailing, 32 - prevLeading - prevTrailing);
+            return;
+        }
+        unsigned length = 32 - leading - trailing;
+        writeBits(0b11, 2);
+        writeBits(leading, 5);
+        writeBits(length - 1, 5);
+        writeBits(x >> trailing, length);
+        prevLeading = leading;
+        prevTrailing = trailing;
+    }
+
+    std::vector<std::uint64_t> words;
+    std::size_t bitCount = 0;
+    std::size_t sampleCount = 0;
+    std::int64_t firstTimestamp = 0;
+    std::int64_t lastTimestamp = 0;
+    HistorySummary summary;
+
+    // encoder state
+    std::int64_t prevTimestamp = 0;
+    std::int64_t prevDelta = 0;
+    std::uint32_t prevValue = 0;
+    unsigned prevLeading = kNoWindow;
+    unsigned prevTrailing = 0;
+};
+
+// Ring of blocks for one station - when the ring is full the oldest block is recycled
+class StationHistory {
+public:
+    StationHistory(std::size_t samplesPerBlock, std::size_t maxBlocks)
+        : blockCapacity(samplesPerBlock), blocks(maxBlocks) {}
+
+    // samples must arrive in time order, older ones are rejected
+    bool append(std::int64_t timestamp, float value) {
+        if (blockCount > 0 && timestamp < newest().last()) return false;
+        if (blockCount == 0 || newest().size() >= blockCapacity) {
+            if (blockCount < blocks.size()) {
+                ++blockCount;
+            }
+            else {
+                head = (head + 1) % blocks.size();
+            }
+            newest().reset();
+        }
+        newest().append(timestamp, value);
+        return true;
+    }
+
+    // oldest to newest
+    template <typename Fn>
+    void forEachBlock(Fn&& fn) const {
+        for (std::size_t i = 0; i < blockCount; ++i) {
+            fn(blocks[(head + i) % blocks.size()]);
+        }
+    }
+
+    std::size_t sampleCount() const {
+        std::size_t total = 0;
+        forEachBlock([&](const HistoryBlock& b) { total += b.size(); });
+        return total;
+    }
+
+    std::size_t encodedBytes() const {
+        std::size_t total = 0;
+        forEachBlock([&](const HistoryBlock& b) { total += b.encodedBytes(); });
+        return total;
+    }
+
+private:
+    HistoryBlock& newest() { return blocks[(head + blockCount - 1) % blocks.size()]; }
+    const HistoryBlock& newest() const { return blocks[(head + blockCount - 1) % blocks.size()]; }
+
+    std::size_t blockCapacity;
+    std::vector<HistoryBlock> blocks;
+    std::size_t head = 0;
+    std::size_t blockCount = 0;
+};
+
+// History for every station in a ForecastStore, indexed by the same StationId
+class ForecastHistory {
+public:
+    // every station keeps at least one block
+    explicit ForecastHistory(std::size_t samplesPerBlock = 128, std::size_t blocksPerStation = 16)
+        : samplesPerBlock(samplesPerBlock), blocksPerStation(std::max<std::size_t>(1, blocksPerStation)) {}
+
+    void resize(std::size_t stations) {
+        while (histories.size() < stations) {
+            histories.emplace_back(samplesPerBlock, blocksPerStation);
+        }
+    }
+
+    bool record(StationId id, std::int64_t timestamp, float value) {
+        resize(static_cast<std::size_t>(id) + 1);
+        return histories[id].append(timestamp, value);
+    }
+
+    // snapshot of every station after a refresh cycle
+    void recordAll(std::int64_t timestamp, const float* temps, std::size_t count) {
+        resize(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            histories[i].append(timestamp, temps[i]);
+        }
+    }
+
+    // min/max/avg over [from, to] - blocks fully inside the range are answered from their header
+    HistorySummary summarize(StationId id, std::int64_t from, std::int64_t to) const {
+        HistorySummary result;
+        if (id >= histories.size()) return result;
+        histories[id].forEachBlock([&](const HistoryBlock& block) {
+            if (block.size() == 0 || block.last() < from || block.first() > to) return;
+            if (block.first() >= from && block.last() <= to) {
+                result.merge(block.stats());
+                return;
+            }
+            block.decode([&](std::int64_t timestamp, float value) {
+                if (timestamp > to) return false;
+                if (timestamp >= from) result.add(value);
+                return true;
+            });
+        });
+        return result;
+    }
+
+    // raw samples in [from, to]
+    std::vector<HistorySample> range(StationId id, std::int64_t from, std::int64_t to) const {
+        std::vector<HistorySample> samples;
+        if (id >= histories.size()) return samples;
+        histories[id].forEachBlock([&](const HistoryBlock& block) {
+            if (block.size() == 0 || block.last() < from || block.first() > to) return;
+            block.decode([&](std::int64_t timestamp, float value) {
+                if (timestamp > to) return false;
+                if (timestamp >= from) samples.push_back({timestamp, value});
+                return true;
+            });
+        });
+        return samples;
+    }
+
+    static constexpr std::uint64_t kMaxDownsampleBuckets = 1 << 20;
+
+    // fixed width buckets starting at from, empty buckets are left out; a range that needs more
+    // than kMaxDownsampleBuckets buckets gives nothing
+    std::vector<HistoryPoint> downsample(StationId id, std::int64_t from, std::int64_t to,
+                                         std::int64_t bucketSeconds) const {
+        std::vector<HistoryPoint> points;
+        if (id >= histories.size() || bucketSeconds <= 0 || to < from) return points;
+        const std::uint64_t span = static_cast<std::uint64_t>(to) - static_cast<std::uint64_t>(from);
+        const std::uint64_t lastBucket = span / static_cast<std::uint64_t>(bucketSeconds);
+        if (lastBucket >= kMaxDownsampleBuckets) return points;
+        std::vector<HistorySummary> buckets(static_cast<std::size_t>(lastBucket + 1));
+
+        // for from <= timestamp <= to, in unsigned math so a range wider than int64 cannot overflow
+        auto bucketOf = [&](std::int64_t timestamp) {
+            return static_cast<std::size_t>((static_cast<std::uint64_t>(timestamp) - static_cast<std::uint64_t>(from)) /
+                                            static_cast<std::uint64_t>(bucketSeconds));
+        };
+        histories[id].forEachBlock([&](const HistoryBlock& block) {
+            if (block.size() == 0 || block.last() < from || block.first() > to) return;
+            if (block.first() >= from && block.last() <= to && bucketOf(block.first()) == bucketOf(block.last())) {
+                buckets[bucketOf(block.first())].merge(block.stats());
+                return;
+            }
+            block.decode([&](std::int64_t timestamp, float value) {
+                if (timestamp > to) return false;
+                if (timestamp >= from) buckets[bucketOf(timestamp)].add(value);
+                return true;
+            });
+        });
+
+        for (std::size_t i = 0; i < buckets.size(); ++i) {
+            if (buckets[i].count == 0) continue;
+            const std::uint64_t start = static_cast<std::uint64_t>(from) + i * static_cast<std::uint64_t>(bucketSeconds);
+            points.push_back({static_cast<std::int64_t>(start), buckets[i]});
+        }
+        return points;
+    }
+
+    std::size_t sampleCount() const {
+        std::size_t total = 0;
+        for (const auto& h : histories) total += h.sampleCount();
+        return total;
+    }
+
+    std::size_t encodedBytes() const {
+        std::size_t total = 0;
+        for (const auto& h : histories) total += h.encodedBytes();
+        return total;
+    }
+
+private:
+    std::size_t samplesPerBlock;
+    std::size_t blocksPerStation;
+    std::vector<StationHistory> histories;
+};
+
+#endif //EMPLOYEE_VALIDATION_C_FORECASTHISTORY_H
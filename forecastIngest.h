@@ -0,0 +1,185 @@
+//
+// Forecast ingestion from a local feed file - stands in for the upstream provider.
+// The file is tailed: every poll maps only the bytes appended since the last poll,
+// parses complete lines in place and hands them to the store as one batch.
+//
+// Feed line format:   station,temperature[,unix seconds]
+// Blank lines and lines starting with '#' are skipped.
+//
+
+#ifndef EMPLOYEE_VALIDATION_C_FORECASTINGEST_H
+#define EMPLOYEE_VALIDATION_C_FORECASTINGEST_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "forecastStore.h"
+#include "mappedFile.h"
+
+struct StationReading {
+    StationId station;
+    float temperature;
+    std::int64_t timestamp;
+};
+
+// Decimal temperature like "-12.5" - no locale, no allocation
+inline bool parseTemperature(std::string_view text, float& value) {
+    std::size_t i = 0;
+    bool negative = false;
+    if (i < text.size() && (text[i] == '-' || text[i] == '+')) {
+        negative = text[i] == '-';
+        ++i;
+    }
+    if (i >= text.size()) return false;
+
+    // 18 digits always fit in the accumulator; longer whole parts are rejected, not overflowed
+    std::int64_t whole = 0;
+    std::size_t digits = 0;
+    for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i, ++digits) {
+        if (digits == 18) return false;
+        whole = whole * 10 + (text[i] - '0');
+    }
+    double fraction = 0.0;
+    if (i < text.size() && text[i] == '.') {
+        double scale = 0.1;
+        for (++i; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i, ++digits) {
+            fraction += (text[i] - '0') * scale;
+            scale *= 0.1;
+        }
+    }
+    if (digits == 0 || i != text.size()) return false;
+    double result = static_cast<double>(whole) + fraction;
+    value = static_cast<float>(negative ? -result : result);
+    return true;
+}
+
+inline bool parseInt64(std::string_view text, std::int64_t& value) {
+    if (text.empty()) return false;
+    std::size_t i = 0;
+    bool negative = text[0] == '-';
+    if (negative) ++i;
+    if (i >= text.size() || text.size() - i > 18) return false;   // 18 digits cannot overflow
+    std::int64_t result = 0;
+    for (; i < text.size(); ++i) {
+        if (text[i] < '0' || text[i] > '9') return false;
+        result = result * 10 + (text[i] - '0');
+    }
+    value = negative ? -result : result;
+    return true;
+}
+
+// Parses one feed line. Unknown stations are added to the store (the feed defines the stations).
+inline bool parseFeedLine(std::string_view line, ForecastStore& store, std::int64_t defaultTimestamp,
+                          StationReading& reading) {
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    std::size_t firstComma = line.find(',');
+    if (firstComma == std::string_view::npos || firstComma == 0) return false;
+    std::string_view name = line.substr(0, firstComma);
+    std::string_view rest = line.substr(firstComma + 1);
+
+    std::size_t secondComma = rest.find(',');
+    std::string_view temperatureText = rest.substr(0, secondComma);
+    if (!parseTemperature(temperatureText, reading.temperature)) return false;
+
+    reading.timestamp = defaultTimestamp;
+    if (secondComma != std::string_view::npos && !parseInt64(rest.substr(secondComma + 1), reading.timestamp)) {
+        return false;
+    }
+
+    if (!store.findStation(name, reading.station)) {
+        reading.station = store.addStation(name, reading.temperature);
+    }
+    return true;
+}
+
+// Parses every complete line in text, returns how many bytes were consumed
+// (a trailing partial line is left for the next poll)
+inline std::size_t parseFeedChunk(std::string_view text, ForecastStore& store, std::int64_t defaultTimestamp,
+                                  std::vector<StationReading>& batch, std::size_t& rejected) {
+    const char* begin = text.data();
+    const char* end = begin + text.size();
+    const char* cursor = begin;
+    StationReading reading;
+
+    while (cursor < end) {
+        const char* newline = static_cast<const char*>(std::memchr(cursor, '\n', static_cast<std::size_t>(end - cursor)));
+        if (newline == nullptr) break;
+        std::string_view line(cursor, static_cast<std::size_t>(newline - cursor));
+        cursor = newline + 1;
+
+        if (line.empty() || line[0] == '#' || line == "\r") continue;
+        if (parseFeedLine(line, store, defaultTimestamp, reading)) {
+            batch.push_back(reading);
+        }
+        else {
+            ++rejected;
+        }
+    }
+    return static_cast<std::size_t>(cursor - begin);
+}
+
+// Applies a batch of readings - the latest reading for a station wins
+inline void applyReadings(ForecastStore& store, const std::vector<StationReading>& batch) {
+    for (const StationReading& reading : batch) {
+        store.setTemperature(reading.station, reading.temperature);
+    }
+}
+
+// Follows a feed file as it grows
+class FeedTailer {
+public:
+    explicit FeedTailer(std::string path, std::size_t windowBytes = 64u << 20)
+        : path(std::move(path)), windowBytes(windowBytes) {}
+
+    FeedTailer(const FeedTailer&) = delete;
+    FeedTailer& operator=(const FeedTailer&) = delete;
+    ~FeedTailer() { closeFile(fd); }
+
+    // Maps whatever was appended since the last call and parses the complete lines into batch.
+    // Returns false when the file cannot be opened or mapped.
+    bool poll(ForecastStore& store, std::int64_t defaultTimestamp, std::vector<StationReading>& batch) {
+        if (fd < 0) {
+            fd = openReadOnly(path);
+            if (fd < 0) return false;
+        }
+        std::int64_t size = fileSize(fd);
+        if (size < 0) return false;
+        if (static_cast<std::uint64_t>(size) < offset) {
+            offset = 0;   // truncated or rotated, start over
+        }
+
+        while (offset < static_cast<std::uint64_t>(size)) {
+            std::size_t length = static_cast<std::size_t>(std::min<std::uint64_t>(windowBytes, static_cast<std::uint64_t>(size) - offset));
+            if (!region.map(fd, offset, length)) return false;
+            std::size_t consumed = parseFeedChunk(region.view(), store, defaultTimestamp, batch, rejectedLines);
+            region.unmap();
+            if (consumed == 0) {
+                // no newline in the window: a partial line still being written, or a line longer than the window
+                if (length == windowBytes) windowBytes *= 2;
+                else break;
+                continue;
+            }
+            offset += consumed;
+        }
+        return true;
+    }
+
+    std::uint64_t position() const { return offset; }
+    std::size_t rejected() const { return rejectedLines; }
+
+private:
+    std::string path;
+    std::size_t windowBytes;
+    int fd = -1;
+    std::uint64_t offset = 0;
+    std::size_t rejectedLines = 0;
+    MappedRegion region;
+};
+
+#endif //EMPLOYEE_VALIDATION_C_FORECASTINGEST_H
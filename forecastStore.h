@@ -0,0 +1,221 @@
+//
+// Contiguous forecast storage - temperatures live in one aligned array indexed by station id
+// so a refresh is a straight loop the cpu can prefetch and vectorize
+//
+
+#ifndef EMPLOYEE_VALIDATION_C_FORECASTSTORE_H
+#define EMPLOYEE_VALIDATION_C_FORECASTSTORE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "simd.h"
+
+using StationId = std::uint32_t;
+
+// ---- scalar kernels (fallback and reference) ----
+
+inline void addDeltaScalar(float* temps, std::size_t n, float delta) {
+    for (std::size_t i = 0; i < n; ++i) {
+        temps[i] += delta;
+    }
+}
+
+inline void applyDeltasScalar(float* temps, const float* deltas, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        temps[i] += deltas[i];
+    }
+}
+
+inline void clampScalar(float* temps, std::size_t n, float low, float high) {
+    for (std::size_t i = 0; i < n; ++i) {
+        temps[i] = std::min(std::max(temps[i], low), high);
+    }
+}
+
+// new = old + weight * (reading - old), weight 1 means take the reading as is
+inline void blendScalar(float* temps, const float* readings, std::size_t n, float weight) {
+    for (std::size_t i = 0; i < n; ++i) {
+        temps[i] += weight * (readings[i] - temps[i]);
+    }
+}
+
+// ---- AVX2 kernels - 8 stations per step, scalar loop finishes the tail ----
+
+#if EV_X86_SIMD
+EV_TARGET_AVX2 inline void addDeltaAvx2(float* temps, std::size_t n, float delta) {
+    const __m256 d = _mm256_set1_ps(delta);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(temps + i, _mm256_add_ps(_mm256_loadu_ps(temps + i), d));
+    }
+    addDeltaScalar(temps + i, n - i, delta);
+}
+
+EV_TARGET_AVX2 inline void applyDeltasAvx2(float* temps, const float* deltas, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 t = _mm256_loadu_ps(temps + i);
+        _mm256_storeu_ps(temps + i, _mm256_add_ps(t, _mm256_loadu_ps(deltas + i)));
+    }
+    applyDeltasScalar(temps + i, deltas + i, n - i);
+}
+
+EV_TARGET_AVX2 inline void clampAvx2(float* temps, std::size_t n, float low, float high) {
+    const __m256 lo = _mm256_set1_ps(low);
+    const __m256 hi = _mm256_set1_ps(high);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 t = _mm256_loadu_ps(temps + i);
+        _mm256_storeu_ps(temps + i, _mm256_min_ps(_mm256_max_ps(t, lo), hi));
+    }
+    clampScalar(temps + i, n - i, low, high);
+}
+
+EV_TARGET_AVX2 inline void blendAvx2(float* temps, const float* readings, std::size_t n, float weight) {
+    const __m256 w = _mm256_set1_ps(weight);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 t = _mm256_loadu_ps(temps + i);
+        __m256 r = _mm256_loadu_ps(readings + i);
+        _mm256_storeu_ps(temps + i, _mm256_add_ps(t, _mm256_mul_ps(w, _mm256_sub_ps(r, t))));
+    }
+    blendScalar(temps + i, readings + i, n - i, weight);
+}
+#endif
+
+// ---- dispatchers - pick AVX2 when the cpu has it ----
+
+inline void addDelta(float* temps, std::size_t n, float delta) {
+#if EV_X86_SIMD
+    if (cpuHasAvx2()) {
+        addDeltaAvx2(temps, n, delta);
+        return;
+    }
+#endif
+    addDeltaScalar(temps, n, delta);
+}
+
+inline void applyDeltas(float* temps, const float* deltas, std::size_t n) {
+#if EV_X86_SIMD
+    if (cpuHasAvx2()) {
+        applyDeltasAvx2(temps, deltas, n);
+        return;
+    }
+#endif
+    applyDeltasScalar(temps, deltas, n);
+}
+
+inline void clampTemperatures(float* temps, std::size_t n, float low, float high) {
+#if EV_X86_SIMD
+    if (cpuHasAvx2()) {
+        clampAvx2(temps, n, low, high);
+        return;
+    }
+#endif
+    clampScalar(temps, n, low, high);
+}
+
+inline void blendReadings(float* temps, const float* readings, std::size_t n, float weight) {
+#if EV_X86_SIMD
+    if (cpuHasAvx2()) {
+        blendAvx2(temps, readings, n, weight);
+        return;
+    }
+#endif
+    blendScalar(temps, readings, n, weight);
+}
+
+// Forecast storage: station names are only needed for display and lookup,
+// the hot data (temperatures) is a separate aligned array
+class ForecastStore {
+public:
+    using FloatArray = std::vector<float, AlignedAllocator<float>>;
+
+    void reserve(std::size_t count) {
+        names.reserve(count);
+        temperatures.reserve(count);
+    }
+
+    StationId addStation(std::string_view name, float temperature) {
+        StationId id;
+        if (findStation(name, id)) {
+            temperatures[id] = temperature;
+            return id;
+        }
+        id = static_cast<StationId>(names.size());
+        names.emplace_back(name);
+        temperatures.push_back(temperature);
+        if ((names.size() * 2) > slots.size()) {
+            rehash(slots.empty() ? 16 : slots.size() * 2);
+        }
+        else {
+            insertSlot(id);
+        }
+        return id;
+    }
+
+    // returns false when the station is unknown - takes a string_view so parsers can
+    // look names up straight out of their input buffer without building a std::string
+    bool findStation(std::string_view name, StationId& id) const {
+        if (slots.empty()) return false;
+        std::size_t mask = slots.size() - 1;
+        for (std::size_t i = hashName(name) & mask;; i = (i + 1) & mask) {
+            StationId candidate = slots[i];
+            if (candidate == kEmptySlot) return false;
+            if (names[candidate] == name) {
+                id = candidate;
+                return true;
+            }
+        }
+    }
+
+    void setTemperature(StationId id, float temperature) { temperatures[id] = temperature; }
+
+    std::size_t size() const { return temperatures.size(); }
+    const std::string& name(StationId id) const { return names[id]; }
+    float temperature(StationId id) const { return temperatures[id]; }
+    float* data() { return temperatures.data(); }
+    const float* data() const { return temperatures.data(); }
+
+    // bulk updates over every station
+    void addDelta(float delta) { ::addDelta(data(), size(), delta); }
+    void applyDeltas(const FloatArray& deltas) { ::applyDeltas(data(), deltas.data(), std::min(size(), deltas.size())); }
+    void clamp(float low, float high) { clampTemperatures(data(), size(), low, high); }
+    void blend(const FloatArray& readings, float weight) { blendReadings(data(), readings.data(), std::min(size(), readings.size()), weight); }
+
+private:
+    static constexpr StationId kEmptySlot = 0xFFFFFFFFu;
+
+    // FNV-1a
+    static std::size_t hashName(std::string_view name) {
+        std::uint64_t hash = 14695981039346656037ull;
+        for (char c : name) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ull;
+        }
+        return static_cast<std::size_t>(hash ^ (hash >> 32));
+    }
+
+    void insertSlot(StationId id) {
+        std::size_t mask = slots.size() - 1;
+        std::size_t i = hashName(names[id]) & mask;
+        while (slots[i] != kEmptySlot) i = (i + 1) & mask;
+        slots[i] = id;
+    }
+
+    void rehash(std::size_t capacity) {
+        slots.assign(capacity, kEmptySlot);
+        for (StationId id = 0; id < names.size(); ++id) insertSlot(id);
+    }
+
+    std::vector<std::string> names;
+    FloatArray temperatures;
+    std::vector<StationId> slots;   // open addressing name index, holds station ids
+};
+
+#endif //EMPLOYEE_VALIDATION_C_FORECASTSTORE_H
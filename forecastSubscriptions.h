@@ -0,0 +1,229 @@
+//
+// Change notifications for forecast consumers - the refresher publishes only the stations
+// whose temperature actually moved, subscribers poll for what changed since their cursor.
+//
+// Station subscribers are answered by checking just their own stations, so their cost does not
+// grow with the number of updates. Predicate subscribers read the change journal; if they fall
+// so far behind that the journal wrapped, they get one coalesced resync instead of a backlog.
+//
+
+#ifndef EMPLOYEE_VALIDATION_C_FORECASTSUBSCRIPTIONS_H
+#define EMPLOYEE_VALIDATION_C_FORECASTSUBSCRIPTIONS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "forecastStore.h"
+
+using SubscriberId = std::uint32_t;
+
+struct ForecastChange {
+    StationId station;
+    float temperature;
+};
+
+// What a subscriber gets back from poll - at most one entry per station (latest value)
+struct ForecastChangeSet {
+    std::uint64_t fromCursor = 0;
+    std::uint64_t toCursor = 0;
+    bool resynced = false;   // journal wrapped, changes were rebuilt from the per-station versions
+    std::vector<ForecastChange> changes;
+};
+
+// Finds stations whose value differs from the last published one, appends their ids to changed
+inline void collectChangedScalar(const float* current, const float* previous, std::size_t begin,
+                                 std::size_t n, std::vector<StationId>& changed) {
+    for (std::size_t i = begin; i < n; ++i) {
+        if (current[i] != previous[i]) changed.push_back(static_cast<StationId>(i));
+    }
+}
+
+#if EV_X86_SIMD
+// compares 8 stations at once and only walks the lanes that differ
+EV_TARGET_AVX2 inline void collectChangedAvx2(const float* current, const float* previous,
+                                              std::size_t n, std::vector<StationId>& changed) {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 diff = _mm256_cmp_ps(_mm256_loadu_ps(current + i), _mm256_loadu_ps(previous + i), _CMP_NEQ_UQ);
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(diff));
+        while (mask != 0) {
+            changed.push_back(static_cast<StationId>(i + static_cast<unsigned>(__builtin_ctz(mask))));
+            mask &= mask - 1;
+        }
+    }
+    collectChangedScalar(current, previous, i, n, changed);
+}
+#endif
+
+inline void collectChanged(const float* current, const float* previous, std::size_t n,
+                           std::vector<StationId>& changed) {
+#if EV_X86_SIMD
+    if (cpuHasAvx2()) {
+        collectChangedAvx2(current, previous, n, changed);
+        return;
+    }
+#endif
+    collectChangedScalar(current, previous, 0, n, changed);
+}
+
+class ForecastChangeFeed {
+public:
+    using Predicate = std::function<bool(StationId, float)>;
+
+    explicit ForecastChangeFeed(std::size_t journalCapacity = 1 << 16)
+        : journal(journalCapacity) {}
+
+    // interest in a fixed set of stations
+    SubscriberId subscribe(std::vector<StationId> stations) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::sort(stations.begin(), stations.end());
+        stations.erase(std::unique(stations.begin(), stations.end()), stations.end());
+        Subscriber sub;
+        sub.stations = std::move(stations);
+        sub.cursor = sequence;
+        return addSubscriber(std::move(sub));
+    }
+
+    // interest in any station whose new value matches the predicate
+    SubscriberId subscribe(Predicate predicate) {
+        std::lock_guard<std::mutex> lock(mutex);
+        Subscriber sub;
+        sub.predicate = std::move(predicate);
+        sub.cursor = sequence;
+        return addSubscriber(std::move(sub));
+    }
+
+    void unsubscribe(SubscriberId id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        subscribers.erase(id);
+    }
+
+    // Publisher side - called after a refresh cycle. Returns the new cursor.
+    std::uint64_t publish(const float* temps, std::size_t count) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::size_t known = std::min(published.size(), count);
+        changedScratch.clear();
+        collectChanged(temps, published.data(), known, changedScratch);
+        // stations added since the last publish always count as changed
+        for (std::size_t i = known; i < count; ++i) changedScratch.push_back(static_cast<StationId>(i));
+        if (published.size() < count) {
+            published.resize(count);
+            versions.resize(count, 0);
+        }
+        if (changedScratch.empty()) return sequence;
+
+        ++sequence;
+        for (StationId id : changedScratch) {
+            published[id] = temps[id];
+            versions[id] = sequence;
+            journal[journalEnd % journal.size()] = id;
+            ++journalEnd;
+        }
+        journalStart.push_back({sequence, journalEnd - changedScratch.size()});
+        // forget batches whose entries were overwritten
+        while (!journalStart.empty() && journalStart.front().firstEntry + journal.size() < journalEnd) {
+            journalStart.pop_front();
+        }
+        return sequence;
+    }
+
+    // Consumer side - everything this subscriber cares about that changed since its last poll
+    ForecastChangeSet poll(SubscriberId id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ForecastChangeSet result;
+        auto found = subscribers.find(id);
+        if (found == subscribers.end()) return result;
+        Subscriber& sub = found->second;
+        result.fromCursor = sub.cursor;
+        result.toCursor = sequence;
+        if (sub.cursor == sequence) return result;
+
+        if (!sub.predicate) {
+            for (StationId station : sub.stations) {
+                if (station < versions.size() && versions[station] > sub.cursor) {
+                    result.changes.push_back({station, published[station]});
+                }
+            }
+        }
+        else {
+            pollPredicate(sub, result);
+        }
+        sub.cursor = sequence;
+        return result;
+    }
+
+    std::uint64_t cursor() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return sequence;
+    }
+
+private:
+    struct Subscriber {
+        std::vector<StationId> stations;   // sorted, used when there is no predicate
+        Predicate predicate;
+        std::uint64_t cursor = 0;
+    };
+
+    struct JournalBatch {
+        std::uint64_t sequence;
+        std::uint64_t firstEntry;   // position in the journal ring where the batch starts
+    };
+
+    SubscriberId addSubscriber(Subscriber sub) {
+        SubscriberId id = nextSubscriber++;
+        subscribers.emplace(id, std::move(sub));
+        return id;
+    }
+
+    void pollPredicate(const Subscriber& sub, ForecastChangeSet& result) {
+        // the journal still holds every batch after the cursor only if its oldest batch is not newer
+        if (!journalStart.empty() && journalStart.front().sequence <= sub.cursor + 1) {
+            // batches have consecutive sequence numbers, so the start can be indexed directly
+            const JournalBatch& start = journalStart[sub.cursor + 1 - journalStart.front().sequence];
+            candidates.clear();
+            for (std::uint64_t pos = start.firstEntry; pos < journalEnd; ++pos) {
+                candidates.push_back(journal[pos % journal.size()]);
+            }
+            // coalesce: a station updated in several batches is reported once
+            std::sort(candidates.begin(), candidates.end());
+            candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+            for (StationId station : candidates) {
+                if (sub.predicate(station, published[station])) {
+                    result.changes.push_back({station, published[station]});
+                }
+            }
+            return;
+        }
+
+        // too slow, rebuild from per-station versions
+        result.resynced = true;
+        for (std::size_t station = 0; station < versions.size(); ++station) {
+            if (versions[station] > sub.cursor && sub.predicate(static_cast<StationId>(station), published[station])) {
+                result.changes.push_back({static_cast<StationId>(station), published[station]});
+            }
+        }
+    }
+
+    mutable std::mutex mutex;
+    std::uint64_t sequence = 0;
+    std::vector<float> published;          // last value sent out per station
+    std::vector<std::uint64_t> versions;   // sequence of the last change per station
+
+    std::vector<StationId> journal;        // ring of changed station ids
+    std::uint64_t journalEnd = 0;
+    std::deque<JournalBatch> journalStart;
+
+    std::unordered_map<SubscriberId, Subscriber> subscribers;
+    SubscriberId nextSubscriber = 1;
+
+    std::vector<StationId> changedScratch;
+    std::vector<StationId> candidates;
+};
+
+#endif //EMPLOYEE_VALIDATION_C_FORECASTSUBSCRIPTIONS_H
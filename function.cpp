@@ -1,15 +1,82 @@
 #include <iostream>
-#include <string>
+#include <string_view>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 
-void myFunction(std::string country , int age, std::string timeZone = "CST") {
-    std::cout << country << age << timeZone<< "\n";
+#include "timeZones.h"
+#include "timestampService.h"
+
+// string_view parameters - the literals are passed as pointer + length, nothing is copied.
+// The time zone is resolved through the abbreviation table and shown with its local time now.
+void myFunction(std::string_view country , int age, std::string_view timeZone = "CST") {
+    std::cout << country << age << timeZone;
+    const TimeZone* zone = findTimeZone(timeZone);
+    if (zone == nullptr) {
+        std::cout << " (unknown time zone)\n";
+        return;
+    }
+    std::int64_t now = TimestampService::instance().seconds();
+    std::int32_t offset = offsetAt(*zone, now);
+    char offsetText[10];
+    char localText[20];
+    formatUtcOffset(offset, offsetText);
+    formatLocalTime(now + offset, localText);
+    std::cout << " (" << zone->name << ", now " << offsetText << ", " << localText << ")\n";
+}
+
+// --tz-bench [timestamps] [zone] - batch conversion through the cached transition table against
+// evaluating the daylight saving rule for every timestamp
+int runTimeZoneBenchmark(std::size_t count, std::string_view abbreviation) {
+    const TimeZone* zone = findTimeZone(abbreviation);
+    if (zone == nullptr) {
+        std::cout << "Unknown time zone " << abbreviation << "\n";
+        return 1;
+    }
+    // log style: ascending, a few seconds apart from 2020 on; and random instants over 1970-2099
+    std::vector<std::int64_t> ascending(count), scattered(count);
+    std::uint64_t state = 88172645463325252ull;
+    std::int64_t t = daysFromCivil(2020, 1, 1) * 86400;
+    const std::int64_t span = (daysFromCivil(2100, 1, 1) - daysFromCivil(1970, 1, 1)) * 86400;
+    for (std::size_t i = 0; i < count; ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        t += static_cast<std::int64_t>(state % 60);
+        ascending[i] = t;
+        scattered[i] = static_cast<std::int64_t>((state >> 8) % static_cast<std::uint64_t>(span));
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto nsPer = [&](Clock::time_point a, Clock::time_point b) {
+        return std::chrono::duration<double, std::nano>(b - a).count() / static_cast<double>(count);
+    };
+    std::vector<std::int64_t> batch(count), byRule(count);
+    std::cout << "Zone: " << zone->name << " | " << count << " timestamps\n";
+    for (const auto* input : {&ascending, &scattered}) {
+        transitionTable(*zone);   // built outside the timing
+        auto t0 = Clock::now();
+        utcToLocalBatch(*zone, *input, batch);
+        auto t1 = Clock::now();
+        for (std::size_t i = 0; i < count; ++i) byRule[i] = (*input)[i] + offsetAt(*zone, (*input)[i]);
+        auto t2 = Clock::now();
+        std::cout << (input == &ascending ? "  ascending: " : "  scattered: ") << "batch " << nsPer(t0, t1)
+                  << " ns | rule per timestamp " << nsPer(t1, t2) << " ns"
+                  << (batch == byRule ? "" : " | MISMATCH") << "\n";
+    }
+    return 0;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::strcmp(argv[1], "--tz-bench") == 0) {
+        return runTimeZoneBenchmark(argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10000000,
+                                    argc > 3 ? argv[3] : "CST");
+    }
     myFunction("USA", 100, "EST");
     return 0;
 }
 
 //Output
 // India
-// USA
\ No newline at end of file
+// USA
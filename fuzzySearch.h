@@ -0,0 +1,235 @@
+//
+// Approximate (typo tolerant) search over a catalog of names such as car brands and models.
+//
+// Every name is indexed by its padded trigrams. By the q-gram lemma a name within edit distance
+// k shares all but 3k of the query's trigrams, so a query counts shared trigrams per name (new
+// names only come from the shortest lists, and only names whose length is within k are looked
+// at) and checks just the names that reach the threshold. The check is Myers' bit-parallel
+// Levenshtein distance: one pass over the name with the query held in 64 bit vectors, stopping
+// early once it cannot finish within k. Matching ignores ASCII case.
+//
+
+#ifndef EMPLOYEE_VALIDATION_C_FUZZYSEARCH_H
+#define EMPLOYEE_VALIDATION_C_FUZZYSEARCH_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "asciiFold.h"
+
+// Levenshtein distance of pattern (at most 64 bytes, already folded) against text, or k + 1
+// as soon as it is clear the result would be above k
+inline unsigned myersDistance(const std::uint64_t (&peq)[256], std::size_t m, std::string_view text, unsigned k) {
+    const std::uint64_t high = std::uint64_t{1} << (m - 1);
+    std::uint64_t pv = ~std::uint64_t{0};
+    std::uint64_t mv = 0;
+    std::size_t score = m;
+    for (std::size_t j = 0; j < text.size(); ++j) {
+        std::uint64_t eq = peq[static_cast<unsigned char>(foldAscii(text[j]))];
+        std::uint64_t xv = eq | mv;
+        std::uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        std::uint64_t ph = mv | ~(xh | pv);
+        std::uint64_t mh = pv & xh;
+        if (ph & high) ++score;
+        else if (mh & high) --score;
+        ph = (ph << 1) | 1;   // global distance: row 0 grows by one per text character
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+        // each remaining character lowers the score by at most one
+        if (score > k + (text.size() - j - 1)) return k + 1;
+    }
+    return score > k ? k + 1 : static_cast<unsigned>(score);
+}
+
+// plain dynamic programming, for queries longer than 64 bytes (and as a reference)
+inline unsigned editDistance(std::string_view a, std::string_view b) {
+    std::vector<unsigned> row(b.size() + 1);
+    for (std::size_t j = 0; j <= b.size(); ++j) row[j] = static_cast<unsigned>(j);
+    for (std::size_t i = 1; i <= a.size(); ++i) {
+        unsigned diagonal = row[0];
+        row[0] = static_cast<unsigned>(i);
+        for (std::size_t j = 1; j <= b.size(); ++j) {
+            unsigned above = row[j];
+            unsigned cost = foldAscii(a[i - 1]) == foldAscii(b[j - 1]) ? 0 : 1;
+            row[j] = std::min({row[j] + 1, row[j - 1] + 1, diagonal + cost});
+            diagonal = above;
+        }
+    }
+    return row[b.size()];
+}
+
+struct FuzzyMatch {
+    std::uint32_t term;   // FuzzyIndex::term(id)
+    unsigned distance;
+};
+
+class FuzzyIndex {
+public:
+    // Adds a name (duplicates are ignored) and returns its id; call build() after the last add
+    std::uint32_t add(std::string_view name) {
+        std::string folded(name);
+        toLowerAsciiInPlace(folded);
+        auto [entry, inserted] = ids.emplace(folded, static_cast<std::uint32_t>(names.size()));
+        if (inserted) {
+            names.push_back(std::move(folded));
+            built = false;
+        }
+        return entry->second;
+    }
+
+    std::size_t size() const { return names.size(); }
+    const std::string& term(std::uint32_t id) const { return names[id]; }
+
+    // inverted trigram lists in one flat array; each list is sorted by name length so a query
+    // only walks the names whose length is within k of its own
+    void build() {
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> pairs;
+        lengths.resize(names.size());
+        for (std::uint32_t id = 0; id < names.size(); ++id) {
+            lengths[id] = static_cast<std::uint32_t>(names[id].size());
+            forEachGram(names[id], [&](std::uint32_t gram) { pairs.emplace_back(gram, id); });
+        }
+        std::sort(pairs.begin(), pairs.end(), [&](const auto& a, const auto& b) {
+            if (a.first != b.first) return a.first < b.first;
+            if (lengths[a.second] != lengths[b.second]) return lengths[a.second] < lengths[b.second];
+            return a.second < b.second;
+        });
+        grams.clear();
+        offsets.clear();
+        postings.clear();
+        postings.reserve(pairs.size());
+        for (const auto& [gram, id] : pairs) {
+            if (grams.empty() || grams.back() != gram) {
+                grams.push_back(gram);
+                offsets.push_back(static_cast<std::uint32_t>(postings.size()));
+            }
+            postings.push_back(id);
+        }
+        offsets.push_back(static_cast<std::uint32_t>(postings.size()));
+        counts.assign(names.size(), 0);
+        built = true;
+    }
+
+    // Best matches within distance k, closest first (ties by name), at most limit of them
+    std::vector<FuzzyMatch> search(std::string_view query, unsigned k, std::size_t limit = 10) {
+        if (!built) build();
+        std::string folded(query);
+        toLowerAsciiInPlace(folded);
+        const std::size_t m = folded.size();
+        std::vector<FuzzyMatch> matches;
+        if (m == 0) return matches;
+
+        std::uint64_t peq[256] = {};
+        const bool bitParallel = m <= 64;
+        if (bitParallel) {
+            for (std::size_t i = 0; i < m; ++i) peq[static_cast<unsigned char>(folded[i])] |= std::uint64_t{1} << i;
+        }
+        auto check = [&](std::uint32_t id) {
+            const std::string& name = names[id];
+            if (name.size() + k < m || m + k < name.size()) return;
+            unsigned distance = bitParallel ? myersDistance(peq, m, name, k) : editDistance(folded, name);
+            if (distance <= k) matches.push_back(FuzzyMatch{id, distance});
+        };
+
+        // q-gram lemma: one edit touches at most 3 grams, so a match keeps all but 3k of the
+        // query's distinct grams; with no more than 3k grams the filter cannot rule anything out
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> lists;   // posting range per query gram
+        forEachGram(folded, [&](std::uint32_t gram) {
+            auto found = std::lower_bound(grams.begin(), grams.end(), gram);
+            if (found == grams.end() || *found != gram) {
+                lists.emplace_back(0, 0);
+                return;
+            }
+            std::size_t g = static_cast<std::size_t>(found - grams.begin());
+            auto lengthBelow = [&](std::uint32_t id, std::size_t length) { return lengths[id] < length; };
+            auto begin = postings.begin() + offsets[g];
+            auto end = postings.begin() + offsets[g + 1];
+            auto first = std::lower_bound(begin, end, m > k ? m - k : 0, lengthBelow);
+            auto last = std::lower_bound(first, end, m + k + 1, lengthBelow);
+            lists.emplace_back(static_cast<std::uint32_t>(first - postings.begin()),
+                               static_cast<std::uint32_t>(last - postings.begin()));
+        });
+
+        lastCandidates = 0;
+        const std::size_t needed = lists.size() > 3 * static_cast<std::size_t>(k) ? lists.size() - 3 * k : 0;
+        if (needed == 0) {
+            lastCandidates = names.size();
+            for (std::uint32_t id = 0; id < names.size(); ++id) check(id);
+        }
+        else {
+            // a match is in at least one of the shortest lists.size() - needed + 1 lists, so only
+            // those add new names; the rest just count for names already seen
+            std::sort(lists.begin(), lists.end(), [](const auto& a, const auto& b) {
+                return a.second - a.first < b.second - b.first;
+            });
+            const std::size_t seeding = lists.size() - needed + 1;
+            touched.clear();
+            for (std::size_t l = 0; l < lists.size(); ++l) {
+                for (std::uint32_t p = lists[l].first; p < lists[l].second; ++p) {
+                    std::uint32_t id = postings[p];
+                    if (counts[id] == 0) {
+                        if (l >= seeding) continue;
+                        touched.push_back(id);
+                    }
+                    ++counts[id];
+                }
+            }
+            for (std::uint32_t id : touched) {
+                if (counts[id] >= needed) {
+                    ++lastCandidates;
+                    check(id);
+                }
+                counts[id] = 0;
+            }
+        }
+
+        std::sort(matches.begin(), matches.end(), [&](const FuzzyMatch& a, const FuzzyMatch& b) {
+            return a.distance != b.distance ? a.distance < b.distance : names[a.term] < names[b.term];
+        });
+        if (matches.size() > limit) matches.resize(limit);
+        return matches;
+    }
+
+    // names that went through the distance check in the last search
+    std::size_t candidatesChecked() const { return lastCandidates; }
+
+private:
+    // padded trigrams: "ab" -> "\1\1a", "\1ab", "ab\2", "b\2\2" (a repeated gram is counted once)
+    template <typename Fn>
+    static void forEachGram(std::string_view text, Fn&& fn) {
+        std::string padded;
+        padded.reserve(text.size() + 4);
+        padded.append(2, '\1');
+        padded.append(text);
+        padded.append(2, '\2');
+        std::vector<std::uint32_t> seen;
+        for (std::size_t i = 0; i + 3 <= padded.size(); ++i) {
+            std::uint32_t gram = static_cast<std::uint32_t>(static_cast<unsigned char>(padded[i])) << 16 |
+                                 static_cast<std::uint32_t>(static_cast<unsigned char>(padded[i + 1])) << 8 |
+                                 static_cast<std::uint32_t>(static_cast<unsigned char>(padded[i + 2]));
+            if (std::find(seen.begin(), seen.end(), gram) != seen.end()) continue;
+            seen.push_back(gram);
+            fn(gram);
+        }
+    }
+
+    std::vector<std::string> names;          // folded
+    std::unordered_map<std::string, std::uint32_t> ids;   // folded name -> id, for dedup on add
+    std::vector<std::uint32_t> grams;
+    std::vector<std::uint32_t> offsets;      // postings of grams[g] are [offsets[g], offsets[g + 1])
+    std::vector<std::uint32_t> postings;
+    std::vector<std::uint32_t> lengths;      // name lengths, so the list windows do not touch the strings
+    std::vector<std::uint16_t> counts;       // per name, only non zero while a search runs
+    std::vector<std::uint32_t> touched;
+    std::size_t lastCandidates = 0;
+    bool built = false;
+};
+
+#endif //EMPLOYEE_VALIDATION_C_FUZZYSEARCH_H
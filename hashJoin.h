@@ -0,0 +1,187 @@
+//
+// Radix-partitioned parallel hash join on 64 bit ids (employees against person records).
+//
+// Both inputs are scattered into 2^bits partitions by the high bits of a multiplicative hash,
+// with enough partitions that one build-side partition (the smaller input) fits in L2. Each
+// partition pair is then joined independently: a chained hash table over the build tuples,
+// probed by the other side. Partitions are handed out to threads dynamically.
+//
+// Output is by row position in the inputs: matched pairs plus the rows of each side that
+// found no partner (an id that appears twice on one side matches once per occurrence). All
+// three lists come back in partition order, not input order - sort them if the order matters.
+//
+
+#ifndef EMPLOYEE_VALIDATION_C_HASHJOIN_H
+#define EMPLOYEE_VALIDATION_C_HASHJOIN_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+struct JoinTuple {
+    std::uint64_t key;
+    std::uint32_t row;
+};
+
+struct JoinResult {
+    std::vector<std::uint32_t> matchedLeft;    // matchedLeft[i] pairs with matchedRight[i]
+    std::vector<std::uint32_t> matchedRight;
+    std::vector<std::uint32_t> unmatchedLeft;
+    std::vector<std::uint32_t> unmatchedRight;
+};
+
+inline std::uint64_t joinHash(std::uint64_t key) {
+    return key * 0x9E3779B97F4A7C15ull;
+}
+
+// enough partitions that one build partition (~16K tuples, 256 KB) stays in L2
+inline unsigned joinRadixBits(std::size_t buildRows) {
+    constexpr std::size_t kTuplesPerPartition = 16384;
+    unsigned bits = 0;
+    while (bits < 12 && (buildRows >> bits) > kTuplesPerPartition) ++bits;
+    return bits;
+}
+
+// Scatters keys into partitions; offsets gets partitions + 1 entries. Every thread histograms
+// its own slice first so the scatter writes without any synchronisation.
+inline void radixPartition(const std::uint64_t* keys, std::size_t n, unsigned bits, unsigned threads,
+                           std::vector<JoinTuple>& out, std::vector<std::size_t>& offsets) {
+    const std::size_t partitions = std::size_t{1} << bits;
+    const unsigned shift = 64 - bits;
+    auto partitionOf = [&](std::uint64_t key) {
+        return bits == 0 ? std::size_t{0} : static_cast<std::size_t>(joinHash(key) >> shift);
+    };
+    if (threads == 0) threads = 1;
+    std::vector<std::vector<std::size_t>> histograms(threads, std::vector<std::size_t>(partitions, 0));
+    auto slice = [&](unsigned t) { return std::make_pair(n * t / threads, n * (t + 1) / threads); };
+
+    auto runThreads = [&](auto&& body) {
+        std::vector<std::thread> pool;
+        for (unsigned t = 1; t < threads; ++t) pool.emplace_back(body, t);
+        body(0u);
+        for (auto& thread : pool) thread.join();
+    };
+
+    runThreads([&](unsigned t) {
+        auto [begin, end] = slice(t);
+        std::vector<std::size_t>& histogram = histograms[t];
+        for (std::size_t i = begin; i < end; ++i) ++histogram[partitionOf(keys[i])];
+    });
+
+    // turn counts into per thread write cursors, partition major so each partition is contiguous
+    offsets.assign(partitions + 1, 0);
+    std::size_t cursor = 0;
+    for (std::size_t p = 0; p < partitions; ++p) {
+        offsets[p] = cursor;
+        for (unsigned t = 0; t < threads; ++t) {
+            std::size_t count = histograms[t][p];
+            histograms[t][p] = cursor;
+            cursor += count;
+        }
+    }
+    offsets[partitions] = cursor;
+
+    out.resize(n);
+    runThreads([&](unsigned t) {
+        auto [begin, end] = slice(t);
+        std::vector<std::size_t>& write = histograms[t];
+        for (std::size_t i = begin; i < end; ++i) {
+            out[write[partitionOf(keys[i])]++] = JoinTuple{keys[i], static_cast<std::uint32_t>(i)};
+        }
+    });
+}
+
+// Joins one partition pair; buildIsLeft says which output lists the build rows belong to
+inline void joinPartition(const JoinTuple* build, std::size_t buildCount, const JoinTuple* probe,
+                          std::size_t probeCount, bool buildIsLeft, unsigned radixBits, JoinResult& out,
+                          std::vector<std::uint32_t>& heads, std::vector<std::uint32_t>& next,
+                          std::vector<std::uint8_t>& hit) {
+    constexpr std::uint32_t kEnd = 0xFFFFFFFFu;
+    unsigned bucketBits = 1;
+    while ((std::size_t{1} << bucketBits) < buildCount * 2) ++bucketBits;
+    const std::size_t buckets = std::size_t{1} << bucketBits;
+    // the top radixBits of the hash picked the partition, the bucket comes from the bits below
+    auto bucketOf = [&](std::uint64_t key) {
+        return static_cast<std::size_t>((joinHash(key) << radixBits) >> (64 - bucketBits));
+    };
+
+    heads.assign(buckets, kEnd);
+    next.resize(buildCount);
+    hit.assign(buildCount, 0);
+    for (std::size_t i = 0; i < buildCount; ++i) {
+        std::size_t bucket = bucketOf(build[i].key);
+        next[i] = heads[bucket];
+        heads[bucket] = static_cast<std::uint32_t>(i);
+    }
+
+    std::vector<std::uint32_t>& matchedBuild = buildIsLeft ? out.matchedLeft : out.matchedRight;
+    std::vector<std::uint32_t>& matchedProbe = buildIsLeft ? out.matchedRight : out.matchedLeft;
+    std::vector<std::uint32_t>& unmatchedBuild = buildIsLeft ? out.unmatchedLeft : out.unmatchedRight;
+    std::vector<std::uint32_t>& unmatchedProbe = buildIsLeft ? out.unmatchedRight : out.unmatchedLeft;
+
+    for (std::size_t j = 0; j < probeCount; ++j) {
+        const std::uint64_t key = probe[j].key;
+        bool found = false;
+        for (std::uint32_t i = heads[bucketOf(key)]; i != kEnd; i = next[i]) {
+            if (build[i].key != key) continue;
+            matchedBuild.push_back(build[i].row);
+            matchedProbe.push_back(probe[j].row);
+            hit[i] = 1;
+            found = true;
+        }
+        if (!found) unmatchedProbe.push_back(probe[j].row);
+    }
+    for (std::size_t i = 0; i < buildCount; ++i) {
+        if (!hit[i]) unmatchedBuild.push_back(build[i].row);
+    }
+}
+
+inline void appendResult(JoinResult& into, const JoinResult& part) {
+    into.matchedLeft.insert(into.matchedLeft.end(), part.matchedLeft.begin(), part.matchedLeft.end());
+    into.matchedRight.insert(into.matchedRight.end(), part.matchedRight.begin(), part.matchedRight.end());
+    into.unmatchedLeft.insert(into.unmatchedLeft.end(), part.unmatchedLeft.begin(), part.unmatchedLeft.end());
+    into.unmatchedRight.insert(into.unmatchedRight.end(), part.unmatchedRight.begin(), part.unmatchedRight.end());
+}
+
+// Full outer join of two key columns (row counts must fit in 32 bits)
+inline JoinResult hashJoin(const std::vector<std::uint64_t>& left, const std::vector<std::uint64_t>& right,
+                           unsigned threads) {
+    if (threads == 0) threads = 1;
+    const bool buildIsLeft = left.size() <= right.size();
+    const std::vector<std::uint64_t>& buildKeys = buildIsLeft ? left : right;
+    const std::vector<std::uint64_t>& probeKeys = buildIsLeft ? right : left;
+
+    const unsigned bits = joinRadixBits(buildKeys.size());
+    std::vector<JoinTuple> build, probe;
+    std::vector<std::size_t> buildOffsets, probeOffsets;
+    radixPartition(buildKeys.data(), buildKeys.size(), bits, threads, build, buildOffsets);
+    radixPartition(probeKeys.data(), probeKeys.size(), bits, threads, probe, probeOffsets);
+
+    const std::size_t partitions = std::size_t{1} << bits;
+    std::vector<JoinResult> perThread(threads);
+    std::atomic<std::size_t> nextPartition{0};
+    auto worker = [&](unsigned t) {
+        std::vector<std::uint32_t> heads, next;
+        std::vector<std::uint8_t> hit;
+        for (std::size_t p = nextPartition.fetch_add(1); p < partitions; p = nextPartition.fetch_add(1)) {
+            joinPartition(build.data() + buildOffsets[p], buildOffsets[p + 1] - buildOffsets[p],
+                          probe.data() + probeOffsets[p], probeOffsets[p + 1] - probeOffsets[p],
+                          buildIsLeft, bits, perThread[t], heads, next, hit);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker, t);
+    worker(0);
+    for (auto& thread : pool) thread.join();
+
+    if (threads == 1) return std::move(perThread[0]);
+    JoinResult result;
+    for (const JoinResult& part : perThread) appendResult(result, part);
+    return result;
+}
+
+#endif //EMPLOYEE_VALIDATION_C_HASHJOIN_H
@@ -0,0 +1,452 @@
+//
+// Latency and lock-contention instrumentation for the background threads.
+//
+//  - EV_SPAN("refresh cycle") times the rest of the enclosing scope into a per-thread
+//    HDR-style histogram (log2 buckets split into 32 linear sub-buckets, ~3% precision)
+//  - InstrumentedMutex is a drop-in std::mutex that records how long lock() waited
+//  - instrumentationTextReport() / instrumentationJsonReport() merge everything for export
+//
+// Build with -DEV_INSTRUMENTATION=OFF and the spans and per-thread tables vanish, nameThread() does
+// nothing and InstrumentedMutex is a plain mutex.
+//
+
+#ifndef EMPLOYEE_VALIDATION_C_INSTRUMENTATION_H
+#define EMPLOYEE_VALIDATION_C_INSTRUMENTATION_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef EV_INSTRUMENTATION
+#define EV_INSTRUMENTATION 0
+#endif
+
+using SpanId = std::uint32_t;
+
+inline std::uint64_t monotonicNanos() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+inline unsigned highestBit64(std::uint64_t value) {
+#if defined(__GNUC__)
+    return 63u - static_cast<unsigned>(__builtin_clzll(value));
+#else
+    unsigned bit = 0;
+    while (value >>= 1) ++bit;
+    return bit;
+#endif
+}
+
+// Fixed size log-linear histogram of nanosecond values.
+// Only the owning thread writes, so counters use relaxed load+store instead of atomic adds;
+// the reporter can read them at any time without tearing.
+class LatencyHistogram {
+public:
+    static constexpr unsigned kSubBucketBits = 5;
+    static constexpr std::size_t kSubBuckets = std::size_t{1} << kSubBucketBits;
+    static constexpr std::size_t kBucketCount = (64 - kSubBucketBits) * kSubBuckets;
+
+    static std::size_t indexOf(std::uint64_t value) {
+        if (value < 2 * kSubBuckets) return static_cast<std::size_t>(value);
+        unsigned msb = highestBit64(value);
+        if (msb >= 63) return kBucketCount - 1;   // 2^63 ns and up share the last bucket
+        unsigned shift = msb - kSubBucketBits;
+        return (shift + 1) * kSubBuckets + static_cast<std::size_t>((value >> shift) - kSubBuckets);
+    }
+
+    // smallest value that lands in the bucket
+    static std::uint64_t lowerBound(std::size_t index) {
+        if (index < 2 * kSubBuckets) return index;
+        std::size_t shift = index / kSubBuckets - 1;
+        return static_cast<std::uint64_t>(index % kSubBuckets + kSubBuckets) << shift;
+    }
+
+    void record(std::uint64_t value) {
+        bump(counts[indexOf(value)], 1);
+        bump(total, 1);
+        bump(sum, value);
+        if (value > max.load(std::memory_order_relaxed)) max.store(value, std::memory_order_relaxed);
+        if (value < min.load(std::memory_order_relaxed)) min.store(value, std::memory_order_relaxed);
+    }
+
+    // plain copy used when merging for a report
+    struct Snapshot {
+        std::vector<std::uint64_t> counts = std::vector<std::uint64_t>(kBucketCount, 0);
+        std::uint64_t total = 0;
+        std::uint64_t sum = 0;
+        std::uint64_t min = UINT64_MAX;
+        std::uint64_t max = 0;
+
+        std::uint64_t percentile(double p) const {
+            if (total == 0) return 0;
+            std::uint64_t rank = static_cast<std::uint64_t>(p / 100.0 * static_cast<double>(total - 1)) + 1;
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i < counts.size(); ++i) {
+                seen += counts[i];
+                if (seen >= rank) return std::min(std::max(lowerBound(i), min), max);
+            }
+            return max;
+        }
+
+        double mean() const { return total == 0 ? 0.0 : static_cast<double>(sum) / static_cast<double>(total); }
+    };
+
+    void addTo(Snapshot& snapshot) const {
+        for (std::size_t i = 0; i < kBucketCount; ++i) {
+            snapshot.counts[i] += counts[i].load(std::memory_order_relaxed);
+        }
+        snapshot.total += total.load(std::memory_order_relaxed);
+        snapshot.sum += sum.load(std::memory_order_relaxed);
+        snapshot.min = std::min(snapshot.min, min.load(std::memory_order_relaxed));
+        snapshot.max = std::max(snapshot.max, max.load(std::memory_order_relaxed));
+    }
+
+private:
+    static void bump(std::atomic<std::uint64_t>& counter, std::uint64_t by) {
+        counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    std::atomic<std::uint64_t> counts[kBucketCount] = {};
+    std::atomic<std::uint64_t> total{0};
+    std::atomic<std::uint64_t> sum{0};
+    std::atomic<std::uint64_t> min{UINT64_MAX};
+    std::atomic<std::uint64_t> max{0};
+};
+
+// Everything one thread has recorded, indexed by span id
+struct ThreadSpans {
+    std::string threadName;
+    std::mutex growMutex;   // only taken when a new span id shows up on this thread
+    std::vector<std::unique_ptr<LatencyHistogram>> histograms;
+};
+
+struct MutexStats {
+    std::string name;
+    std::atomic<std::uint64_t> acquisitions{0};
+    std::atomic<std::uint64_t> contended{0};
+    std::atomic<std::uint64_t> totalWaitNanos{0};
+    std::atomic<std::uint64_t> maxWaitNanos{0};
+    std::mutex histogramMutex;
+    LatencyHistogram::Snapshot waits;   // only contended acquisitions, guarded by histogramMutex
+};
+
+// Process wide registry of span names, per-thread span tables and mutexes
+class InstrumentationRegistry {
+public:
+    static InstrumentationRegistry& instance() {
+        static InstrumentationRegistry registry;
+        return registry;
+    }
+
+    SpanId registerSpan(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (SpanId id = 0; id < spanNames.size(); ++id) {
+            if (spanNames[id] == name) return id;
+        }
+        spanNames.push_back(name);
+        return static_cast<SpanId>(spanNames.size() - 1);
+    }
+
+    std::shared_ptr<ThreadSpans> registerThread() {
+        auto spans = std::make_shared<ThreadSpans>();
+        std::lock_guard<std::mutex> lock(mutex);
+        spans->threadName = "thread-" + std::to_string(threads.size());
+        threads.push_back(spans);   // kept after the thread exits so its numbers still show up
+        return spans;
+    }
+
+    std::shared_ptr<MutexStats> registerMutex(const std::string& name) {
+        auto stats = std::make_shared<MutexStats>();
+        stats->name = name;
+        std::lock_guard<std::mutex> lock(mutex);
+        mutexes.push_back(stats);
+        return stats;
+    }
+
+    std::vector<std::string> spans() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return spanNames;
+    }
+
+    std::vector<std::shared_ptr<ThreadSpans>> threadList() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return threads;
+    }
+
+    std::vector<std::shared_ptr<MutexStats>> mutexList() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return mutexes;
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<std::string> spanNames;
+    std::vector<std::shared_ptr<ThreadSpans>> threads;
+    std::vector<std::shared_ptr<MutexStats>> mutexes;
+};
+
+inline SpanId registerSpan(const std::string& name) {
+    return InstrumentationRegistry::instance().registerSpan(name);
+}
+
+#if EV_INSTRUMENTATION
+
+inline ThreadSpans& currentThreadSpans() {
+    thread_local std::shared_ptr<ThreadSpans> spans = InstrumentationRegistry::instance().registerThread();
+    return *spans;
+}
+
+// Names the calling thread in reports, e.g. nameThread("refresher")
+inline void nameThread(const std::string& name) {
+    ThreadSpans& spans = currentThreadSpans();
+    std::lock_guard<std::mutex> lock(spans.growMutex);
+    spans.threadName = name;
+}
+
+inline void recordSpan(SpanId id, std::uint64_t nanos) {
+    ThreadSpans& spans = currentThreadSpans();
+    if (id >= spans.histograms.size() || !spans.histograms[id]) {
+        std::lock_guard<std::mutex> lock(spans.growMutex);
+        if (id >= spans.histograms.size()) spans.histograms.resize(id + 1);
+        spans.histograms[id] = std::make_unique<LatencyHistogram>();
+    }
+    spans.histograms[id]->record(nanos);
+}
+
+class ScopedSpan {
+public:
+    explicit ScopedSpan(SpanId id) : id(id), start(monotonicNanos()) {}
+    ScopedSpan(const ScopedSpan&) = delete;
+    ScopedSpan& operator=(const ScopedSpan&) = delete;
+    ~ScopedSpan() { recordSpan(id, monotonicNanos() - start); }
+
+private:
+    SpanId id;
+    std::uint64_t start;
+};
+
+#define EV_CONCAT_INNER(a, b) a##b
+#define EV_CONCAT(a, b) EV_CONCAT_INNER(a, b)
+// the span id is looked up once per call site
+#define EV_SPAN(name)                                                        \
+    static const SpanId EV_CONCAT(evSpanId_, __LINE__) = registerSpan(name); \
+    ScopedSpan EV_CONCAT(evSpan_, __LINE__)(EV_CONCAT(evSpanId_, __LINE__))
+
+// std::mutex that remembers how often and how long lock() had to wait
+class InstrumentedMutex {
+public:
+    explicit InstrumentedMutex(const std::string& name)
+        : stats(InstrumentationRegistry::instance().registerMutex(name)) {}
+
+    void lock() {
+        stats->acquisitions.fetch_add(1, std::memory_order_relaxed);
+        if (mutex.try_lock()) return;   // uncontended: no clock reads at all
+
+        std::uint64_t start = monotonicNanos();
+        mutex.lock();
+        std::uint64_t waited = monotonicNanos() - start;
+        stats->contended.fetch_add(1, std::memory_order_relaxed);
+        stats->totalWaitNanos.fetch_add(waited, std::memory_order_relaxed);
+        std::uint64_t previous = stats->maxWaitNanos.load(std::memory_order_relaxed);
+        while (waited > previous && !stats->maxWaitNanos.compare_exchange_weak(previous, waited)) {
+        }
+        std::lock_guard<std::mutex> lock(stats->histogramMutex);
+        std::size_t index = LatencyHistogram::indexOf(waited);
+        ++stats->waits.counts[index];
+        ++stats->waits.total;
+        stats->waits.sum += waited;
+        stats->waits.min = std::min(stats->waits.min, waited);
+        stats->waits.max = std::max(stats->waits.max, waited);
+    }
+
+    bool try_lock() {
+        bool locked = mutex.try_lock();
+        if (locked) stats->acquisitions.fetch_add(1, std::memory_order_relaxed);
+        return locked;
+    }
+
+    void unlock() { mutex.unlock(); }
+
+private:
+    std::mutex mutex;
+    std::shared_ptr<MutexStats> stats;
+};
+
+#else
+
+#define EV_SPAN(name) ((void)0)
+
+inline void nameThread(const std::string&) {}
+
+// compiled out: same interface, nothing recorded
+class InstrumentedMutex {
+public:
+    explicit InstrumentedMutex(const std::string&) {}
+    void lock() { mutex.lock(); }
+    bool try_lock() { return mutex.try_lock(); }
+    void unlock() { mutex.unlock(); }
+
+private:
+    std::mutex mutex;
+};
+
+#endif
+
+// ---- reports ----
+
+struct SpanReport {
+    std::string name;
+    LatencyHistogram::Snapshot merged;
+    std::vector<std::pair<std::string, std::uint64_t>> perThreadCounts;
+};
+
+inline std::vector<SpanReport> collectSpanReports() {
+    auto& registry = InstrumentationRegistry::instance();
+    std::vector<std::string> names = registry.spans();
+    std::vector<SpanReport> reports(names.size());
+    for (std::size_t i = 0; i < names.size(); ++i) reports[i].name = names[i];
+
+    for (const auto& thread : registry.threadList()) {
+        std::lock_guard<std::mutex> lock(thread->growMutex);
+        for (std::size_t id = 0; id < thread->histograms.size() && id < reports.size(); ++id) {
+            if (!thread->histograms[id]) continue;
+            LatencyHistogram::Snapshot mine;
+            thread->histograms[id]->addTo(mine);
+            if (mine.total == 0) continue;
+            reports[id].perThreadCounts.emplace_back(thread->threadName, mine.total);
+            reports[id].merged.total += mine.total;
+            reports[id].merged.sum += mine.sum;
+            reports[id].merged.min = std::min(reports[id].merged.min, mine.min);
+            reports[id].merged.max = std::max(reports[id].merged.max, mine.max);
+            for (std::size_t b = 0; b < mine.counts.size(); ++b) reports[id].merged.counts[b] += mine.counts[b];
+        }
+    }
+    return reports;
+}
+
+inline std::string instrumentationTextReport() {
+    std::ostringstream out;
+#if EV_INSTRUMENTATION
+    out << "---- latency (microseconds) ----\n";
+    for (const SpanReport& span : collectSpanReports()) {
+        const auto& h = span.merged;
+        out << "  " << span.name << ": count " << h.total;
+        if (h.total != 0) {
+            out << " | p50 " << static_cast<double>(h.percentile(50)) / 1000.0
+                << " | p99 " << static_cast<double>(h.percentile(99)) / 1000.0
+                << " | p99.9 " << static_cast<double>(h.percentile(99.9)) / 1000.0
+                << " | max " << static_cast<double>(h.max) / 1000.0
+                << " | mean " << h.mean() / 1000.0;
+        }
+        out << "\n";
+        for (const auto& thread : span.perThreadCounts) {
+            out << "      " << thread.first << ": " << thread.second << "\n";
+        }
+    }
+    out << "---- lock contention ----\n";
+    for (const auto& stats : InstrumentationRegistry::instance().mutexList()) {
+        std::lock_guard<std::mutex> lock(stats->histogramMutex);
+        out << "  " << stats->name << ": acquisitions " << stats->acquisitions.load()
+            << " | contended " << stats->contended.load()
+            << " | total wait " << static_cast<double>(stats->totalWaitNanos.load()) / 1000.0 << " us"
+            << " | p99 wait " << static_cast<double>(stats->waits.percentile(99)) / 1000.0 << " us"
+            << " | max wait " << static_cast<double>(stats->maxWaitNanos.load()) / 1000.0 << " us\n";
+    }
+#else
+    out << "instrumentation compiled out (configure with -DEV_INSTRUMENTATION=ON)\n";
+#endif
+    return out.str();
+}
+
+inline std::string jsonEscape(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+inline std::string instrumentationJsonReport() {
+    std::ostringstream out;
+#if EV_INSTRUMENTATION
+    out << "{\"spans\":[";
+    bool first = true;
+    for (const SpanReport& span : collectSpanReports()) {
+        const auto& h = span.merged;
+        out << (first ? "" : ",") << "{\"name\":\"" << jsonEscape(span.name) << "\",\"count\":" << h.total
+            << ",\"p50_ns\":" << h.percentile(50) << ",\"p90_ns\":" << h.percentile(90)
+            << ",\"p99_ns\":" << h.percentile(99) << ",\"p999_ns\":" << h.percentile(99.9)
+            << ",\"max_ns\":" << h.max << ",\"mean_ns\":" << h.mean() << ",\"threads\":{";
+        bool firstThread = true;
+        for (const auto& thread : span.perThreadCounts) {
+            out << (firstThread ? "" : ",") << "\"" << jsonEscape(thread.first) << "\":" << thread.second;
+            firstThread = false;
+        }
+        out << "}}";
+        first = false;
+    }
+    out << "],\"mutexes\":[";
+    first = true;
+    for (const auto& stats : InstrumentationRegistry::instance().mutexList()) {
+        std::lock_guard<std::mutex> lock(stats->histogramMutex);
+        out << (first ? "" : ",") << "{\"name\":\"" << jsonEscape(stats->name)
+            << "\",\"acquisitions\":" << stats->acquisitions.load()
+            << ",\"contended\":" << stats->contended.load()
+            << ",\"total_wait_ns\":" << stats->totalWaitNanos.load()
+            << ",\"p99_wait_ns\":" << stats->waits.percentile(99)
+            << ",\"max_wait_ns\":" << stats->maxWaitNanos.load() << "}";
+        first = false;
+    }
+    out << "]}";
+#else
+    out << "{\"enabled\":false}";
+#endif
+    return out.str();
+}
+
+// Calls sink with a fresh report every interval until destroyed
+class PeriodicReporter {
+public:
+    PeriodicReporter(std::chrono::milliseconds interval, std::function<void()> sink)
+        : worker([this, interval, sink = std::move(sink)] {
+              std::unique_lock<std::mutex> lock(mutex);
+              while (!stopping) {
+                  if (wake.wait_for(lock, interval, [this] { return stopping; })) break;
+                  lock.unlock();
+                  sink();
+                  lock.lock();
+              }
+          }) {}
+
+    PeriodicReporter(const PeriodicReporter&) = delete;
+    PeriodicReporter& operator=(const PeriodicReporter&) = delete;
+
+    ~PeriodicReporter() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        worker.join();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread worker;
+};
+
+#endif //EMPLOYEE_VALIDATION_C_INSTRUMENTATION_H
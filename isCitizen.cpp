@@ -5,6 +5,16 @@
 #include <string>
 #include <cctype>
 #include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <algorithm>
+
+#include "eligibility.h"
+#include "ageHistogram.h"
+#include "eligibilityRules.h"
 
 //helper for digits
 bool isAllDigits(const std::string& s) {
@@ -28,11 +38,9 @@ bool isAllLetters(const std::string& s) {
     return true;
 }
 
-// Helper: convert to lowercase
-std::string toLower(std::string s) {
-    for (char& c : s) {
-        c = std::tolower(c);
-    }
+// Helper: convert to lowercase - folds in place (16/32 bytes per step), no copy
+std::string& toLower(std::string& s) {
+    toLowerAsciiInPlace(s);
     return s;
 }
 
@@ -51,18 +59,18 @@ int getValidAge() {
 
         int age = std::stoi(inputAge);
 
-        if (age <= 0) {
+        // same rules the batch screener uses (eligibility.h)
+        AgeStatus status = classifyAge(age);
+        if (status == AgeStatus::Invalid) {
             std::cout << "age musty be positive.\n";
             continue;
         }
-        if (age<18) {
+        if (status == AgeStatus::Minor) {
             std::cout << "age less than 18 - Cant Vote \n";
             continue;
         }
-        if (age >= 18) {
-            std::cout << "age is correct to vote\n";
-            return age;   // exit the loop and function
-        }
+        std::cout << "age is correct to vote\n";
+        return age;   // exit the loop and function
 
     }
 }
@@ -78,14 +86,332 @@ std::string isCitizenValidation() {
             std::cout << "Invalid Input. Please try again." << "\n";
             continue;
         }
-        inputCitizen = toLower(inputCitizen);
-        return inputCitizen;
+        toLower(inputCitizen);
+        return inputCitizen;   // moved out, not copied
+    }
+}
+
+// --generate <file> <rows> - writes a synthetic population extract for trying the batch mode
+bool generatePopulation(const std::string& path, std::uint64_t rows) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    static const char* answers[] = {"yes", "no", "Yes", "NO", "YES", "yes", "yes", "y"};
+    std::string buffer;
+    buffer.reserve(1 << 20);
+    out << "id,age,citizen\n";
+    std::uint64_t state = 88172645463325252ull;
+    for (std::uint64_t id = 1; id <= rows; ++id) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        buffer += std::to_string(id);
+        buffer += ',';
+        buffer += std::to_string(state % 100);
+        buffer += ',';
+        buffer += answers[(state >> 8) % 8];
+        buffer += '\n';
+        if (buffer.size() > (1 << 20) - 64) {
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    }
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    return static_cast<bool>(out);
+}
+
+// --batch <population file> <eligible ids file> [threads]
+int runBatch(const std::string& inputPath, const std::string& outputPath, unsigned threads) {
+    EligibilityCounts counts;
+    auto start = std::chrono::steady_clock::now();
+    if (!runEligibilityBatch(inputPath, outputPath, threads, counts)) {
+        std::cout << "Could not read " << inputPath << " or write " << outputPath << "\n";
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Rows: " << counts.rows << " (" << threads << " threads, " << seconds << " s, "
+              << static_cast<double>(counts.rows) / seconds / 1e6 << " M rows/s)\n";
+    std::cout << "  eligible     : " << counts.eligible << "\n";
+    std::cout << "  under 18     : " << counts.minors << "\n";
+    std::cout << "  not citizen  : " << counts.nonCitizens << "\n";
+    std::cout << "  invalid age  : " << counts.invalidAge << "\n";
+    std::cout << "  malformed    : " << counts.malformed << "\n";
+    std::cout << "Eligible IDs written to " << outputPath << "\n";
+    return 0;
+}
+
+// --index <population file> [registered ids file] - builds the predicate bitmaps once,
+// then answers eligibility counts with set algebra instead of rescanning the file
+int runIndex(const std::string& inputPath, const std::string& registeredPath, unsigned threads) {
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::time_point a, Clock::time_point b) {
+        return std::chrono::duration<double, std::milli>(b - a).count();
+    };
+
+    auto t0 = Clock::now();
+    EligibilityIndexes indexes;
+    if (!buildEligibilityIndexes(inputPath, threads, indexes)) {
+        std::cout << "Could not read " << inputPath << "\n";
+        return 1;
+    }
+    IdBitmap registered;
+    if (!registeredPath.empty() && !loadIdBitmap(registeredPath, registered)) {
+        std::cout << "Could not read " << registeredPath << "\n";
+        return 1;
+    }
+    auto t1 = Clock::now();
+
+    // eligible = citizens AND adults AND NOT registered
+    std::uint64_t citizenAdults = andCount(indexes.citizens, indexes.adults);
+    IdBitmap eligible = andNot(indexes.citizens & indexes.adults, registered);
+    auto t2 = Clock::now();
+    std::uint64_t notCitizenAdults = andNotCount(indexes.adults, indexes.citizens);
+    std::uint64_t minors = andNotCount(indexes.validAge, indexes.adults);
+    auto t3 = Clock::now();
+
+    // what it costs without the index: a full rescan of the file
+    EligibilityCounts rescan;
+    MappedFile input;
+    input.open(inputPath);
+    std::string discard;
+    screenChunk(skipHeader(input.view()), rescan, discard);
+    auto t4 = Clock::now();
+
+    std::size_t bytes = indexes.people.memoryBytes() + indexes.validAge.memoryBytes() +
+                        indexes.adults.memoryBytes() + indexes.citizens.memoryBytes();
+    std::cout << "People indexed: " << indexes.people.cardinality() << " | index size " << bytes / (1024 * 1024)
+              << " MB | build " << ms(t0, t1) << " ms\n";
+    if (indexes.skippedIds != 0) std::cout << "  ids above 32 bits skipped: " << indexes.skippedIds << "\n";
+    std::cout << "  citizens 18+                    : " << citizenAdults << "\n";
+    std::cout << "  eligible (minus registered "  << registered.cardinality() << ")  : " << eligible.cardinality() << "\n";
+    std::cout << "  18+ but not citizens            : " << notCitizenAdults << "\n";
+    std::cout << "  under 18                        : " << minors << "\n";
+    std::cout << "  AND + ANDNOT with result        : " << ms(t1, t2) << " ms\n";
+    std::cout << "  two count-only queries          : " << ms(t2, t3) << " ms\n";
+    std::cout << "  full rescan for comparison      : " << ms(t3, t4) << " ms (eligible " << rescan.eligible << ")\n";
+    return 0;
+}
+
+// --ages <population file> [bounds like 1,18,65] - age distribution, SIMD kernel vs scalar loop
+int runAgeHistogram(const std::string& inputPath, const AgeBuckets& buckets, unsigned threads) {
+    AgeHistogram fast, scalar;
+    auto t0 = std::chrono::steady_clock::now();
+    if (!buildAgeHistogram(inputPath, buckets, threads, fast)) {
+        std::cout << "Could not read " << inputPath << "\n";
+        return 1;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    buildAgeHistogram(inputPath, buckets, threads, scalar, classifyAgesScalar);
+    auto t2 = std::chrono::steady_clock::now();
+
+    std::uint64_t total = 0;
+    for (std::uint64_t count : fast.counts) total += count;
+    std::cout << "Ages classified: " << total << " | malformed rows: " << fast.malformed << "\n";
+    for (std::size_t b = 0; b < buckets.bucketCount(); ++b) {
+        std::cout << "  " << buckets.label(b) << ": " << fast.counts[b] << "\n";
+    }
+    std::cout << "Parse + classify: dispatched " << std::chrono::duration<double, std::milli>(t1 - t0).count()
+              << " ms | scalar " << std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms"
+              << (fast.counts == scalar.counts ? "" : " | MISMATCH") << "\n";
+    return 0;
+}
+
+// --age-bench [ages] - classify kernel alone over an in-memory column
+int runAgeBenchmark(std::size_t count, const AgeBuckets& buckets) {
+    std::vector<std::int32_t> ages(count);
+    std::uint32_t state = 2463534242u;
+    for (auto& age : ages) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        age = static_cast<std::int32_t>(state % 110);
+    }
+
+    auto time = [&](AgeClassifier classify, AgeHistogram& histogram) {
+        auto start = std::chrono::steady_clock::now();
+        classify(ages.data(), ages.size(), buckets, histogram);
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+    AgeHistogram scalar(buckets.bucketCount()), fast(buckets.bucketCount());
+    double scalarMs = time(classifyAgesScalar, scalar);
+    double fastMs = time(classifyAges, fast);
+    std::cout << "Ages: " << count << " | buckets: " << buckets.bucketCount()
+              << " | AVX2: " << (cpuHasAvx2() ? "yes" : "no") << "\n";
+    std::cout << "  scalar loop : " << scalarMs << " ms\n";
+    std::cout << "  dispatched  : " << fastMs << " ms | speedup " << scalarMs / fastMs << "x"
+              << (fast.counts == scalar.counts ? "" : " | MISMATCH") << "\n";
+    return 0;
+}
+
+// --fold-bench [bytes] - case folding and keyword matching, old style vs new
+int runFoldBenchmark(std::size_t bytes) {
+    using Clock = std::chrono::steady_clock;
+    std::string text(bytes, ' ');
+    for (std::size_t i = 0; i < bytes; ++i) text[i] = static_cast<char>("Hello World, Citizen YES no\n"[i % 28]);
+
+    std::string expected = text;
+    auto t0 = Clock::now();
+    for (char& c : expected) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    auto t1 = Clock::now();
+    std::string copy = text;
+    auto t2 = Clock::now();
+    toLowerAsciiInPlace(copy);
+    auto t3 = Clock::now();
+    const bool foldSame = copy == expected;
+
+    // per row token check the way isCitizenValidation used to do it: lowered copy, then compare -
+    // against the same keywords matchKeyword knows, so both sides count the same hits
+    static const char* tokens[] = {"yes", "No", "YES", "n", "maybe", "True", "false", "Y"};
+    const std::size_t rows = 20000000;
+    std::size_t oldHits = 0, newHits = 0;
+    auto t4 = Clock::now();
+    for (std::size_t i = 0; i < rows; ++i) {
+        std::string lowered(tokens[i & 7]);
+        for (char& c : lowered) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        oldHits += lowered == "yes" || lowered == "no" || lowered == "y" || lowered == "n" ||
+                   lowered == "true" || lowered == "false";
+    }
+    auto t5 = Clock::now();
+    for (std::size_t i = 0; i < rows; ++i) {
+        Keyword k = matchKeyword(tokens[i & 7]);
+        newHits += k != Keyword::None;
+    }
+    auto t6 = Clock::now();
+
+    auto ms = [](Clock::time_point a, Clock::time_point b) { return std::chrono::duration<double, std::milli>(b - a).count(); };
+    std::cout << "Fold " << bytes << " bytes: std::tolower loop " << ms(t0, t1) << " ms | toLowerAsciiInPlace "
+              << ms(t2, t3) << " ms" << (foldSame ? "" : " | MISMATCH") << "\n";
+    std::cout << "Match " << rows << " tokens: copy+tolower+compare " << ms(t4, t5) << " ms | matchKeyword "
+              << ms(t5, t6) << " ms (" << newHits << " hits)" << (oldHits == newHits ? "" : " | MISMATCH") << "\n";
+    return 0;
+}
+
+// --rules <rules file> <population file> <eligible ids file> [threads] - batch screening driven
+// by a rules file instead of the built in checks, so a new jurisdiction needs no rebuild
+int runRules(const std::string& rulesPath, const std::string& inputPath, const std::string& outputPath,
+             unsigned threads) {
+    CompiledRules rules;
+    std::string error;
+    if (!loadRules(rulesPath, rules, error)) {
+        std::cout << "Bad rules file " << rulesPath << ": " << error << "\n";
+        return 1;
+    }
+    RuleRunCounts counts;
+    auto start = std::chrono::steady_clock::now();
+    if (!runRulesBatch(inputPath, outputPath, rules, threads, counts)) {
+        std::cout << "Could not read " << inputPath << " or write " << outputPath << "\n";
+        return 1;
     }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::uint64_t rows = counts.malformed;
+    for (std::uint64_t count : counts.outcomes) rows += count;
+    std::cout << "Rows: " << rows << " (" << rules.ruleCount() << " rules, " << threads << " threads, "
+              << seconds << " s)\n";
+    for (std::size_t i = 0; i < rules.outcomeNames.size(); ++i) {
+        std::cout << "  " << (rules.outcomeAccepts[i] ? "accept " : "reject ") << rules.outcomeNames[i] << ": "
+                  << counts.outcomes[i] << "\n";
+    }
+    std::cout << "  malformed: " << counts.malformed << "\n";
+    std::cout << "Accepted IDs written to " << outputPath << "\n";
+    return 0;
 }
 
-int main() {
+// --rules-bench [rows] [rules file] - compiled table vs the hand written classifyAge checks
+int runRulesBenchmark(std::size_t count, const std::string& rulesPath) {
+    CompiledRules rules;
+    std::string error;
+    bool loaded = rulesPath.empty() ? compileRules(kDefaultEligibilityRules, rules, error)
+                                    : loadRules(rulesPath, rules, error);
+    if (!loaded) {
+        std::cout << "Bad rules: " << error << "\n";
+        return 1;
+    }
 
+    std::vector<std::int32_t> ages(count), citizens(count);
+    std::uint32_t state = 2463534242u;
+    for (std::size_t i = 0; i < count; ++i) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        ages[i] = static_cast<std::int32_t>(state % 100);
+        citizens[i] = (state >> 8) % 4 != 0;
+    }
+    std::vector<std::uint8_t> compiled(count), handWritten(count);
 
+    auto t0 = std::chrono::steady_clock::now();
+    const std::int32_t* columns[] = {ages.data(), citizens.data()};
+    evaluateRules(rules, columns, count, compiled.data());
+    auto t1 = std::chrono::steady_clock::now();
+    // outcome ids of the default rules: invalid_age, minor, non_citizen, eligible
+    for (std::size_t i = 0; i < count; ++i) {
+        AgeStatus status = classifyAge(ages[i]);
+        if (status == AgeStatus::Invalid) handWritten[i] = 0;
+        else if (status == AgeStatus::Minor) handWritten[i] = 1;
+        else if (!citizens[i]) handWritten[i] = 2;
+        else handWritten[i] = 3;
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    double compiledMs = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    double handMs = std::chrono::duration<double, std::milli>(t2 - t1).count();
+    std::cout << "Rows: " << count << " | rules: " << rules.ruleCount() << "\n";
+    std::cout << "  compiled table : " << compiledMs << " ms\n";
+    std::cout << "  hand written   : " << handMs << " ms | table / hand " << compiledMs / handMs << "x";
+    if (rulesPath.empty()) std::cout << (compiled == handWritten ? "" : " | MISMATCH");
+    std::cout << "\n";
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 3 && std::strcmp(argv[1], "--generate") == 0) {
+        if (!generatePopulation(argv[2], std::strtoull(argv[3], nullptr, 10))) {
+            std::cout << "Could not write " << argv[2] << "\n";
+            return 1;
+        }
+        return 0;
+    }
+    if (argc > 3 && std::strcmp(argv[1], "--batch") == 0) {
+        unsigned threads = argc > 4 ? std::max(1u, static_cast<unsigned>(std::strtoul(argv[4], nullptr, 10)))
+                                    : std::max(1u, std::thread::hardware_concurrency());
+        return runBatch(argv[2], argv[3], threads);
+    }
+
+    if (argc > 2 && std::strcmp(argv[1], "--index") == 0) {
+        return runIndex(argv[2], argc > 3 ? argv[3] : "", std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    if (argc > 2 && std::strcmp(argv[1], "--ages") == 0) {
+        AgeBuckets buckets = argc > 3 ? AgeBuckets::parse(argv[3]) : AgeBuckets();
+        return runAgeHistogram(argv[2], buckets, std::max(1u, std::thread::hardware_concurrency()));
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--age-bench") == 0) {
+        std::size_t count = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 50000000;
+        return runAgeBenchmark(count, argc > 3 ? AgeBuckets::parse(argv[3]) : AgeBuckets());
+    }
+
+    if (argc > 1 && std::strcmp(argv[1], "--fold-bench") == 0) {
+        return runFoldBenchmark(argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 256u << 20);
+    }
+
+    if (argc > 4 && std::strcmp(argv[1], "--rules") == 0) {
+        unsigned threads = argc > 5 ? std::max(1u, static_cast<unsigned>(std::strtoul(argv[5], nullptr, 10)))
+                                    : std::max(1u, std::thread::hardware_concurrency());
+        return runRules(argv[2], argv[3], argv[4], threads);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--rules-bench") == 0) {
+        return runRulesBenchmark(argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 50000000, argc > 3 ? argv[3] : "");
+    }
+
+    // interactive single check
+    getValidAge();
+    std::string citizen = isCitizenValidation();
+    if (parseCitizenAnswer(citizen) == CitizenAnswer::Yes) {
+        std::cout << "You are eligible to vote.\n";
+    }
+    else {
+        std::cout << "Only citizens can vote.\n";
+    }
 
     return 0;
 }
\ No newline at end of file
@@ -1,12 +1,24 @@
 #include <iostream>
 #include <ctime>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "arithmeticKernels.h"
+#include "batchArithmetic.h"
+#include "expressionEngine.h"
+#include "timestampService.h"
 
 void functionAfterMain(int a, int b);
 
 void addFunction(int a, int b){
-        std::cout << "the output is: "<< a+b << "\n";
-        std::time_t now = std::time(nullptr);
-        std::cout << "Time now is: " << std::ctime(&now);
+        std::cout << "the output is: "<< compute<AddOp>(a, b) << "\n";
+        std::cout << "Time now is: " << currentTimestamp() << "\n";
 }
 
 void testFunction(int a, int b) {
@@ -14,24 +26,275 @@ void testFunction(int a, int b) {
 }
 
 void subtractFunction(int a, int b){
-        std::cout << "the subtraction is: " << a-b << "\n";
-        std::time_t now = std::time(nullptr);
-        std::cout << "Time now is: " << std::ctime(&now);
+        std::cout << "the subtraction is: " << compute<SubOp>(a, b) << "\n";
+        std::cout << "Time now is: " << currentTimestamp() << "\n";
 }
 
 void multiplyFunction(int a, int b){
-        std::cout << "the Multiplication is: " << a*b << "\n";
-        std::time_t now = std::time(nullptr);
-        std::cout << "Time now is: " << std::ctime(&now);
+        std::cout << "the Multiplication is: " << compute<MulOp>(a, b) << "\n";
+        std::cout << "Time now is: " << currentTimestamp() << "\n";
 }
 
 void divisionFunction(double a, int b){
-        std::cout << "the division is: " << a/b << "\n";
-        std::time_t now = std::time(nullptr);
-        std::cout << "Time now is: " << std::ctime(&now);
+        std::cout << "the division is: " << compute<DivOp>(a, b) << "\n";
+        std::cout << "Time now is: " << currentTimestamp() << "\n";
+}
+
+// --bench - std::time + std::ctime per call against the cached timestamp
+int runTimestampBenchmark() {
+        const int calls = 10000000;
+        std::size_t sink = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < calls; ++i) {
+                std::time_t now = std::time(nullptr);
+                sink += static_cast<std::size_t>(std::ctime(&now)[18]);
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        for (int i = 0; i < calls; ++i) sink += static_cast<std::size_t>(currentTimestamp().text[18]);
+        auto t2 = std::chrono::steady_clock::now();
+        TimestampService::instance().startTicker();
+        auto t3 = std::chrono::steady_clock::now();
+        for (int i = 0; i < calls; ++i) sink += static_cast<std::size_t>(currentTimestamp().text[18]);
+        auto t4 = std::chrono::steady_clock::now();
+        TimestampService::instance().stopTicker();
+
+        auto ns = [&](std::chrono::steady_clock::time_point a, std::chrono::steady_clock::time_point b) {
+                return std::chrono::duration<double, std::nano>(b - a).count() / calls;
+        };
+        std::cout << "std::time + std::ctime : " << ns(t0, t1) << " ns/call\n";
+        std::cout << "cached, lazy refresh   : " << ns(t1, t2) << " ns/call\n";
+        std::cout << "cached, ticker thread  : " << ns(t3, t4) << " ns/call\n";
+        std::cout << "(checksum " << sink << ")\n";
+        return 0;
+}
+
+// one pair per call, the way the functions above work (minus the printing); int32 results wrap
+// and overflow or division by zero is flagged exactly as the batch kernels do it
+int addOne(int a, int b) { return static_cast<int>(static_cast<unsigned>(a) + static_cast<unsigned>(b)); }
+int subtractOne(int a, int b) { return static_cast<int>(static_cast<unsigned>(a) - static_cast<unsigned>(b)); }
+int multiplyOne(int a, int b) { return static_cast<int>(static_cast<unsigned>(a) * static_cast<unsigned>(b)); }
+double divideOne(double a, int b) { return b == 0 ? 0.0 : a / b; }
+bool addCheckedOne(int a, int b, int& out) {
+        long long wide = static_cast<long long>(a) + b;
+        out = static_cast<int>(wide);
+        return wide != out;
+}
+bool multiplyCheckedOne(int a, int b, int& out) {
+        long long wide = static_cast<long long>(a) * b;
+        out = static_cast<int>(wide);
+        return wide != out;
+}
+
+// --batch-bench [n] - every span batch kernel against calling its per-pair function n times
+int runBatchBenchmark(std::size_t n) {
+        std::vector<std::int32_t> a(n), small(n), b(n), out(n), check(n);
+        std::vector<double> numerators(n), quotients(n), checkQuotients(n);
+        std::vector<std::uint8_t> mask(n), checkMask(n);
+        std::uint32_t state = 2463534242u;
+        for (std::size_t i = 0; i < n; ++i) {
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                a[i] = static_cast<std::int32_t>(state);
+                small[i] = a[i] >> 9;                                      // most products fit, some overflow
+                b[i] = static_cast<std::int32_t>(state % 2001) - 1000;   // some zeros
+                numerators[i] = static_cast<double>(a[i]) * 0.5;
+        }
+
+        using Clock = std::chrono::steady_clock;
+        auto ms = [](Clock::time_point x, Clock::time_point y) {
+                return std::chrono::duration<double, std::milli>(y - x).count();
+        };
+        // through volatile pointers so the per-call loops really make one call per pair
+        int (*volatile addCall)(int, int) = addOne;
+        int (*volatile subtractCall)(int, int) = subtractOne;
+        int (*volatile multiplyCall)(int, int) = multiplyOne;
+        double (*volatile divideCall)(double, int) = divideOne;
+        bool (*volatile addCheckedCall)(int, int, int&) = addCheckedOne;
+        bool (*volatile multiplyCheckedCall)(int, int, int&) = multiplyCheckedOne;
+
+        std::cout << "Pairs: " << n << " | AVX2: " << (cpuHasAvx2() ? "yes" : "no") << "\n";
+        auto report = [&](const char* name, double perCall, double batch, bool same, const std::string& note) {
+                std::cout << "  " << name << ": per call " << perCall << " ms | batch " << batch << " ms"
+                          << note << (same ? "" : " | MISMATCH") << "\n";
+        };
+
+        // plain kernels: per call and batch both write a full int32 column
+        auto wrapping = [&](const char* name, int (*volatile& call)(int, int), const std::vector<std::int32_t>& x,
+                            auto batchKernel) {
+                auto t0 = Clock::now();
+                for (std::size_t i = 0; i < n; ++i) check[i] = call(x[i], b[i]);
+                auto t1 = Clock::now();
+                batchKernel(x, b, out);
+                auto t2 = Clock::now();
+                report(name, ms(t0, t1), ms(t1, t2), out == check, "");
+        };
+        wrapping("add             ", addCall, a, [](auto& x, auto& y, auto& z) { addBatch(x, y, z); });
+        wrapping("subtract        ", subtractCall, a, [](auto& x, auto& y, auto& z) { subtractBatch(x, y, z); });
+        wrapping("multiply        ", multiplyCall, small, [](auto& x, auto& y, auto& z) { multiplyBatch(x, y, z); });
+
+        // checked kernels: both sides also write the overflow mask
+        auto checked = [&](const char* name, bool (*volatile& call)(int, int, int&), const std::vector<std::int32_t>& x,
+                           auto batchKernel) {
+                auto t0 = Clock::now();
+                for (std::size_t i = 0; i < n; ++i) checkMask[i] = call(x[i], b[i], check[i]);
+                auto t1 = Clock::now();
+                std::size_t flagged = batchKernel(x, b, out, mask);
+                auto t2 = Clock::now();
+                report(name, ms(t0, t1), ms(t1, t2), out == check && mask == checkMask,
+                       " (" + std::to_string(flagged) + " overflows)");
+        };
+        checked("add checked     ", addCheckedCall, a,
+                [](auto& x, auto& y, auto& z, auto& m) { return addChecked(x, y, z, m); });
+        checked("multiply checked", multiplyCheckedCall, small,
+                [](auto& x, auto& y, auto& z, auto& m) { return multiplyChecked(x, y, z, m); });
+
+        auto t0 = Clock::now();
+        for (std::size_t i = 0; i < n; ++i) {
+                checkQuotients[i] = divideCall(numerators[i], b[i]);
+                checkMask[i] = b[i] == 0;
+        }
+        auto t1 = Clock::now();
+        std::size_t zeros = divideBatch(numerators, b, quotients, mask);
+        auto t2 = Clock::now();
+        report("divide          ", ms(t0, t1), ms(t1, t2), quotients == checkQuotients && mask == checkMask,
+               " (" + std::to_string(zeros) + " divisions by zero)");
+        return 0;
 }
 
-int main(){
+// reference for --expr: walks the parsed tree once per row
+double evaluateTree(const ExpressionParser& parsed, std::int32_t node, const double* row) {
+        const ExprNode& n = parsed.nodes[node];
+        if (n.op == ExprOp::Const) return n.value;
+        if (n.op == ExprOp::Var) return row[n.var];
+        double a = evaluateTree(parsed, n.left, row);
+        return applyExprOp(n.op, a, n.right >= 0 ? evaluateTree(parsed, n.right, row) : 0.0);
+}
+
+// --expr "<expression>" [rows] - prints the value of a constant expression, otherwise evaluates it
+// over random columns for each variable and compares bytecode batches with a per-row tree walk
+int runExpression(const std::string& text, std::size_t rows) {
+        ExpressionCache cache;
+        std::string error;
+        std::shared_ptr<const CompiledExpression> expression = cache.get(text, error);
+        if (!expression) {
+                std::cout << "Bad expression: " << error << "\n";
+                return 1;
+        }
+        if (expression->variables.empty()) {
+                double value = 0.0;
+                evaluateExpression(*expression, {}, 1, &value);
+                std::cout << text << " = " << value << "\n";
+                return 0;
+        }
+
+        const std::size_t vars = expression->variables.size();
+        std::vector<std::vector<double>> columns(vars, std::vector<double>(rows));
+        std::vector<const double*> columnPointers;
+        std::vector<double> rowMajor(rows * vars);
+        std::uint32_t state = 2463534242u;
+        for (std::size_t v = 0; v < vars; ++v) {
+                for (std::size_t r = 0; r < rows; ++r) {
+                        state ^= state << 13;
+                        state ^= state >> 17;
+                        state ^= state << 5;
+                        columns[v][r] = static_cast<double>(state % 1000) + 1.0;
+                        rowMajor[r * vars + v] = columns[v][r];
+                }
+                columnPointers.push_back(columns[v].data());
+        }
+
+        ExpressionParser parsed(text);
+        parsed.parse(error);
+        std::vector<double> batch(rows), walked(rows);
+        using Clock = std::chrono::steady_clock;
+        auto t0 = Clock::now();
+        for (std::size_t r = 0; r < rows; ++r) walked[r] = evaluateTree(parsed, parsed.root, &rowMajor[r * vars]);
+        auto t1 = Clock::now();
+        std::shared_ptr<const CompiledExpression> cached = cache.get(text, error);   // second lookup is a hit
+        evaluateExpression(*cached, columnPointers, rows, batch.data());
+        auto t2 = Clock::now();
+
+        auto nsPerRow = [&](Clock::time_point a, Clock::time_point b) {
+                return std::chrono::duration<double, std::nano>(b - a).count() / static_cast<double>(rows);
+        };
+        std::cout << "Expression: " << text << " | " << vars << " variables | " << expression->code.size()
+                  << " instructions, " << expression->registers << " registers, "
+                  << expression->constants.size() << " constants\n";
+        std::cout << "  tree walk per row : " << nsPerRow(t0, t1) << " ns/row\n";
+        std::cout << "  bytecode batches  : " << nsPerRow(t1, t2) << " ns/row (cache hits " << cache.hits() << ")"
+                  << (batch == walked ? "" : " | MISMATCH") << "\n";
+        return 0;
+}
+
+// times fn in milliseconds, best of a few runs
+template <typename Fn>
+double bestOfMs(Fn&& fn) {
+        double best = 1e30;
+        for (int run = 0; run < 5; ++run) {
+                auto start = std::chrono::steady_clock::now();
+                fn();
+                best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        return best;
+}
+
+// --kernel-bench [n] - computeBatch<Op, A, B> against the loop you would write by hand
+int runKernelBenchmark(std::size_t n) {
+        std::vector<float> fa(n), fb(n), fout(n), fcheck(n);
+        std::vector<std::int64_t> la(n), lb(n), lout(n), lcheck(n);
+        std::vector<double> da(n), dout(n), dcheck(n);
+        std::vector<std::int32_t> ib(n);
+        std::vector<Fixed> xa(n), xb(n), xout(n), xcheck(n);
+        for (std::size_t i = 0; i < n; ++i) {
+                fa[i] = static_cast<float>(i % 1000) * 0.5f;
+                fb[i] = static_cast<float>(i % 7) + 1.0f;
+                la[i] = static_cast<std::int64_t>(i) * 3;
+                lb[i] = static_cast<std::int64_t>(i % 11) - 5;
+                da[i] = static_cast<double>(i) * 0.25;
+                ib[i] = static_cast<std::int32_t>(i % 13) + 1;
+                xa[i] = Fixed::fromDouble(static_cast<double>(i % 100) * 0.5);
+                xb[i] = Fixed::fromDouble(static_cast<double>(i % 9) * 0.25);
+        }
+
+        auto row = [](const char* name, double handMs, double genericMs, bool same) {
+                std::cout << "  " << name << ": hand written " << handMs << " ms | computeBatch " << genericMs << " ms"
+                          << (same ? "" : " | MISMATCH") << "\n";
+        };
+        std::cout << "Elements: " << n << "\n";
+        double hand = bestOfMs([&] { for (std::size_t i = 0; i < n; ++i) fcheck[i] = fa[i] + fb[i]; });
+        double generic = bestOfMs([&] { computeBatch<AddOp, float, float>(fa, fb, fout); });
+        row("float + float    ", hand, generic, fout == fcheck);
+        hand = bestOfMs([&] { for (std::size_t i = 0; i < n; ++i) lcheck[i] = la[i] * lb[i]; });
+        generic = bestOfMs([&] { computeBatch<MulOp, std::int64_t, std::int64_t>(la, lb, lout); });
+        row("int64 * int64    ", hand, generic, lout == lcheck);
+        hand = bestOfMs([&] { for (std::size_t i = 0; i < n; ++i) dcheck[i] = da[i] / ib[i]; });
+        generic = bestOfMs([&] { computeBatch<DivOp, double, std::int32_t>(da, ib, dout); });
+        row("double / int32   ", hand, generic, dout == dcheck);
+        hand = bestOfMs([&] {
+                for (std::size_t i = 0; i < n; ++i) {
+                        xcheck[i].raw = static_cast<std::int32_t>((std::int64_t{xa[i].raw} * xb[i].raw) >> 16);
+                }
+        });
+        generic = bestOfMs([&] { computeBatch<MulOp, Fixed, Fixed>(xa, xb, xout); });
+        row("Fixed * Fixed    ", hand, generic, xout == xcheck);
+        return 0;
+}
+
+int main(int argc, char* argv[]){
+        if (argc > 1 && std::strcmp(argv[1], "--bench") == 0) {
+                return runTimestampBenchmark();
+        }
+        if (argc > 2 && std::strcmp(argv[1], "--expr") == 0) {
+                return runExpression(argv[2], argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 10000000);
+        }
+        if (argc > 1 && std::strcmp(argv[1], "--kernel-bench") == 0) {
+                return runKernelBenchmark(argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10000000);
+        }
+        if (argc > 1 && std::strcmp(argv[1], "--batch-bench") == 0) {
+                return runBatchBenchmark(argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20000000);
+        }
+
 
         addFunction(10,20);
         subtractFunction(10,20);
@@ -1,22 +1,403 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#include <thread>
 
-// Car structure Defined and named as Car
-struct Car {
-    int id;
-    std::string brand;
-    std::string model;
-    int year;
-};
+#include "car.h"
+#include "carCatalog.h"
+#include "fileReader.h"
+#include "fuzzySearch.h"
+#include "registry.h"
 
-// Display car - we displayed car as const so the data cant be modified and referred to c
-void displayCar(const Car& c) {
-    std::cout << "ID: " << c.id << " | Brand: " << c.brand << " | Model: " << c.model << " | Year: " << c.year << "\n";
+// synthetic fleet: ids 1, 8, 15, ... with random brands, models and years
+Car syntheticCar(std::size_t i, std::uint32_t& state) {
+    static const char* brands[] = {"BMW", "Ford", "Toyota", "Honda", "Audi", "Fiat", "Volvo", "Kia"};
+    static const char* models[] = {"X5", "Mustang", "Corolla", "Civic", "A4", "Panda", "V70", "Rio",
+                                   "M3", "Focus", "Yaris", "Accord", "Q7", "Uno", "XC90", "Ceed"};
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return Car{static_cast<int>(i * 7 + 1), brands[state % 8], models[(state >> 3) % 16],
+               1950 + static_cast<int>((state >> 8) % 75)};
 }
 
-int main() {
-    std::vector<Car> cars; //cars is a vector array of Car structs
+std::vector<Car> syntheticFleet(std::size_t count) {
+    std::vector<Car> cars;
+    cars.reserve(count);
+    std::uint32_t state = 2463534242u;
+    for (std::size_t i = 0; i < count; ++i) cars.push_back(syntheticCar(i, state));
+    return cars;
+}
+
+// --generate <catalog> <rows> - the synthetic fleet as a catalog file, written 1 MB at a time
+bool generateCatalog(const std::string& path, std::size_t rows) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    std::string buffer;
+    buffer.reserve(1 << 20);
+    out << "id,brand,model,year\n";
+    std::uint32_t state = 2463534242u;
+    for (std::size_t i = 0; i < rows; ++i) {
+        Car car = syntheticCar(i, state);
+        buffer += std::to_string(car.id);
+        buffer += ',';
+        buffer += car.brand;
+        buffer += ',';
+        buffer += car.model;
+        buffer += ',';
+        buffer += std::to_string(car.year);
+        buffer += '\n';
+        if (buffer.size() > (1 << 20) - 64) {
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    }
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    return static_cast<bool>(out);
+}
+
+// Edge cases for parseCarLine, run by --load; returns the lines it got wrong (empty when none)
+std::string checkCarLineParser() {
+    struct Case {
+        const char* line;
+        bool valid;
+    };
+    static const Case cases[] = {
+        {"2,Ford,Mustang,1969", true},   {" 2 , Ford , Mustang , 1969 \r", true},
+        {"-5,Kia,Rio,-1", true},         {"2147483647,Kia,Rio,2000", true},
+        {"123", false},                  {"123 ", false},
+        {"1,Ford", false},               {"1,Ford,Mustang", false},
+        {"1,Ford,Mustang,", false},      {"1,Ford,Mustang,1969,", false},
+        {"1,,Mustang,1969", false},      {"2147483648,Kia,Rio,2000", false},
+        {"x,Ford,Mustang,1969", false},  {",Ford,Mustang,1969", false},
+    };
+    std::string failed;
+    Car car{};
+    for (const Case& c : cases) {
+        if (parseCarLine(c.line, car) != c.valid) failed += std::string(failed.empty() ? "" : ", ") + '"' + c.line + '"';
+    }
+    return failed;
+}
+
+// --load <catalog> [threads] - bulk load into the registry, timed against just reading the file
+int runCatalogLoad(const std::string& path, unsigned threads) {
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::time_point a, Clock::time_point b) { return std::chrono::duration<double, std::milli>(b - a).count(); };
+
+    // baseline: map the file and find every line end, nothing else
+    auto t0 = Clock::now();
+    std::size_t lines = 0, bytes = 0;
+    {
+        MappedFile input;
+        if (!input.open(path)) {
+            std::cout << "Could not read " << path << "\n";
+            return 1;
+        }
+        std::string_view text = input.view();
+        bytes = text.size();
+        for (const char* p = text.data(); (p = static_cast<const char*>(std::memchr(p, '\n', text.data() + text.size() - p))) != nullptr; ++p) ++lines;
+    }
+    auto t1 = Clock::now();
+
+    Registry<Car> cars;
+    CatalogLoadStats stats;
+    std::string error;
+    if (!loadCarCatalog(path, threads, cars, stats, error)) {
+        std::cout << error << "\n";
+        return 1;
+    }
+    auto t2 = Clock::now();
+
+    std::cout << "Catalog: " << bytes / (1024 * 1024) << " MB, " << lines << " lines | " << threads << " threads\n";
+    std::cout << "  read only : " << ms(t0, t1) << " ms\n";
+    std::cout << "  bulk load : " << ms(t1, t2) << " ms | " << stats.rows << " cars, " << stats.malformed
+              << " malformed, " << stats.duplicates << " duplicate ids\n";
+    std::cout << "  cars from 1965 to 1975: " << cars.countInRange<&Car::year>(1965, 1975) << "\n";
+    std::string parserFailures = checkCarLineParser();
+    std::cout << "  parser checks: " << (parserFailures.empty() ? "ok" : "FAILED on " + parserFailures) << "\n";
+    return parserFailures.empty() ? 0 : 1;
+}
+
+// Drops the file from the page cache where the platform allows it, so the next read goes to disk
+void evictFromPageCache(const std::string& path) {
+#if defined(POSIX_FADV_DONTNEED)
+    int fd = openReadOnly(path);
+    if (fd >= 0) ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    closeFile(fd);
+#else
+    (void)path;
+#endif
+}
+
+// --read-bench <catalog> [block KB] [depth] [workers] - the read / mmap / io_uring backends, each
+// once from a cold page cache and once warm: counting lines only, then the full bulk load
+int runReadBenchmark(const std::string& path, std::size_t blockKb, unsigned depth, unsigned workers) {
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::time_point a, Clock::time_point b) { return std::chrono::duration<double, std::milli>(b - a).count(); };
+    FileReadOptions options;
+    options.blockSize = blockKb * 1024;
+    options.depth = depth;
+    options.workers = workers;
+    std::cout << "Blocks of " << blockKb << " KB, " << depth << " buffers, " << workers << " workers\n";
+    for (FileBackend backend : {FileBackend::blocking, FileBackend::mapped, FileBackend::uring}) {
+        options.backend = backend;
+        for (bool cold : {true, false}) {
+            if (cold) evictFromPageCache(path);
+            std::atomic<std::uint64_t> lines{0};
+            FileReadStats stats;
+            std::string error;
+            auto t0 = Clock::now();
+            bool ok = readFileBlocks(path, options, [&](std::size_t, std::string_view block) {
+                lines.fetch_add(static_cast<std::uint64_t>(std::count(block.begin(), block.end(), '\n')), std::memory_order_relaxed);
+            }, stats, error);
+            auto t1 = Clock::now();
+            if (!ok) {
+                std::cout << error << "\n";
+                return 1;
+            }
+            if (cold) evictFromPageCache(path);
+            Registry<Car> cars;
+            CatalogLoadStats loadStats;
+            FileReadStats loadReadStats;
+            auto t2 = Clock::now();
+            if (!loadCarCatalog(path, options, cars, loadStats, loadReadStats, error)) {
+                std::cout << error << "\n";
+                return 1;
+            }
+            auto t3 = Clock::now();
+            double mb = static_cast<double>(stats.bytes) / (1024.0 * 1024.0);
+            std::cout << "  " << fileBackendName(backend) << (stats.used != backend ? std::string(" (ran as ") + fileBackendName(stats.used) + ")" : "")
+                      << (cold ? " cold" : " warm") << ": lines " << ms(t0, t1) << " ms (" << mb / (ms(t0, t1) / 1000.0) << " MB/s, "
+                      << lines.load() << ") | bulk load " << ms(t2, t3) << " ms (" << loadStats.rows << " cars, "
+                      << loadStats.malformed << " malformed)\n";
+        }
+    }
+    return 0;
+}
+
+// --bench [cars] - synthetic fleet in Registry<Car>, indexed lookups against scanning the vector
+int runInventoryBenchmark(std::size_t count) {
+    std::vector<Car> cars = syntheticFleet(count);
+
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::time_point a, Clock::time_point b) { return std::chrono::duration<double, std::milli>(b - a).count(); };
+    auto t0 = Clock::now();
+    Registry<Car> inventory;
+    inventory.reserve(count);
+    for (const Car& car : cars) inventory.add(car);
+    inventory.countInRange<&Car::year>(0, 0);   // merges the year index
+    auto t1 = Clock::now();
+
+    const int lookups = 1000;
+    std::size_t found = 0, scanned = 0;
+    auto t2 = Clock::now();
+    // ids of rows spread over the whole fleet, so the scan does not get lucky early on
+    auto idOfLookup = [&](std::size_t i, std::size_t total) { return static_cast<int>((count / total * i + count / (2 * total)) * 7 + 1); };
+    for (int i = 0; i < lookups; ++i) found += inventory.find<&Car::id>(idOfLookup(i, lookups)) != Registry<Car>::npos;
+    auto t3 = Clock::now();
+    for (int i = 0; i < lookups / 100; ++i) {
+        int id = idOfLookup(i, lookups / 100);
+        for (const Car& car : cars) {
+            if (car.id == id) {
+                ++scanned;
+                break;
+            }
+        }
+    }
+    auto t4 = Clock::now();
+
+    std::size_t inRange = 0, scanRange = 0;
+    inventory.forEachInRange<&Car::year>(1965, 1975, [&](std::uint32_t) { ++inRange; });
+    auto t5 = Clock::now();
+    for (const Car& car : cars) scanRange += car.year >= 1965 && car.year <= 1975;
+    auto t6 = Clock::now();
+
+    // brands are grouped; the model is checked on the rows of the brand
+    std::size_t mustangs = 0;
+    for (std::uint32_t row : inventory.rowsWith<&Car::brand>("Ford")) mustangs += inventory.value<&Car::model>(row) == "Mustang";
+    auto t7 = Clock::now();
+    std::size_t scanMustangs = 0;
+    for (const Car& car : cars) scanMustangs += car.brand == "Ford" && car.model == "Mustang";
+    auto t8 = Clock::now();
+
+    std::cout << "Cars: " << count << " | indexes built in " << ms(t0, t1) << " ms\n";
+    std::cout << "  id lookup      : index " << ms(t2, t3) * 1000.0 / lookups << " us | scan "
+              << ms(t3, t4) * 1000.0 / (lookups / 100) << " us per lookup (" << found << " / " << scanned << " found)\n";
+    std::cout << "  years 1965-1975: index " << ms(t4, t5) << " ms | scan " << ms(t5, t6) << " ms ("
+              << inRange << (inRange == scanRange ? "" : " | MISMATCH") << " cars)\n";
+    std::cout << "  Ford Mustang   : index " << ms(t6, t7) * 1000.0 << " us | scan " << ms(t7, t8) << " ms ("
+              << mustangs << (mustangs == scanMustangs ? "" : " | MISMATCH") << " cars)\n";
+    return 0;
+}
+
+// syllable soup, so the catalog looks like model names and trigrams repeat the way real ones do
+std::string syntheticName(std::uint32_t& state) {
+    static const char* syllables[] = {"ka", "ro", "mus", "tan", "ci", "vic", "cor", "ol", "la", "pan",
+                                      "da", "fo", "cus", "ya", "ris", "ac", "cor", "de", "tu", "an",
+                                      "za", "mo", "ne", "ti", "gal", "ax", "sen", "tra", "vo", "lu"};
+    std::string name;
+    unsigned parts = 2 + state % 3;
+    for (unsigned p = 0; p < parts; ++p) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        name += syllables[state % 30];
+    }
+    return name;
+}
+
+// --fuzzy-bench [names] [k] - typo'd queries against a synthetic catalog, checked against brute force
+int runFuzzyBenchmark(std::size_t count, unsigned k) {
+    FuzzyIndex index;
+    std::uint32_t state = 2463534242u;
+    std::vector<std::string> catalog;
+    while (index.size() < count) {
+        std::string name = syntheticName(state);
+        name += std::to_string(state % 1000);   // trim codes keep a million names distinct
+        if (index.add(name) + 1 == index.size()) catalog.push_back(name);
+    }
+    using Clock = std::chrono::steady_clock;
+    auto t0 = Clock::now();
+    index.build();
+    auto t1 = Clock::now();
+
+    // one or two typos (swap, drop, replace) per query
+    std::vector<std::string> queries;
+    for (std::size_t q = 0; q < 200; ++q) {
+        std::string query = catalog[(q * 7919) % catalog.size()];
+        std::size_t at = 1 + q % (query.size() - 2);
+        if (q % 3 == 0) std::swap(query[at], query[at + 1]);
+        else if (q % 3 == 1) query.erase(at, 1);
+        else query[at] = 'x';
+        queries.push_back(query);
+    }
+    std::size_t found = 0, candidates = 0;
+    auto t2 = Clock::now();
+    for (const std::string& query : queries) {
+        found += index.search(query, k).size();
+        candidates += index.candidatesChecked();
+    }
+    auto t3 = Clock::now();
+
+    // brute force over the whole catalog for a few queries, to check nothing was filtered away
+    bool same = true;
+    for (std::size_t q = 0; q < 3; ++q) {
+        std::size_t brute = 0;
+        for (const std::string& name : catalog) brute += editDistance(queries[q], name) <= k;
+        same = same && index.search(queries[q], k, catalog.size()).size() == brute;
+    }
+
+    double usPerQuery = std::chrono::duration<double, std::micro>(t3 - t2).count() / queries.size();
+    std::cout << "Names: " << index.size() << " | trigram index built in "
+              << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms\n";
+    std::cout << "  k = " << k << ": " << usPerQuery << " us per query | " << candidates / queries.size()
+              << " candidates checked per query | " << found << " matches"
+              << (same ? "" : " | MISMATCH against brute force") << "\n";
+    return 0;
+}
+
+// --registry-bench [cars] - the same fleet in Registry<Car>: indexes, a column scan against the
+// vector of structs, formatting and a binary save / load round trip
+int runRegistryBenchmark(std::size_t count) {
+    std::vector<Car> cars = syntheticFleet(count);
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::time_point a, Clock::time_point b) { return std::chrono::duration<double, std::milli>(b - a).count(); };
+
+    auto t0 = Clock::now();
+    Registry<Car> registry;
+    registry.reserve(count);
+    for (const Car& car : cars) registry.add(car);
+    registry.countInRange<&Car::year>(0, 0);   // merges the year index
+    auto t1 = Clock::now();
+
+    std::size_t found = 0;
+    for (std::size_t i = 0; i < 1000; ++i) {
+        found += registry.find<&Car::id>(static_cast<int>((count / 1000 * i) * 7 + 1)) != Registry<Car>::npos;
+    }
+    auto t2 = Clock::now();
+    std::size_t inRange = registry.countInRange<&Car::year>(1965, 1975);
+    std::size_t fords = registry.rowsWith<&Car::brand>("Ford").size();
+    auto t3 = Clock::now();
+
+    long long columnSum = 0, structSum = 0;
+    for (int year : registry.column<&Car::year>()) columnSum += year;
+    auto t4 = Clock::now();
+    for (const Car& car : cars) structSum += car.year;
+    auto t5 = Clock::now();
+
+    std::string text;
+    for (std::uint32_t row = 0; row < registry.size(); ++row) registry.appendRow(text, row);
+    auto t6 = Clock::now();
+
+    std::string bytes, error;
+    registry.serialize(bytes);
+    auto t7 = Clock::now();
+    Registry<Car> loaded;
+    bool ok = loaded.deserialize(bytes, error);
+    auto t8 = Clock::now();
+    std::uint32_t second = loaded.find<&Car::id>(8);
+    ok = ok && loaded.size() == registry.size() && second != Registry<Car>::npos && loaded.at(second).model == cars[1].model;
+
+    std::cout << "Cars: " << count << " | registry built in " << ms(t0, t1) << " ms\n";
+    std::cout << "  1000 id lookups " << ms(t1, t2) << " ms (" << found << " found) | years 1965-1975 and Ford rows "
+              << ms(t2, t3) << " ms (" << inRange << ", " << fords << " cars)\n";
+    std::cout << "  year sum: column " << ms(t3, t4) << " ms | vector of structs " << ms(t4, t5) << " ms"
+              << (columnSum == structSum ? "" : " | MISMATCH") << "\n";
+    std::cout << "  formatted " << text.size() / (1024 * 1024) << " MB in " << ms(t5, t6) << " ms\n";
+    std::cout << "  binary: " << bytes.size() / (1024 * 1024) << " MB, saved in " << ms(t6, t7) << " ms, loaded (indexes rebuilt) in "
+              << ms(t7, t8) << " ms" << (ok ? "" : " | ROUND TRIP FAILED: " + error) << "\n";
+    return ok ? 0 : 1;
+}
+
+// --search <text> [k] - closest brands and models in the demo catalog
+int runFuzzySearch(const Registry<Car>& cars, const std::string& text, unsigned k) {
+    FuzzyIndex index;
+    for (const std::string& brand : cars.column<&Car::brand>()) index.add(brand);
+    for (const std::string& model : cars.column<&Car::model>()) index.add(model);
+    std::vector<FuzzyMatch> matches = index.search(text, k);
+    if (matches.empty()) std::cout << "No brand or model within " << k << " edits of \"" << text << "\"\n";
+    for (const FuzzyMatch& match : matches) {
+        std::cout << "  " << index.term(match.term) << " (distance " << match.distance << ")\n";
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::strcmp(argv[1], "--bench") == 0) {
+        return runInventoryBenchmark(argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5000000);
+    }
+    if (argc > 3 && std::strcmp(argv[1], "--generate") == 0) {
+        if (!generateCatalog(argv[2], std::strtoull(argv[3], nullptr, 10))) {
+            std::cout << "Could not write " << argv[2] << "\n";
+            return 1;
+        }
+        return 0;
+    }
+    if (argc > 2 && std::strcmp(argv[1], "--load") == 0) {
+        unsigned threads = argc > 3 ? static_cast<unsigned>(std::strtoul(argv[3], nullptr, 10))
+                                    : std::max(1u, std::thread::hardware_concurrency());
+        return runCatalogLoad(argv[2], threads);
+    }
+    if (argc > 2 && std::strcmp(argv[1], "--read-bench") == 0) {
+        return runReadBenchmark(argv[2], argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 1024,
+                                argc > 4 ? static_cast<unsigned>(std::strtoul(argv[4], nullptr, 10)) : 8,
+                                argc > 5 ? static_cast<unsigned>(std::strtoul(argv[5], nullptr, 10))
+                                         : std::max(1u, std::thread::hardware_concurrency()));
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--registry-bench") == 0) {
+        return runRegistryBenchmark(argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5000000);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--fuzzy-bench") == 0) {
+        return runFuzzyBenchmark(argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000000,
+                                 argc > 3 ? static_cast<unsigned>(std::strtoul(argv[3], nullptr, 10)) : 2);
+    }
+
+    Registry<Car> cars; //cars is stored by column and indexed by id, brand and year
 
     Car c1;
     c1.id = 1;
@@ -30,12 +411,18 @@ int main() {
     c2.model = "Mustang";
     c2.year = 1969;
 
-    cars.push_back(c1); // we are pushing above created data into array std::vector<Car>
-    cars.push_back(c2);
+    cars.add(c1); // we are pushing above created data into the registry
+    cars.add(c2);
 
     std::cout << "\n--- Car List ---\n";
-    for (const Car& c : cars) { //range based for loop for displaying Cars Array output
-        displayCar(c);
+    cars.print(std::cout); //every car formatted into one buffer and written at once
+
+    std::cout << "\n--- Cars from 1965 to 1975 ---\n";
+    cars.forEachInRange<&Car::year>(1965, 1975, [&](std::uint32_t row) { displayCar(cars.at(row)); });
+
+    if (argc > 2 && std::strcmp(argv[1], "--search") == 0) {
+        std::cout << "\n--- Closest to \"" << argv[2] << "\" ---\n";
+        return runFuzzySearch(cars, argv[2], argc > 3 ? static_cast<unsigned>(std::strtoul(argv[3], nullptr, 10)) : 2);
     }
 
     return 0;
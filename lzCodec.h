@@ -0,0 +1,361 @@
+//
+// A small LZ77 block codec (LZ4 style byte format) and a container of independently compressed
+// blocks, for registry snapshots and text exports.
+//
+// Compressed block: a run of sequences, each
+//     token      high nibble literal length, low nibble match length - 4 (15 = more bytes follow)
+//     [length]   255, 255, ..., n   added to a nibble that is 15
+//     literals
+//     offset     2 bytes little endian, 1..65535 back from the current output position
+//     [length]   rest of the match length
+// The last sequence stops after its literals. Matching is greedy through a 16K entry hash of
+// 4 byte prefixes - built for decode speed (no entropy stage), not for the best ratio.
+//
+// Container:  "EVZB" | u32 version | u32 meta length | meta | u32 blocks |
+//             per block u32 raw size, u32 stored size (top bit: stored uncompressed) | payloads
+// Every block decompresses on its own, so loading spreads the blocks over a pool of threads.
+//
+
+#ifndef EMPLOYEE_VALIDATION_C_LZCODEC_H
+#define EMPLOYEE_VALIDATION_C_LZCODEC_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+inline constexpr std::size_t kLzMinMatch = 4;
+inline constexpr std::size_t kLzMaxOffset = 65535;
+// most bytes one compressed byte can expand to (a 255 length byte), so a block header that
+// claims more than storedSize * kLzMaxExpansion raw bytes is corrupt
+inline constexpr std::uint64_t kLzMaxExpansion = 255;
+inline constexpr int kLzHashBits = 14;
+
+inline std::uint32_t lzLoad32(const unsigned char* p) {
+    std::uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline std::uint32_t lzHash(std::uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - kLzHashBits);
+}
+
+inline void lzAppendLength(std::string& out, std::size_t length) {
+    for (; length >= 255; length -= 255) out += static_cast<char>(255);
+    out += static_cast<char>(length);
+}
+
+// Appends the compressed form of in to out
+inline void lzCompress(std::string_view in, std::string& out) {
+    const auto* src = reinterpret_cast<const unsigned char*>(in.data());
+    const std::size_t n = in.size();
+    std::vector<std::uint32_t> table(std::size_t(1) << kLzHashBits, 0xFFFFFFFFu);
+    std::size_t anchor = 0;
+    std::size_t ip = 0;
+    auto emit = [&](std::size_t literals, std::size_t offset, std::size_t matchLength) {
+        const std::size_t extra = matchLength - kLzMinMatch;
+        out += static_cast<char>((std::min<std::size_t>(literals, 15) << 4) | std::min<std::size_t>(extra, 15));
+        if (literals >= 15) lzAppendLength(out, literals - 15);
+        out.append(in.data() + anchor, literals);
+        out += static_cast<char>(offset & 0xFF);
+        out += static_cast<char>(offset >> 8);
+        if (extra >= 15) lzAppendLength(out, extra - 15);
+    };
+    if (n >= kLzMinMatch + 1) {
+        const std::size_t limit = n - kLzMinMatch;   // last position a 4 byte prefix can start at
+        while (ip <= limit) {
+            const std::uint32_t sequence = lzLoad32(src + ip);
+            std::uint32_t& slot = table[lzHash(sequence)];
+            const std::size_t candidate = slot;
+            slot = static_cast<std::uint32_t>(ip);
+            if (candidate == 0xFFFFFFFFu || ip - candidate > kLzMaxOffset || lzLoad32(src + candidate) != sequence) {
+                ip += 1 + ((ip - anchor) >> 6);   // skip faster through data that does not match
+                continue;
+            }
+            std::size_t start = ip, from = candidate;
+            while (start > anchor && from > 0 && src[start - 1] == src[from - 1]) {
+                --start;
+                --from;
+            }
+            std::size_t length = ip + kLzMinMatch - start;
+            while (start + length < n && src[from + length] == src[start + length]) ++length;
+            emit(start - anchor, start - from, length);
+            ip = start + length;
+            anchor = ip;
+            if (ip - 2 <= limit) table[lzHash(lzLoad32(src + ip - 2))] = static_cast<std::uint32_t>(ip - 2);
+        }
+    }
+    const std::size_t literals = n - anchor;
+    out += static_cast<char>(std::min<std::size_t>(literals, 15) << 4);
+    if (literals >= 15) lzAppendLength(out, literals - 15);
+    out.append(in.data() + anchor, literals);
+}
+
+// Decompresses exactly rawSize bytes into target; false on corrupt or truncated input
+inline bool lzDecompress(std::string_view in, char* target, std::size_t rawSize) {
+    const auto* ip = reinterpret_cast<const unsigned char*>(in.data());
+    const auto* const end = ip + in.size();
+    char* op = target;
+    char* const outEnd = target + rawSize;
+    auto readLength = [&](std::size_t& length) {
+        unsigned char more;
+        do {
+            if (ip == end) return false;
+            more = *ip++;
+            length += more;
+        } while (more == 255);
+        return true;
+    };
+    while (ip < end) {
+        const unsigned token = *ip++;
+        // shortcut for the usual sequence, up to 14 literals and an 18 byte match well inside
+        // both buffers: fixed size copies only
+        if ((token >> 4) < 15 && (token & 15) < 15 && end - ip >= 18 && outEnd - op >= 32) {
+            std::memcpy(op, ip, 16);
+            op += token >> 4;
+            ip += token >> 4;
+            const std::size_t offset = static_cast<std::size_t>(ip[0]) | (static_cast<std::size_t>(ip[1]) << 8);
+            const std::size_t length = (token & 15) + kLzMinMatch;
+            if (offset >= 8 && offset <= static_cast<std::size_t>(op - target)) {
+                ip += 2;
+                const char* from = op - offset;
+                std::memcpy(op, from, 8);
+                std::memcpy(op + 8, from + 8, 8);
+                std::memcpy(op + 16, from + 16, 2);
+                op += length;
+                continue;
+            }
+            ip -= token >> 4;   // small or bad offset: the general path below starts over
+            op -= token >> 4;
+        }
+        std::size_t literals = token >> 4;
+        if (literals == 15 && !readLength(literals)) return false;
+        if (static_cast<std::size_t>(end - ip) < literals || static_cast<std::size_t>(outEnd - op) < literals) return false;
+        if (end - ip >= 16 && outEnd - op >= 16 && literals <= 16) std::memcpy(op, ip, 16);   // fixed size: no call, no branches
+        else std::memcpy(op, ip, literals);
+        op += literals;
+        ip += literals;
+        if (ip == end) break;   // the last sequence has no match
+        if (end - ip < 2) return false;
+        const std::size_t offset = static_cast<std::size_t>(ip[0]) | (static_cast<std::size_t>(ip[1]) << 8);
+        ip += 2;
+        std::size_t length = token & 15;
+        if (length == 15 && !readLength(length)) return false;
+        length += kLzMinMatch;
+        if (offset == 0 || offset > static_cast<std::size_t>(op - target) || static_cast<std::size_t>(outEnd - op) < length) {
+            return false;
+        }
+        const char* from = op - offset;
+        if (offset >= 16 && static_cast<std::size_t>(outEnd - op) >= length + 16) {
+            char* const stop = op + length;
+            for (; op < stop; op += 16, from += 16) std::memcpy(op, from, 16);
+            op = stop;
+        }
+        else if (offset >= 8 && static_cast<std::size_t>(outEnd - op) >= length + 8) {
+            // 8 bytes at a time; may write up to 7 bytes past the match, which later output overwrites
+            char* const stop = op + length;
+            for (; op < stop; op += 8, from += 8) std::memcpy(op, from, 8);
+            op = stop;
+        }
+        else {
+            for (std::size_t i = 0; i < length; ++i) op[i] = from[i];
+            op += length;
+        }
+    }
+    return op == outEnd;
+}
+
+// ---- container ----
+
+inline constexpr char kBlockFileMagic[4] = {'E', 'V', 'Z', 'B'};
+inline constexpr std::uint32_t kBlockFileVersion = 1;
+inline constexpr std::uint32_t kStoredFlag = 0x80000000u;
+
+struct PackedBlock {
+    std::uint32_t rawSize = 0;
+    std::uint32_t storedSize = 0;   // bytes in the file
+    bool compressed = true;
+    std::size_t offset = 0;         // of the payload in the file
+};
+
+struct BlockDirectory {
+    std::string_view meta;
+    std::vector<PackedBlock> blocks;
+    std::uint64_t rawBytes = 0;
+};
+
+// block(i) for i in [0, count), spread over threads; the first thread is the caller. The first
+// exception thrown by block() skips the blocks not started yet and is rethrown here once every
+// thread has finished.
+template <typename Fn>
+void forEachBlock(std::size_t count, unsigned threads, Fn&& block) {
+    std::atomic<std::size_t> next{0};
+    std::mutex failureLock;
+    std::exception_ptr failure;
+    auto worker = [&] {
+        try {
+            for (std::size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) block(i);
+        }
+        catch (...) {
+            next.store(count);
+            std::lock_guard guard(failureLock);
+            if (!failure) failure = std::current_exception();
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < std::min<std::size_t>(threads, count); ++t) {
+        try {
+            pool.emplace_back(worker);
+        }
+        catch (const std::system_error&) {
+            break;   // no more threads: the ones running take the rest
+        }
+    }
+    worker();
+    for (auto& thread : pool) thread.join();
+    if (failure) std::rethrow_exception(failure);
+}
+
+// Container around meta and the blocks, compressed on threads. A block that does not get
+// smaller is stored as it is.
+inline std::string packBlocks(std::string_view meta, const std::vector<std::string>& blocks, unsigned threads) {
+    std::vector<std::string> packed(blocks.size());
+    forEachBlock(blocks.size(), threads, [&](std::size_t b) {
+        packed[b].reserve(blocks[b].size() / 2);
+        lzCompress(blocks[b], packed[b]);
+        if (packed[b].size() >= blocks[b].size()) packed[b].clear();
+    });
+    auto appendU32 = [](std::string& out, std::uint32_t value) { out.append(reinterpret_cast<const char*>(&value), sizeof(value)); };
+    std::size_t total = 16 + meta.size() + blocks.size() * 8;
+    for (std::size_t b = 0; b < blocks.size(); ++b) total += packed[b].empty() ? blocks[b].size() : packed[b].size();
+    std::string out;
+    out.reserve(total);
+    out.append(kBlockFileMagic, 4);
+    appendU32(out, kBlockFileVersion);
+    appendU32(out, static_cast<std::uint32_t>(meta.size()));
+    out.append(meta);
+    appendU32(out, static_cast<std::uint32_t>(blocks.size()));
+    for (std::size_t b = 0; b < blocks.size(); ++b) {
+        appendU32(out, static_cast<std::uint32_t>(blocks[b].size()));
+        appendU32(out, packed[b].empty() ? static_cast<std::uint32_t>(blocks[b].size()) | kStoredFlag
+                                         : static_cast<std::uint32_t>(packed[b].size()));
+    }
+    for (std::size_t b = 0; b < blocks.size(); ++b) out.append(packed[b].empty() ? std::string_view(blocks[b]) : std::string_view(packed[b]));
+    return out;
+}
+
+inline bool readBlockDirectory(std::string_view data, BlockDirectory& directory, std::string& error) {
+    std::size_t at = 0;
+    auto readU32 = [&](std::uint32_t& value) {
+        if (data.size() - at < sizeof(value)) return false;
+        std::memcpy(&value, data.data() + at, sizeof(value));
+        at += sizeof(value);
+        return true;
+    };
+    std::uint32_t version = 0, metaLength = 0, count = 0;
+    if (data.size() < 4 || std::memcmp(data.data(), kBlockFileMagic, 4) != 0) {
+        error = "not a compressed block file";
+        return false;
+    }
+    at = 4;
+    if (!readU32(version) || version != kBlockFileVersion) {
+        error = "unsupported compressed block file version";
+        return false;
+    }
+    if (!readU32(metaLength) || data.size() - at < metaLength) {
+        error = "truncated compressed block file";
+        return false;
+    }
+    directory = BlockDirectory{};
+    directory.meta = data.substr(at, metaLength);
+    at += metaLength;
+    if (!readU32(count) || (data.size() - at) / 8 < count) {
+        error = "truncated compressed block file";
+        return false;
+    }
+    directory.blocks.resize(count);
+    for (PackedBlock& block : directory.blocks) {
+        std::uint32_t stored = 0;
+        readU32(block.rawSize);
+        readU32(stored);
+        block.compressed = (stored & kStoredFlag) == 0;
+        block.storedSize = stored & ~kStoredFlag;
+        directory.rawBytes += block.rawSize;
+    }
+    for (PackedBlock& block : directory.blocks) {
+        if (data.size() - at < block.storedSize) {
+            error = "truncated compressed block file";
+            return false;
+        }
+        if (block.compressed ? std::uint64_t{block.storedSize} * kLzMaxExpansion < block.rawSize
+                             : block.storedSize != block.rawSize) {
+            error = "corrupt compressed block file";
+            return false;
+        }
+        block.offset = at;
+        at += block.storedSize;
+    }
+    return true;
+}
+
+// The raw bytes of one block, written to target (rawSize bytes)
+inline bool unpackBlock(std::string_view data, const PackedBlock& block, char* target) {
+    std::string_view stored = data.substr(block.offset, block.storedSize);
+    if (!block.compressed) {
+        std::memcpy(target, stored.data(), stored.size());
+        return true;
+    }
+    return lzDecompress(stored, target, block.rawSize);
+}
+
+// Text cut into blocks of about blockSize bytes that end on a newline
+inline std::string packText(std::string_view text, std::size_t blockSize, unsigned threads) {
+    std::vector<std::string> blocks;
+    while (!text.empty()) {
+        std::size_t end = std::min(text.size(), blockSize);
+        if (end < text.size()) {
+            std::size_t newline = text.rfind('\n', end - 1);
+            if (newline != std::string_view::npos) end = newline + 1;
+        }
+        blocks.emplace_back(text.substr(0, end));
+        text.remove_prefix(end);
+    }
+    return packBlocks({}, blocks, threads);
+}
+
+// The text back, every block decompressed straight into its place in text
+inline bool unpackText(std::string_view data, unsigned threads, std::string& text, std::string& error) {
+    BlockDirectory directory;
+    if (!readBlockDirectory(data, directory, error)) return false;
+    // bounded by readBlockDirectory, but it can still be more than the machine has
+    try {
+        text.resize(static_cast<std::size_t>(directory.rawBytes));
+    }
+    catch (const std::bad_alloc&) {
+        error = "not enough memory for " + std::to_string(directory.rawBytes) + " bytes of text";
+        return false;
+    }
+    std::vector<std::size_t> starts(directory.blocks.size(), 0);
+    for (std::size_t b = 1; b < starts.size(); ++b) starts[b] = starts[b - 1] + directory.blocks[b - 1].rawSize;
+    std::atomic<bool> ok{true};
+    forEachBlock(directory.blocks.size(), threads, [&](std::size_t b) {
+        if (!unpackBlock(data, directory.blocks[b], text.data() + starts[b])) ok.store(false);
+    });
+    if (!ok) {
+        text.clear();
+        error = "corrupt compressed block";
+    }
+    return ok;
+}
+
+#endif //EMPLOYEE_VALIDATION_C_LZCODEC_H
@@ -0,0 +1,181 @@
+//
+// Read-only memory mapped files - the bulk loaders parse straight out of the page cache
+// instead of copying lines into std::string. Windows builds fall back to reading the bytes.
+//
+
+#ifndef EMPLOYEE_VALIDATION_C_MAPPEDFILE_H
+#define EMPLOYEE_VALIDATION_C_MAPPEDFILE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+inline int openReadOnly(const std::string& path) {
+#if defined(_WIN32)
+    return ::_open(path.c_str(), _O_RDONLY | _O_BINARY);
+#else
+    return ::open(path.c_str(), O_RDONLY);
+#endif
+}
+
+inline void closeFile(int fd) {
+    if (fd < 0) return;
+#if defined(_WIN32)
+    ::_close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+// -1 when the size cannot be read
+inline std::int64_t fileSize(int fd) {
+#if defined(_WIN32)
+    return ::_lseeki64(fd, 0, SEEK_END);
+#else
+    struct stat info;
+    if (::fstat(fd, &info) != 0) return -1;
+    return static_cast<std::int64_t>(info.st_size);
+#endif
+}
+
+// A mapped window of an open file - view() starts exactly at the requested offset
+// even though the mapping itself has to start on a page boundary
+class MappedRegion {
+public:
+    MappedRegion() = default;
+    MappedRegion(const MappedRegion&) = delete;
+    MappedRegion& operator=(const MappedRegion&) = delete;
+    MappedRegion(MappedRegion&& other) noexcept { swap(other); }
+    MappedRegion& operator=(MappedRegion&& other) noexcept {
+        unmap();
+        swap(other);
+        return *this;
+    }
+    ~MappedRegion() { unmap(); }
+
+    bool map(int fd, std::uint64_t offset, std::size_t length) {
+        unmap();
+        if (length == 0) return true;
+#if defined(_WIN32)
+        buffer.resize(length);
+        if (::_lseeki64(fd, static_cast<__int64>(offset), SEEK_SET) < 0) return false;
+        std::size_t done = 0;
+        while (done < length) {
+            int got = ::_read(fd, buffer.data() + done, static_cast<unsigned>(std::min<std::size_t>(length - done, 1 << 30)));
+            if (got <= 0) return false;
+            done += static_cast<std::size_t>(got);
+        }
+        data = buffer.data();
+        size = length;
+        return true;
+#else
+        static const std::uint64_t pageSize = static_cast<std::uint64_t>(::sysconf(_SC_PAGESIZE));
+        std::uint64_t alignedOffset = offset - offset % pageSize;
+        std::size_t slack = static_cast<std::size_t>(offset - alignedOffset);
+        void* address = ::mmap(nullptr, length + slack, PROT_READ, MAP_PRIVATE, fd, static_cast<off_t>(alignedOffset));
+        if (address == MAP_FAILED) return false;
+        ::madvise(address, length + slack, MADV_SEQUENTIAL);
+        base = address;
+        mappedLength = length + slack;
+        data = static_cast<const char*>(address) + slack;
+        size = length;
+        return true;
+#endif
+    }
+
+    void unmap() {
+#if defined(_WIN32)
+        buffer.clear();
+#else
+        if (base != nullptr) ::munmap(base, mappedLength);
+        base = nullptr;
+        mappedLength = 0;
+#endif
+        data = nullptr;
+        size = 0;
+    }
+
+    std::string_view view() const { return std::string_view(data, size); }
+
+private:
+    void swap(MappedRegion& other) noexcept {
+        std::swap(data, other.data);
+        std::swap(size, other.size);
+#if defined(_WIN32)
+        std::swap(buffer, other.buffer);
+#else
+        std::swap(base, other.base);
+        std::swap(mappedLength, other.mappedLength);
+#endif
+    }
+
+    const char* data = nullptr;
+    std::size_t size = 0;
+#if defined(_WIN32)
+    std::vector<char> buffer;
+#else
+    void* base = nullptr;
+    std::size_t mappedLength = 0;
+#endif
+};
+
+// The whole file mapped at once
+class MappedFile {
+public:
+    bool open(const std::string& path) {
+        int fd = openReadOnly(path);
+        if (fd < 0) return false;
+        std::int64_t length = fileSize(fd);
+        bool ok = length >= 0 && region.map(fd, 0, static_cast<std::size_t>(length));
+        closeFile(fd);   // the mapping stays valid after close
+        return ok;
+    }
+
+    std::string_view view() const { return region.view(); }
+    std::size_t size() const { return region.view().size(); }
+
+private:
+    MappedRegion region;
+};
+
+// Cuts text into roughly equal pieces that each end on a newline, so every piece
+// can be parsed by its own thread without seeing half a line
+inline std::vector<std::string_view> splitOnLineBoundaries(std::string_view text, std::size_t parts) {
+    std::vector<std::string_view> pieces;
+    if (parts == 0) parts = 1;
+    std::size_t start = 0;
+    for (std::size_t p = 1; p <= parts && start < text.size(); ++p) {
+        std::size_t end = p == parts ? text.size() : std::max(start, text.size() * p / parts);
+        if (end < text.size()) {
+            std::size_t newline = text.find('\n', end);
+            end = newline == std::string_view::npos ? text.size() : newline + 1;
+        }
+        if (end > start) pieces.push_back(text.substr(start, end - start));
+        start = end;
+    }
+    return pieces;
+}
+
+// A header line like "id,age,citizen" or "id,brand,model,year" is skipped when the file does
+// not start with a digit
+inline std::string_view skipHeader(std::string_view text) {
+    if (text.empty() || (text[0] >= '0' && text[0] <= '9')) return text;
+    std::size_t newline = text.find('\n');
+    return newline == std::string_view::npos ? std::string_view() : text.substr(newline + 1);
+}
+
+#endif //EMPLOYEE_VALIDATION_C_MAPPEDFILE_H
@@ -1,64 +1,404 @@
 #include <iostream>
 #include <thread>
-#include <map>
 #include <string>
 #include <chrono>
 #include <mutex>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
 
-// Global mutex for thread-safe printing
-std::mutex coutMutex;
+#include "forecastStore.h"
+#include "forecastHistory.h"
+#include "forecastSubscriptions.h"
+#include "forecastIngest.h"
+#include "instrumentation.h"
+#include "timestampService.h"
+
+// Global mutex for thread-safe printing (records how long threads wait for it)
+InstrumentedMutex coutMutex("coutMutex");
+
+// cached per second clock, same one the printed timestamps come from
+std::int64_t nowSeconds() {
+    return TimestampService::instance().seconds();
+}
 
 // Background thread function
-void refreshForecast(std::map<std::string, int>& forecastMap) {
+// One refresh cycle: pull new readings (or simulate them), record history, publish and print changes
+void refreshOnce(ForecastStore& forecast, ForecastHistory& history, ForecastChangeFeed& feed,
+                 FeedTailer* feedFile, SubscriberId printer, ForecastStore::FloatArray& deltas,
+                 std::vector<StationReading>& batch, std::size_t& cycle) {
+    EV_SPAN("refresh cycle");
+    std::int64_t now = nowSeconds();
+    if (feedFile != nullptr) {
+        // everything the provider appended since the last cycle, applied as one batch
+        EV_SPAN("ingest batch");
+        batch.clear();
+        if (!feedFile->poll(forecast, now, batch)) {
+            std::lock_guard<InstrumentedMutex> lock(coutMutex);
+            std::cout << "Cannot read forecast feed file.\n";
+        }
+        applyReadings(forecast, batch);
+        for (const StationReading& reading : batch) {
+            history.record(reading.station, reading.timestamp, reading.temperature);
+        }
+    }
+    else if (!deltas.empty()) {
+        // Simulate temperature changes - one city moves per cycle, applied in one vectorized pass
+        std::fill(deltas.begin(), deltas.end(), 0.0f);
+        deltas[cycle++ % deltas.size()] = 1.0f;
+        forecast.applyDeltas(deltas);
+        history.recordAll(now, forecast.data(), forecast.size());
+    }
+    feed.publish(forecast.data(), forecast.size());
+
+    // Thread-safe printing - only the cities that changed since the last print
+    ForecastChangeSet changes = feed.poll(printer);
+    if (!changes.changes.empty()) {
+        EV_SPAN("print");
+        std::lock_guard<InstrumentedMutex> lock(coutMutex);
+        std::cout << "\nUpdated Forecast (" << currentTimestamp() << "):\n";
+        for (const ForecastChange& change : changes.changes) {
+            StationId id = change.station;
+            HistorySummary day = history.summarize(id, now - 24 * 3600, now);
+            std::cout << "  " << forecast.name(id) << ": "
+                      << forecast.temperature(id) << "°C"
+                      << " (last 24h min " << day.min << " / max " << day.max
+                      << " / avg " << day.average() << ")\n";
+        }
+        std::cout << "--------------------------\n";
+    }
+}
+
+// feedFile == nullptr keeps the synthetic demo updates
+void refreshForecast(ForecastStore& forecast, ForecastHistory& history, ForecastChangeFeed& feed,
+                     FeedTailer* feedFile) {
     using namespace std::chrono_literals;
+    nameThread("refresher");
+
+    // the printer is just another subscriber that wants every station
+    SubscriberId printer = feed.subscribe([](StationId, float) { return true; });
+    ForecastStore::FloatArray deltas(forecast.size(), 0.0f);
+    std::vector<StationReading> batch;
+    std::size_t cycle = 0;
 
     while (true) {
-        // Simulate temperature changes
-        for (auto& item : forecastMap) {
-            item.second += 1;   // simple increment for demo
+        refreshOnce(forecast, history, feed, feedFile, printer, deltas, batch, cycle);
+        std::this_thread::sleep_for(2s);
+    }
+}
+
+// times one kernel call in milliseconds (best of a few runs so page faults don't count)
+template <typename Fn>
+double timeKernelMs(Fn&& fn) {
+    double best = 1e30;
+    for (int run = 0; run < 5; ++run) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+// --bench [stations] - one refresh cycle of each kernel, scalar vs AVX2
+int runBenchmark(std::size_t stations) {
+    ForecastStore::FloatArray temps(stations), deltas(stations), readings(stations);
+    for (std::size_t i = 0; i < stations; ++i) {
+        temps[i] = static_cast<float>(i % 60) - 20.0f;
+        deltas[i] = static_cast<float>(i % 7) * 0.25f - 0.75f;
+        readings[i] = static_cast<float>(i % 45) - 10.0f;
+    }
+
+    std::cout << "Stations: " << stations << " | AVX2: " << (cpuHasAvx2() ? "yes" : "no") << "\n";
+
+    auto report = [](const char* kernel, double scalarMs, double fastMs) {
+        std::cout << "  " << kernel << ": scalar " << scalarMs << " ms | dispatched " << fastMs
+                  << " ms | speedup " << scalarMs / fastMs << "x\n";
+    };
+
+    float* t = temps.data();
+    report("add delta    ",
+           timeKernelMs([&] { addDeltaScalar(t, stations, 1.0f); }),
+           timeKernelMs([&] { addDelta(t, stations, 1.0f); }));
+    report("apply deltas ",
+           timeKernelMs([&] { applyDeltasScalar(t, deltas.data(), stations); }),
+           timeKernelMs([&] { applyDeltas(t, deltas.data(), stations); }));
+    report("clamp        ",
+           timeKernelMs([&] { clampScalar(t, stations, -50.0f, 60.0f); }),
+           timeKernelMs([&] { clampTemperatures(t, stations, -50.0f, 60.0f); }));
+    report("blend        ",
+           timeKernelMs([&] { blendScalar(t, readings.data(), stations, 0.3f); }),
+           timeKernelMs([&] { blendReadings(t, readings.data(), stations, 0.3f); }));
+
+    // keeps the compiler from dropping the work
+    std::cout << "  checksum: " << temps[stations / 2] << "\n";
+    return 0;
+}
+
+// --history-bench [stations] [samples] - fills every station's history, then reports
+// compression and how long typical range queries take
+int runHistoryBenchmark(std::size_t stations, std::size_t samples) {
+    const std::int64_t start = 1700000000;
+    const std::int64_t step = 60;   // one reading per minute
+    ForecastHistory history(128, (samples + 127) / 128);
+    history.resize(stations);
+
+    for (std::size_t s = 0; s < samples; ++s) {
+        std::int64_t timestamp = start + static_cast<std::int64_t>(s) * step + (s % 10 == 0 ? 1 : 0);
+        for (std::size_t id = 0; id < stations; ++id) {
+            // readings quantized to 0.5 degrees drifting slowly, like a real sensor feed
+            float value = static_cast<float>(static_cast<int>((id % 40) + (s / 30) % 12)) * 0.5f;
+            history.record(static_cast<StationId>(id), timestamp, value);
         }
+    }
 
-        // Thread-safe printing
-        {
-            std::lock_guard<std::mutex> lock(coutMutex);
-            std::cout << "\nUpdated Forecast:\n";
-            for (const auto& item : forecastMap) {
-                std::cout << "  " << item.first << ": "
-                          << item.second << "°C\n";
-            }
-            std::cout << "--------------------------\n";
+    std::size_t total = history.sampleCount();
+    std::size_t bytes = history.encodedBytes();
+    std::cout << "Stations: " << stations << " | samples per station: " << samples << "\n";
+    std::cout << "  stored samples: " << total << " | encoded bytes: " << bytes
+              << " | bytes per sample: " << static_cast<double>(bytes) / static_cast<double>(total)
+              << " (raw " << sizeof(std::int64_t) + sizeof(float) << ")\n";
+
+    const std::int64_t end = start + static_cast<std::int64_t>(samples) * step;
+    const std::int64_t dayStart = end - 24 * 3600;
+    const int queries = 1000;
+    double checksum = 0.0;
+
+    auto timeQueries = [&](const char* label, auto&& query) {
+        auto begin = std::chrono::steady_clock::now();
+        for (int q = 0; q < queries; ++q) {
+            checksum += query(static_cast<StationId>((static_cast<std::size_t>(q) * 7919) % stations));
         }
+        auto finish = std::chrono::steady_clock::now();
+        std::cout << "  " << label << ": "
+                  << std::chrono::duration<double, std::micro>(finish - begin).count() / queries << " us/query\n";
+    };
 
-        std::this_thread::sleep_for(2s);
+    timeQueries("last 24h min/max/avg   ", [&](StationId id) { return history.summarize(id, dayStart, end).average(); });
+    timeQueries("last 24h raw samples   ", [&](StationId id) { return static_cast<double>(history.range(id, dayStart, end).size()); });
+    timeQueries("last 24h hourly buckets", [&](StationId id) { return static_cast<double>(history.downsample(id, dayStart, end, 3600).size()); });
+    timeQueries("full history min/max   ", [&](StationId id) { return static_cast<double>(history.summarize(id, start, end).max); });
+    std::cout << "  checksum: " << checksum << "\n";
+    return 0;
+}
+
+// --feed-bench [stations] [subscribers] - sparse updates fanned out to many small subscribers,
+// compared with reprinting every station each cycle
+int runFeedBenchmark(std::size_t stations, std::size_t subscriberCount) {
+    ForecastStore::FloatArray temps(stations, 20.0f);
+    ForecastChangeFeed feed;
+    feed.publish(temps.data(), stations);
+
+    std::vector<SubscriberId> subscribers;
+    subscribers.reserve(subscriberCount + 1);
+    for (std::size_t s = 0; s < subscriberCount; ++s) {
+        // each consumer watches three stations
+        subscribers.push_back(feed.subscribe(std::vector<StationId>{
+            static_cast<StationId>((s * 7919) % stations),
+            static_cast<StationId>((s * 104729 + 1) % stations),
+            static_cast<StationId>((s * 15485863 + 2) % stations)}));
+    }
+    subscribers.push_back(feed.subscribe([](StationId, float t) { return t > 40.0f; }));
+
+    const int cycles = 20;
+    const std::size_t changedPerCycle = std::max<std::size_t>(1, stations / 100);
+    double publishMs = 0.0, pollMs = 0.0, reprintMs = 0.0;
+    std::size_t delivered = 0;
+    std::string reprint;
+
+    for (int cycle = 0; cycle < cycles; ++cycle) {
+        for (std::size_t i = 0; i < changedPerCycle; ++i) {
+            temps[(i * 2654435761u + static_cast<std::size_t>(cycle)) % stations] += 1.0f;
+        }
+
+        auto t0 = std::chrono::steady_clock::now();
+        feed.publish(temps.data(), stations);
+        auto t1 = std::chrono::steady_clock::now();
+        for (SubscriberId id : subscribers) delivered += feed.poll(id).changes.size();
+        auto t2 = std::chrono::steady_clock::now();
+
+        // what the old refresher did: format every station every cycle
+        reprint.clear();
+        for (std::size_t i = 0; i < stations; ++i) {
+            reprint += std::to_string(i);
+            reprint += ": ";
+            reprint += std::to_string(temps[i]);
+            reprint += '\n';
+        }
+        auto t3 = std::chrono::steady_clock::now();
+
+        publishMs += std::chrono::duration<double, std::milli>(t1 - t0).count();
+        pollMs += std::chrono::duration<double, std::milli>(t2 - t1).count();
+        reprintMs += std::chrono::duration<double, std::milli>(t3 - t2).count();
     }
+
+    std::cout << "Stations: " << stations << " | subscribers: " << subscribers.size()
+              << " | changed per cycle: " << changedPerCycle << "\n";
+    std::cout << "  publish (diff + journal): " << publishMs / cycles << " ms/cycle\n";
+    std::cout << "  poll all subscribers    : " << pollMs / cycles << " ms/cycle\n";
+    std::cout << "  full reprint            : " << reprintMs / cycles << " ms/cycle\n";
+    std::cout << "  changes delivered       : " << delivered << "\n";
+    return 0;
 }
 
-int main() {
-    // Initial dummy weather data
-    std::map<std::string, int> forecastMap = {
-        {"New York", 15},
-        {"Mumbai",   28},
-        {"Berlin",   18}
-    };
+// --ingest-bench [readings] [stations] - writes a feed file, then measures how fast the
+// tailer parses and applies it, both in one go and as a stream of appends
+int runIngestBenchmark(std::size_t readings, std::size_t stations) {
+    const std::string path = "ingest_bench_feed.csv";
+    const std::size_t appends = 10;
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        std::string line;
+        for (std::size_t i = 0; i < readings; ++i) {
+            line = "Station-";
+            line += std::to_string(i % stations);
+            line += ',';
+            line += std::to_string(static_cast<int>(i % 80) - 30);
+            line += '.';
+            line += static_cast<char>('0' + i % 10);
+            line += ',';
+            line += std::to_string(1700000000 + static_cast<long long>(i / stations) * 60);
+            line += '\n';
+            out << line;
+        }
+    }
 
-    // Start background thread (pass map by reference)
-    std::thread bgWorker(refreshForecast, std::ref(forecastMap));
+    ForecastStore store;
+    store.reserve(stations);
+    std::vector<StationReading> batch;
+    batch.reserve(readings);
+
+    auto start = std::chrono::steady_clock::now();
+    FeedTailer tailer(path);
+    tailer.poll(store, 0, batch);
+    applyReadings(store, batch);
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << "Readings: " << readings << " | stations: " << store.size() << "\n";
+    std::cout << "  whole file : " << seconds * 1000.0 << " ms | "
+              << static_cast<double>(batch.size()) / seconds / 1e6 << " M readings/s\n";
+
+    // streaming: the provider appends in pieces and we poll after each piece
+    std::ifstream source(path, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(source)), std::istreambuf_iterator<char>());
+    const std::string streamPath = "ingest_bench_stream.csv";
+    std::ofstream(streamPath, std::ios::binary | std::ios::trunc).close();
+    FeedTailer streamTailer(streamPath);
+    std::size_t applied = 0;
+    double streamSeconds = 0.0;
+    for (std::size_t part = 0; part < appends; ++part) {
+        std::size_t from = content.size() * part / appends;
+        std::size_t to = content.size() * (part + 1) / appends;
+        {
+            std::ofstream out(streamPath, std::ios::binary | std::ios::app);
+            out.write(content.data() + from, static_cast<std::streamsize>(to - from));
+        }
+        auto t0 = std::chrono::steady_clock::now();
+        batch.clear();
+        streamTailer.poll(store, 0, batch);
+        applyReadings(store, batch);
+        streamSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        applied += batch.size();
+    }
+    std::cout << "  streaming  : " << appends << " appends, " << applied << " readings | "
+              << static_cast<double>(applied) / streamSeconds / 1e6 << " M readings/s"
+              << " | rejected lines: " << streamTailer.rejected() << "\n";
+
+    std::remove(path.c_str());
+    std::remove(streamPath.c_str());
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::strcmp(argv[1], "--bench") == 0) {
+        std::size_t stations = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 4000000;
+        return runBenchmark(stations);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--history-bench") == 0) {
+        std::size_t stations = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000;
+        std::size_t samples = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 7 * 24 * 60;
+        if (stations == 0) {
+            std::cout << "--history-bench needs at least one station\n";
+            return 1;
+        }
+        return runHistoryBenchmark(stations, samples);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--feed-bench") == 0) {
+        std::size_t stations = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000000;
+        std::size_t subscribers = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 10000;
+        if (stations == 0) {
+            std::cout << "--feed-bench needs at least one station\n";
+            return 1;
+        }
+        return runFeedBenchmark(stations, subscribers);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--ingest-bench") == 0) {
+        std::size_t readings = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5000000;
+        std::size_t stations = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 10000;
+        return runIngestBenchmark(readings, std::max<std::size_t>(1, stations));
+    }
+
+    // --feed <file> reads the forecast from a provider feed file instead of the dummy data
+    // --metrics <file> rewrites a JSON latency/contention report there every few seconds
+    std::unique_ptr<FeedTailer> feedFile;
+    std::string metricsPath;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--feed") == 0) feedFile = std::make_unique<FeedTailer>(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--metrics") == 0) metricsPath = argv[i + 1];
+    }
+    nameThread("main");
+    std::unique_ptr<PeriodicReporter> metricsReporter;
+    if (!metricsPath.empty()) {
+        metricsReporter = std::make_unique<PeriodicReporter>(std::chrono::seconds(5), [metricsPath] {
+            std::ofstream(metricsPath, std::ios::trunc) << instrumentationJsonReport() << "\n";
+        });
+    }
+
+    ForecastStore forecast;
+    if (!feedFile) {
+        // Initial dummy weather data
+        forecast.addStation("New York", 15);
+        forecast.addStation("Mumbai",   28);
+        forecast.addStation("Berlin",   18);
+    }
+
+    ForecastHistory history;
+    ForecastChangeFeed feed;
+
+    // main thread only cares about Berlin (when it is known up front)
+    std::vector<StationId> watched;
+    StationId berlin;
+    if (forecast.findStation("Berlin", berlin)) watched.push_back(berlin);
+    SubscriberId berlinWatcher = feed.subscribe(watched);
+
+    // Start background thread (pass store by reference)
+    std::thread bgWorker(refreshForecast, std::ref(forecast), std::ref(history), std::ref(feed), feedFile.get());
 
     // Main thread doing other work
     for (int i = 0; i < 5; ++i) {
+        ForecastChangeSet berlinChanges = feed.poll(berlinWatcher);
         {
-            std::lock_guard<std::mutex> lock(coutMutex);
+            EV_SPAN("print");
+            std::lock_guard<InstrumentedMutex> lock(coutMutex);
             std::cout << "Main thread working... (" << i + 1 << ")\n";
+            for (const ForecastChange& change : berlinChanges.changes) {
+                std::cout << "Main thread saw Berlin change to " << change.temperature << "°C\n";
+            }
         }
         std::this_thread::sleep_for(std::chrono::seconds(3));
     }
 
     // Let background thread run independently
     bgWorker.detach();
+    feedFile.release();   // the detached thread keeps using it
 
     {
-        std::lock_guard<std::mutex> lock(coutMutex);
+        std::lock_guard<InstrumentedMutex> lock(coutMutex);
         std::cout << "Main thread finished.\n";
+        std::cout << instrumentationTextReport();
     }
 
     return 0;
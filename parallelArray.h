@@ -0,0 +1,174 @@
+//
+// Span based array processing: map, reduce, inclusive prefix sum and filter, split across
+// threads for large inputs, plus chunked, buffered printing of whole arrays.
+//
+// Each thread gets one contiguous partition. Partition boundaries fall on 64 byte cache line
+// boundaries of the array being written, so two threads never write the same line. Inputs
+// below kMinPartition elements per thread are done on the calling thread - starting threads
+// costs more than the work.
+//
+
+#ifndef EMPLOYEE_VALIDATION_C_PARALLELARRAY_H
+#define EMPLOYEE_VALIDATION_C_PARALLELARRAY_H
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+inline constexpr std::size_t kCacheLine = 64;
+inline constexpr std::size_t kMinPartition = 1 << 15;
+
+inline unsigned defaultThreads() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// [begin, end) ranges over n elements of elementSize bytes starting at base, every inner
+// boundary on a cache line boundary of base's memory
+inline std::vector<std::pair<std::size_t, std::size_t>> cacheAlignedPartitions(std::size_t n, std::size_t elementSize,
+                                                                                const void* base, unsigned threads) {
+    std::vector<std::pair<std::size_t, std::size_t>> parts;
+    std::size_t count = std::max<std::size_t>(1, std::min<std::size_t>(threads, n / kMinPartition));
+    const std::size_t address = reinterpret_cast<std::uintptr_t>(base);
+    std::size_t begin = 0;
+    for (std::size_t p = 1; p <= count; ++p) {
+        std::size_t end = n;
+        if (p < count && elementSize <= kCacheLine && kCacheLine % elementSize == 0) {
+            std::size_t split = n / count * p;
+            std::size_t misalignment = (address + split * elementSize) % kCacheLine;
+            end = split + (misalignment == 0 ? 0 : (kCacheLine - misalignment) / elementSize);
+        }
+        else if (p < count) {
+            end = n / count * p;
+        }
+        end = std::min(std::max(end, begin), n);
+        parts.emplace_back(begin, end);
+        begin = end;
+    }
+    return parts;
+}
+
+// fn(partition index, begin, end) for every partition, the first one on the calling thread
+template <typename Fn>
+void forEachPartition(const std::vector<std::pair<std::size_t, std::size_t>>& parts, Fn&& fn) {
+    std::vector<std::thread> pool;
+    for (std::size_t p = 1; p < parts.size(); ++p) {
+        pool.emplace_back([&, p] { fn(p, parts[p].first, parts[p].second); });
+    }
+    if (!parts.empty()) fn(0, parts[0].first, parts[0].second);
+    for (auto& thread : pool) thread.join();
+}
+
+// out[i] = fn(in[i]) (spans trimmed to the shorter)
+template <typename T, typename U, typename Fn>
+void parallelMap(std::span<const T> in, std::span<U> out, Fn fn, unsigned threads = defaultThreads()) {
+    const std::size_t n = std::min(in.size(), out.size());
+    const T* source = in.data();
+    U* target = out.data();
+    forEachPartition(cacheAlignedPartitions(n, sizeof(U), target, threads), [&](std::size_t, std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) target[i] = fn(source[i]);
+    });
+}
+
+// init op in[0] op in[1] op ... - the same value as a left fold from init. op must be
+// associative and accept (R, T) and (R, R); it needs no identity element, because every
+// partition starts from its own first element and the partials are folded into init in
+// partition order.
+template <typename T, typename R, typename Op>
+R parallelReduce(std::span<const T> in, R init, Op op, unsigned threads = defaultThreads()) {
+    auto parts = cacheAlignedPartitions(in.size(), sizeof(T), in.data(), threads);
+    std::vector<std::optional<R>> partial(parts.size());
+    const T* source = in.data();
+    forEachPartition(parts, [&](std::size_t p, std::size_t begin, std::size_t end) {
+        if (begin == end) return;
+        R sum = static_cast<R>(source[begin]);
+        for (std::size_t i = begin + 1; i < end; ++i) sum = op(sum, source[i]);
+        partial[p] = std::move(sum);
+    });
+    for (std::optional<R>& sum : partial) {
+        if (sum) init = op(init, std::move(*sum));
+    }
+    return init;
+}
+
+// out[i] = in[0] + ... + in[i]. Two passes: partition totals in parallel, then every partition
+// scans again starting from the sum of the partitions before it.
+template <typename T, typename U>
+void parallelInclusiveScan(std::span<const T> in, std::span<U> out, unsigned threads = defaultThreads()) {
+    const std::size_t n = std::min(in.size(), out.size());
+    auto parts = cacheAlignedPartitions(n, sizeof(U), out.data(), threads);
+    const T* source = in.data();
+    U* target = out.data();
+    std::vector<U> offsets(parts.size(), U{});
+    if (parts.size() > 1) {
+        forEachPartition(parts, [&](std::size_t p, std::size_t begin, std::size_t end) {
+            U sum{};
+            for (std::size_t i = begin; i < end; ++i) sum += source[i];
+            offsets[p] = sum;
+        });
+        U running{};
+        for (U& offset : offsets) {
+            U total = offset;
+            offset = running;
+            running += total;
+        }
+    }
+    forEachPartition(parts, [&](std::size_t p, std::size_t begin, std::size_t end) {
+        U sum = offsets[p];
+        for (std::size_t i = begin; i < end; ++i) target[i] = sum += source[i];
+    });
+}
+
+// The elements for which keep(element) is true, in their original order. Every partition
+// counts its matches, then copies them to its own offset in the result.
+template <typename T, typename Pred>
+std::vector<T> parallelFilter(std::span<const T> in, Pred keep, unsigned threads = defaultThreads()) {
+    auto parts = cacheAlignedPartitions(in.size(), sizeof(T), in.data(), threads);
+    const T* source = in.data();
+    std::vector<std::size_t> offsets(parts.size() + 1, 0);
+    forEachPartition(parts, [&](std::size_t p, std::size_t begin, std::size_t end) {
+        std::size_t kept = 0;
+        for (std::size_t i = begin; i < end; ++i) kept += keep(source[i]) ? 1 : 0;
+        offsets[p + 1] = kept;
+    });
+    for (std::size_t p = 1; p < offsets.size(); ++p) offsets[p] += offsets[p - 1];
+    std::vector<T> result(offsets.back());
+    T* target = result.data();
+    forEachPartition(parts, [&](std::size_t p, std::size_t begin, std::size_t end) {
+        T* cursor = target + offsets[p];
+        for (std::size_t i = begin; i < end; ++i) {
+            if (keep(source[i])) *cursor++ = source[i];
+        }
+    });
+    return result;
+}
+
+// One element per line, formatted into a buffer that is written every 64 KB
+template <typename T>
+void printArray(std::ostream& out, std::span<const T> values) {
+    static_assert(std::is_arithmetic_v<T>, "printArray formats numbers");
+    constexpr std::size_t kChunk = 64 * 1024;
+    std::string buffer;
+    buffer.reserve(kChunk + 64);
+    char digits[64];
+    for (const T& value : values) {
+        auto written = std::to_chars(digits, digits + sizeof(digits), value);
+        buffer.append(digits, written.ptr);
+        buffer += '\n';
+        if (buffer.size() >= kChunk) {
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    }
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+}
+
+#endif //EMPLOYEE_VALIDATION_C_PARALLELARRAY_H
@@ -1,19 +1,104 @@
 #include <iostream>
+#include <span>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
 
-void myFunctionArray(int myArray[5]) {
+#include "parallelArray.h"
+
+// std::span keeps the length that int myArray[5] lost when it decayed to a pointer,
+// so the range-for works; the whole array goes out in one buffered write
+void myFunctionArray(std::span<const int> myArray) {
     // for (int i = 0; i < 5; i++) {
     //     std::cout << myArray[i] << "\n";
-    for (int num: myArray) {
-        std::cout << num << "\n";
-    }
+    printArray(std::cout, myArray);
+
+}
+
+// bytes of memory not in use right now, 0 when unknown
+std::size_t availableMemory() {
+#if defined(_SC_AVPHYS_PAGES) && defined(_SC_PAGESIZE)
+    long pages = ::sysconf(_SC_AVPHYS_PAGES);
+    long pageSize = ::sysconf(_SC_PAGESIZE);
+    if (pages > 0 && pageSize > 0) return static_cast<std::size_t>(pages) * static_cast<std::size_t>(pageSize);
+#endif
+    return 0;
+}
+
+// --array-bench [max elements] [threads] - map / reduce / prefix sum / filter from 1K elements
+// up by 10x, one thread against the pool. Sizes that do not fit in free memory are skipped.
+int runArrayBenchmark(std::size_t maxElements, unsigned threads) {
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::time_point a, Clock::time_point b) { return std::chrono::duration<double, std::milli>(b - a).count(); };
+    std::cout << "ms with 1 thread / with " << threads << " threads\n";
+    for (std::size_t n = 1000; n <= maxElements; n *= 10) {
+        const std::size_t needed = n * (sizeof(int) + sizeof(long long));
+        const std::size_t available = availableMemory();
+        if (available != 0 && needed > available / 10 * 9) {
+            std::cout << n << ": skipped, needs " << needed / (1024 * 1024) << " MB and "
+                      << available / (1024 * 1024) << " MB are free\n";
+            continue;
+        }
+        try {
+            std::vector<int> values(n);
+            std::vector<long long> results(n);
+            for (std::size_t i = 0; i < n; ++i) values[i] = static_cast<int>((i * 2654435761u) % 1000);
+            std::span<const int> in(values);
+            std::span<long long> out(results);
 
+            double timings[4][2];
+            long long checks[4][2];
+            for (int pass = 0; pass < 2; ++pass) {
+                unsigned use = pass == 0 ? 1 : threads;
+                auto t0 = Clock::now();
+                parallelMap(in, out, [](int v) { return static_cast<long long>(v) * 3 + 1; }, use);
+                auto t1 = Clock::now();
+                checks[0][pass] = out[n - 1];
+                long long sum = parallelReduce(in, 0LL, [](long long a, long long b) { return a + b; }, use);
+                auto t2 = Clock::now();
+                checks[1][pass] = sum;
+                parallelInclusiveScan(in, out, use);
+                auto t3 = Clock::now();
+                checks[2][pass] = out[n - 1];
+                std::vector<int> kept = parallelFilter(in, [](int v) { return v < 100; }, use);
+                auto t4 = Clock::now();
+                checks[3][pass] = static_cast<long long>(kept.size());
+                timings[0][pass] = ms(t0, t1);
+                timings[1][pass] = ms(t1, t2);
+                timings[2][pass] = ms(t2, t3);
+                timings[3][pass] = ms(t3, t4);
+            }
+            bool same = checks[1][1] == checks[2][1];   // the prefix sum ends at the total
+            static const char* names[] = {"map", "reduce", "scan", "filter"};
+            std::cout << n << ":";
+            for (int op = 0; op < 4; ++op) {
+                same = same && checks[op][0] == checks[op][1];
+                std::cout << " " << names[op] << " " << timings[op][0] << " / " << timings[op][1];
+            }
+            std::cout << (same ? "" : " | MISMATCH") << "\n";
+        }
+        catch (const std::bad_alloc&) {
+            std::cout << n << ": skipped, out of memory\n";
+        }
+        if (n > maxElements / 10) break;
+    }
+    return 0;
 }
 
-int main () {
+int main (int argc, char* argv[]) {
+    if (argc > 1 && std::strcmp(argv[1], "--array-bench") == 0) {
+        return runArrayBenchmark(argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000000000,
+                                 argc > 3 ? static_cast<unsigned>(std::strtoul(argv[3], nullptr, 10)) : defaultThreads());
+    }
 
     int myArray[5] = {1, 2, 3, 4, 5};
     myFunctionArray(myArray);
 
     return 0;
 
-}
\ No newline at end of file
+}
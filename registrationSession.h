@@ -0,0 +1,195 @@
+//
+// The registration dialog (ID -> name -> department -> salary, each asked again until it is
+// valid) as a C++20 coroutine, so a session is a suspended coroutine frame of a few hundred
+// bytes rather than a thread blocked in std::cin.
+//
+// A session reads its answers from a SessionInput. Whoever owns the input - the console loop,
+// a socket connection, a replayed script - feed()s it one line at a time; feed() resumes the
+// session on the calling thread, which runs it up to its next question (written to the
+// session's output string) and returns. Many sessions can therefore share one thread, and
+// sessions only meet at the registry lock when they register.
+//
+// A session and its input belong to one thread at a time: feed() and close() must not be
+// called concurrently for the same session.
+//
+// An exception thrown inside the dialog (say std::bad_alloc while registering) does not leave
+// feed(): it ends the session and is kept in failure(), for the owner to report and drop it.
+//
+
+#ifndef EMPLOYEE_VALIDATION_C_REGISTRATIONSESSION_H
+#define EMPLOYEE_VALIDATION_C_REGISTRATIONSESSION_H
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "employee.h"
+
+// The lines one session reads, one at a time
+class SessionInput {
+public:
+    struct LineAwaiter {
+        SessionInput& input;
+
+        bool await_ready() const noexcept { return input.hasLine || input.closed; }
+        void await_suspend(std::coroutine_handle<> session) noexcept { input.waiting = session; }
+
+        // the line (valid until the next co_await), nothing once the input is closed
+        std::optional<std::string_view> await_resume() noexcept {
+            if (!input.hasLine) return std::nullopt;
+            input.hasLine = false;
+            return std::string_view(input.line);
+        }
+    };
+
+    LineAwaiter nextLine() { return LineAwaiter{*this}; }
+
+    // hands the session its next line and runs it until it asks for another one; false when the
+    // session is not waiting for input (finished, or not started)
+    bool feed(std::string_view text) {
+        if (!waiting || closed) return false;
+        line.assign(text);
+        hasLine = true;
+        std::exchange(waiting, {}).resume();
+        return true;
+    }
+
+    // end of input: a waiting session gives up
+    void close() {
+        closed = true;
+        if (waiting) std::exchange(waiting, {}).resume();
+    }
+
+private:
+    std::coroutine_handle<> waiting;
+    std::string line;
+    bool hasLine = false;
+    bool closed = false;
+};
+
+// Owner of one running registration coroutine
+class RegistrationSession {
+public:
+    struct promise_type {
+        RegistrationSession get_return_object() {
+            return RegistrationSession(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_never initial_suspend() noexcept { return {}; }   // asks for the ID right away
+        std::suspend_always final_suspend() noexcept { return {}; }    // the owner destroys the frame
+        void return_void() {}
+        void unhandled_exception() { failure = std::current_exception(); }   // the session ends
+
+        // every frame allocation is counted, so the benchmark can show what a session costs
+        static void* operator new(std::size_t size) {
+            frameBytes.store(size, std::memory_order_relaxed);
+            return ::operator new(size);
+        }
+        static void operator delete(void* frame, std::size_t size) { ::operator delete(frame, size); }
+
+        static inline std::atomic<std::size_t> frameBytes{0};
+
+        std::exception_ptr failure;
+    };
+
+    RegistrationSession() = default;
+    RegistrationSession(const RegistrationSession&) = delete;
+    RegistrationSession& operator=(const RegistrationSession&) = delete;
+    RegistrationSession(RegistrationSession&& other) noexcept : frame(std::exchange(other.frame, {})) {}
+    RegistrationSession& operator=(RegistrationSession&& other) noexcept {
+        if (frame) frame.destroy();
+        frame = std::exchange(other.frame, {});
+        return *this;
+    }
+    ~RegistrationSession() {
+        if (frame) frame.destroy();
+    }
+
+    bool active() const { return frame && !frame.done(); }
+
+    // what ended the session with an exception, null while it runs or once it ended normally
+    std::exception_ptr failure() const { return frame ? frame.promise().failure : nullptr; }
+
+    // size of the last coroutine frame allocated
+    static std::size_t frameSize() { return promise_type::frameBytes.load(std::memory_order_relaxed); }
+
+private:
+    explicit RegistrationSession(std::coroutine_handle<promise_type> handle) : frame(handle) {}
+
+    std::coroutine_handle<promise_type> frame;
+};
+
+inline std::string_view trimSpaces(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) text.remove_suffix(1);
+    return text;
+}
+
+// The dialog itself - same questions and messages as the console prompts. input and out must
+// outlive the session; it ends early, registering nothing, when input is closed.
+inline RegistrationSession registrationDialog(SessionInput& input, std::string& out, SharedRegistry& shared) {
+    Employee e{};
+    std::string error;
+
+    while (true) {
+        out += "Enter Employee ID: ";
+        std::optional<std::string_view> line = co_await input.nextLine();
+        if (!line) co_return;
+        if (parseEmployeeId(trimSpaces(*line), e.id, error)) break;
+        out += error;
+        out += '\n';
+    }
+    while (true) {
+        out += "Enter Employee Name: ";
+        std::optional<std::string_view> line = co_await input.nextLine();
+        if (!line) co_return;
+        if (checkEmployeeName(trimSpaces(*line), error)) {
+            e.name.assign(trimSpaces(*line));
+            break;
+        }
+        out += error;
+        out += '\n';
+    }
+    while (true) {
+        out += "Enter Department: ";
+        std::optional<std::string_view> line = co_await input.nextLine();
+        if (!line) co_return;
+        if (checkDepartment(trimSpaces(*line), error)) {
+            e.department.assign(trimSpaces(*line));
+            break;
+        }
+        out += error;
+        out += '\n';
+    }
+    while (true) {
+        out += "Enter Salary: ";
+        std::optional<std::string_view> line = co_await input.nextLine();
+        if (!line) co_return;
+        if (parseSalary(trimSpaces(*line), e.salary, error)) break;
+        out += error;
+        out += '\n';
+    }
+
+    const int id = e.id;
+    bool added;
+    {
+        std::unique_lock writer(shared.lock);
+        added = shared.employees.add(std::move(e));
+    }
+    if (added) {
+        out += " Employee registered successfully.\n";
+    }
+    else {
+        out += " Employee ID ";
+        out += std::to_string(id);
+        out += " is already registered.\n";
+    }
+}
+
+#endif //EMPLOYEE_VALIDATION_C_REGISTRATIONSESSION_H
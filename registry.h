@@ -0,0 +1,605 @@
+//
+// Registry<T>: a columnar record store generated from compile time field descriptors.
+//
+// A record type lists its fields once, in a RecordTraits specialization next to the struct:
+//
+//     template <> struct RecordTraits<Car> {
+//         static constexpr auto fields = std::make_tuple(field<FieldIndex::unique>("ID", &Car::id),
+//                                                        field("Brand", &Car::brand), ...);
+//     };
+//
+// and Registry<T> derives everything else from that tuple:
+//  - storage:   one std::vector per field, so a scan or a save touches only the columns it needs
+//  - indexes:   per field, unique (open addressing hash of rows), ordered (SortedIndex, int32 keys)
+//               or grouped (hash map of rows), looked up by member pointer: find<&Car::id>(7)
+//  - binary:    a header with the field labels and types, then every column as one block
+//  - printing:  "Label: value | ..." rows appended to one buffer and written in large chunks
+// All of it is expanded over index_sequences at compile time - nothing is looked up by name
+// while the program runs. Field types are integers, floating point numbers and std::string.
+// Not thread safe.
+//
+
+#ifndef EMPLOYEE_VALIDATION_C_REGISTRY_H
+#define EMPLOYEE_VALIDATION_C_REGISTRY_H
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "sortedIndex.h"
+
+enum class FieldIndex { none, unique, ordered, grouped };
+
+template <typename T, typename M, FieldIndex K>
+struct Field {
+    using Record = T;
+    using Type = M;
+    static constexpr FieldIndex index = K;
+
+    const char* label;
+    M T::*member;
+    const char* prefix;   // printed in front of the value, e.g. "$"
+};
+
+template <FieldIndex K = FieldIndex::none, typename T, typename M>
+constexpr Field<T, M, K> field(const char* label, M T::*member, const char* prefix = "") {
+    static_assert(std::is_arithmetic_v<M> || std::is_same_v<M, std::string>, "registry fields are numbers or strings");
+    // SortedIndex keys are int32: a uint32 value above INT32_MAX would sort below zero
+    static_assert(K != FieldIndex::ordered || (std::is_integral_v<M> && (std::is_signed_v<M> ? sizeof(M) <= 4 : sizeof(M) < 4)),
+                  "ordered fields need keys that fit in int32");
+    return Field<T, M, K>{label, member, prefix};
+}
+
+// specialized per record type with a static constexpr tuple of field(...) descriptors
+template <typename T> struct RecordTraits;
+
+template <typename T>
+inline constexpr std::size_t kFieldCount = std::tuple_size_v<std::remove_cvref_t<decltype(RecordTraits<T>::fields)>>;
+
+template <typename T, std::size_t I>
+using FieldAt = std::remove_cvref_t<decltype(std::get<I>(RecordTraits<T>::fields))>;
+
+// calls fn(std::integral_constant<std::size_t, I>) for every field, in order
+template <typename T, typename Fn>
+constexpr void forEachField(Fn&& fn) {
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+        (fn(std::integral_constant<std::size_t, I>{}), ...);
+    }(std::make_index_sequence<kFieldCount<T>>{});
+}
+
+template <typename T, auto Member, std::size_t I>
+constexpr bool isFieldMember() {
+    if constexpr (std::is_same_v<decltype(Member), decltype(FieldAt<T, I>::member)>) {
+        return std::get<I>(RecordTraits<T>::fields).member == Member;
+    }
+    else {
+        return false;
+    }
+}
+
+// position of the field described by a member pointer (kFieldCount<T> when there is none)
+template <typename T, auto Member>
+inline constexpr std::size_t kFieldOf = []<std::size_t... I>(std::index_sequence<I...>) {
+    std::size_t found = sizeof...(I);
+    ((isFieldMember<T, Member, I>() ? (found = I, 0) : 0), ...);
+    return found;
+}(std::make_index_sequence<kFieldCount<T>>{});
+
+// ---- formatting ----
+
+inline void appendFieldValue(std::string& out, const std::string& value) { out += value; }
+
+// numbers print like std::ostream's defaults (six significant digits for floating point)
+template <typename M>
+void appendFieldValue(std::string& out, M value) {
+    char digits[32];
+    std::to_chars_result written;
+    if constexpr (std::is_floating_point_v<M>) written = std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::general, 6);
+    else written = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, written.ptr);
+}
+
+// "Label: value | Label: value\n", with valueOf(integral_constant<I>) giving field I's value
+template <typename T, typename ValueOf>
+void appendFields(std::string& out, ValueOf&& valueOf) {
+    forEachField<T>([&](auto i) {
+        constexpr const auto& f = std::get<decltype(i)::value>(RecordTraits<T>::fields);
+        if (decltype(i)::value > 0) out += " | ";
+        out += f.label;
+        out += ": ";
+        out += f.prefix;
+        appendFieldValue(out, valueOf(i));
+    });
+    out += '\n';
+}
+
+template <typename T>
+void appendRecord(std::string& out, const T& record) {
+    appendFields<T>(out, [&](auto i) -> const auto& {
+        return record.*std::get<decltype(i)::value>(RecordTraits<T>::fields).member;
+    });
+}
+
+// one record on stdout, written in a single call
+template <typename T>
+void displayRecord(const T& record) {
+    std::string line;
+    appendRecord(line, record);
+    std::cout << line;
+}
+
+// ---- indexes ----
+
+struct NoIndex {};
+
+// open addressing hash of rows, keys compared against the column itself
+template <typename M>
+class UniqueIndex {
+public:
+    static constexpr std::uint32_t kNone = 0xFFFFFFFFu;
+
+    std::uint32_t find(const std::vector<M>& column, const M& key) const {
+        if (slots.empty()) return kNone;
+        std::size_t mask = slots.size() - 1;
+        for (std::size_t i = hashKey(key) & mask;; i = (i + 1) & mask) {
+            std::uint32_t row = slots[i];
+            if (row == kNone || column[row] == key) return row;
+        }
+    }
+
+    // the row must already be in the column, and its key not in the index
+    void insert(const std::vector<M>& column, std::uint32_t row) {
+        if (column.size() * 2 > slots.size()) rehash(column, slots.empty() ? 16 : slots.size() * 2);
+        else place(column, row);
+    }
+
+    void reserve(const std::vector<M>& column, std::size_t count) {
+        std::size_t capacity = 16;
+        while (capacity < count * 2) capacity *= 2;
+        if (capacity > slots.size()) rehash(column, capacity);
+    }
+
+private:
+    static std::size_t hashKey(const M& key) {
+        std::uint64_t h;
+        if constexpr (std::is_integral_v<M>) h = static_cast<std::uint64_t>(key);
+        else h = std::hash<M>{}(key);
+        return static_cast<std::size_t>((h * 0x9E3779B97F4A7C15ull) >> 32);
+    }
+
+    void place(const std::vector<M>& column, std::uint32_t row) {
+        std::size_t mask = slots.size() - 1;
+        std::size_t i = hashKey(column[row]) & mask;
+        while (slots[i] != kNone) i = (i + 1) & mask;
+        slots[i] = row;
+    }
+
+    void rehash(const std::vector<M>& column, std::size_t capacity) {
+        slots.assign(capacity, kNone);
+        for (std::uint32_t row = 0; row < column.size(); ++row) place(column, row);
+    }
+
+    std::vector<std::uint32_t> slots;
+};
+
+template <typename F>
+using IndexFor = std::conditional_t<F::index == FieldIndex::unique, UniqueIndex<typename F::Type>,
+                 std::conditional_t<F::index == FieldIndex::ordered, SortedIndex,
+                 std::conditional_t<F::index == FieldIndex::grouped,
+                                    std::unordered_map<typename F::Type, std::vector<std::uint32_t>>, NoIndex>>>;
+
+// ---- the registry ----
+
+template <typename T>
+class Registry {
+    static constexpr std::size_t kFields = kFieldCount<T>;
+
+    template <std::size_t I> using FieldType = typename FieldAt<T, I>::Type;
+    template <auto Member> using TypeOf = FieldType<kFieldOf<T, Member>>;
+
+    template <std::size_t... I>
+    static auto columnsOf(std::index_sequence<I...>) -> std::tuple<std::vector<FieldType<I>>...>;
+    template <std::size_t... I>
+    static auto indexesOf(std::index_sequence<I...>) -> std::tuple<IndexFor<FieldAt<T, I>>...>;
+
+public:
+    using Columns = decltype(columnsOf(std::make_index_sequence<kFields>{}));
+
+    static constexpr std::uint32_t npos = 0xFFFFFFFFu;
+
+    // false (and nothing stored) when a unique field's value is already taken
+    bool add(T record) {
+        bool taken = false;
+        forEachField<T>([&](auto i) {
+            constexpr std::size_t I = decltype(i)::value;
+            if constexpr (FieldAt<T, I>::index == FieldIndex::unique) {
+                taken = taken || std::get<I>(indexes).find(std::get<I>(columns), record.*member<I>()) != npos;
+            }
+        });
+        if (taken) return false;
+        const std::uint32_t row = static_cast<std::uint32_t>(count);
+        forEachField<T>([&](auto i) {
+            constexpr std::size_t I = decltype(i)::value;
+            std::get<I>(columns).push_back(std::move(record.*member<I>()));
+        });
+        ++count;
+        forEachField<T>([&](auto i) { indexRow<decltype(i)::value>(row); });
+        return true;
+    }
+
+    // Moves every record in, a column at a time once the unique fields have been checked, with
+    // capacity reserved once up front. Returns how many were rejected for a taken unique value.
+    std::size_t addAll(std::span<T> records) {
+        reserve(count + records.size());
+        std::vector<std::uint32_t> accepted;
+        accepted.reserve(records.size());
+        for (std::uint32_t r = 0; r < records.size(); ++r) {
+            T& record = records[r];
+            bool taken = false;
+            forEachField<T>([&](auto i) {
+                constexpr std::size_t I = decltype(i)::value;
+                if constexpr (FieldAt<T, I>::index == FieldIndex::unique) {
+                    taken = taken || std::get<I>(indexes).find(std::get<I>(columns), record.*member<I>()) != npos;
+                }
+            });
+            if (taken) continue;
+            const std::uint32_t row = static_cast<std::uint32_t>(count + accepted.size());
+            forEachField<T>([&](auto i) {
+                constexpr std::size_t I = decltype(i)::value;
+                if constexpr (FieldAt<T, I>::index == FieldIndex::unique) {
+                    std::get<I>(columns).push_back(std::move(record.*member<I>()));
+                    indexRow<I>(row);
+                }
+            });
+            accepted.push_back(r);
+        }
+        forEachField<T>([&](auto i) {
+            constexpr std::size_t I = decltype(i)::value;
+            if constexpr (FieldAt<T, I>::index != FieldIndex::unique) {
+                auto& values = std::get<I>(columns);
+                for (std::uint32_t r : accepted) values.push_back(std::move(records[r].*member<I>()));
+                for (std::size_t row = count; row < values.size(); ++row) indexRow<I>(static_cast<std::uint32_t>(row));
+            }
+        });
+        count += accepted.size();
+        return records.size() - accepted.size();
+    }
+
+    void reserve(std::size_t rows) {
+        forEachField<T>([&](auto i) {
+            constexpr std::size_t I = decltype(i)::value;
+            std::get<I>(columns).reserve(rows);
+            if constexpr (FieldAt<T, I>::index == FieldIndex::unique) std::get<I>(indexes).reserve(std::get<I>(columns), rows);
+        });
+    }
+
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    template <auto Member>
+    std::span<const TypeOf<Member>> column() const {
+        return std::get<checkedField<Member>()>(columns);
+    }
+
+    // the column of the I-th field, for code that walks the fields in order
+    template <std::size_t I>
+    std::span<const FieldType<I>> columnAt() const {
+        return std::get<I>(columns);
+    }
+
+    template <auto Member>
+    const TypeOf<Member>& value(std::uint32_t row) const {
+        return std::get<checkedField<Member>()>(columns)[row];
+    }
+
+    // the record at row, put back together from the columns
+    T at(std::uint32_t row) const {
+        T record{};
+        forEachField<T>([&](auto i) {
+            constexpr std::size_t I = decltype(i)::value;
+            record.*member<I>() = std::get<I>(columns)[row];
+        });
+        return record;
+    }
+
+    // row with this value of a unique field, or npos
+    template <auto Member>
+    std::uint32_t find(const TypeOf<Member>& key) const {
+        constexpr std::size_t I = checkedField<Member>();
+        static_assert(FieldAt<T, I>::index == FieldIndex::unique, "find needs a unique field");
+        return std::get<I>(indexes).find(std::get<I>(columns), key);
+    }
+
+    // rows with this value of a grouped field (empty when there are none)
+    template <auto Member>
+    const std::vector<std::uint32_t>& rowsWith(const TypeOf<Member>& key) const {
+        constexpr std::size_t I = checkedField<Member>();
+        static_assert(FieldAt<T, I>::index == FieldIndex::grouped, "rowsWith needs a grouped field");
+        static const std::vector<std::uint32_t> none;
+        auto found = std::get<I>(indexes).find(key);
+        return found == std::get<I>(indexes).end() ? none : found->second;
+    }
+
+    // calls fn(row) for every value of an ordered field in [low, high], in value order
+    template <auto Member, typename Fn>
+    void forEachInRange(std::int32_t low, std::int32_t high, Fn&& fn) {
+        constexpr std::size_t I = checkedField<Member>();
+        static_assert(FieldAt<T, I>::index == FieldIndex::ordered, "ranges need an ordered field");
+        std::get<I>(indexes).forEachInRange(low, high, fn);
+    }
+
+    template <auto Member>
+    std::size_t countInRange(std::int32_t low, std::int32_t high) {
+        constexpr std::size_t I = checkedField<Member>();
+        static_assert(FieldAt<T, I>::index == FieldIndex::ordered, "ranges need an ordered field");
+        return std::get<I>(indexes).countInRange(low, high);
+    }
+
+    void appendRow(std::string& out, std::uint32_t row) const {
+        appendFields<T>(out, [&](auto i) -> const auto& { return std::get<decltype(i)::value>(columns)[row]; });
+    }
+
+    // every row (or the given ones), formatted into a buffer that is flushed every 64 KB
+    void print(std::ostream& os) const {
+        std::string buffer;
+        for (std::uint32_t row = 0; row < count; ++row) appendBuffered(os, buffer, row);
+        os.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    }
+
+    void print(std::ostream& os, std::span<const std::uint32_t> rows) const {
+        std::string buffer;
+        for (std::uint32_t row : rows) appendBuffered(os, buffer, row);
+        os.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    }
+
+    // Binary layout (host byte order): "EVRG", version, field count, row count, then per field
+    // its label, kind (0 integer, 1 floating point, 2 string) and byte width; after the header
+    // every column in field order - numbers as one array, strings as a uint32 length array
+    // followed by all the bytes.
+    void serialize(std::string& out) const {
+        out.append(kMagic, 4);
+        appendPod(out, kVersion);
+        appendPod(out, static_cast<std::uint32_t>(kFields));
+        appendPod(out, static_cast<std::uint64_t>(count));
+        forEachField<T>([&](auto i) {
+            constexpr std::size_t I = decltype(i)::value;
+            const char* label = std::get<I>(RecordTraits<T>::fields).label;
+            appendPod(out, static_cast<std::uint32_t>(std::strlen(label)));
+            out += label;
+            out += static_cast<char>(kindOf<FieldType<I>>());
+            out += static_cast<char>(sizeof(FieldType<I>));
+        });
+        forEachField<T>([&](auto i) {
+            const auto& values = std::get<decltype(i)::value>(columns);
+            using M = typename std::remove_cvref_t<decltype(values)>::value_type;
+            if constexpr (std::is_same_v<M, std::string>) {
+                for (const std::string& value : values) appendPod(out, static_cast<std::uint32_t>(value.size()));
+                for (const std::string& value : values) out += value;
+            }
+            else {
+                out.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(M));
+            }
+        });
+    }
+
+    // replaces the contents; on failure the registry is left empty and error says why
+    bool deserialize(std::string_view data, std::string& error) {
+        clear();
+        Reader in{data};
+        char magic[4];
+        std::uint32_t version = 0, fields = 0;
+        std::uint64_t rows = 0;
+        if (!in.read(magic, 4) || std::memcmp(magic, kMagic, 4) != 0) {
+            error = "not a registry file";
+            return false;
+        }
+        if (!in.pod(version) || version != kVersion || !in.pod(fields) || !in.pod(rows)) {
+            error = "unsupported registry version";
+            return false;
+        }
+        if (fields != kFields) {
+            error = "registry has " + std::to_string(fields) + " fields, expected " + std::to_string(kFields);
+            return false;
+        }
+        if (rows >= npos) {
+            error = "registry has " + std::to_string(rows) + " rows, more than a registry can index";
+            return false;
+        }
+        bool ok = true;
+        forEachField<T>([&](auto i) {
+            constexpr std::size_t I = decltype(i)::value;
+            const char* label = std::get<I>(RecordTraits<T>::fields).label;
+            std::uint32_t length = 0;
+            std::string_view stored;
+            char kind = 0, width = 0;
+            if (!ok) return;
+            if (!in.pod(length) || !in.view(stored, length) || !in.read(&kind, 1) || !in.read(&width, 1) ||
+                stored != label || kind != kindOf<FieldType<I>>() || width != static_cast<char>(sizeof(FieldType<I>))) {
+                error = "field " + std::to_string(I + 1) + " does not match " + label;
+                ok = false;
+            }
+        });
+        forEachField<T>([&](auto i) {
+            constexpr std::size_t I = decltype(i)::value;
+            using M = FieldType<I>;
+            std::vector<M>& values = std::get<I>(columns);
+            if (!ok) return;
+            // a column is at least rows * width bytes, so a bad row count fails here, not in an allocation
+            constexpr std::size_t width = std::is_same_v<M, std::string> ? sizeof(std::uint32_t) : sizeof(M);
+            if (in.remaining() / width < rows) {
+                error = std::string("truncated column ") + std::get<I>(RecordTraits<T>::fields).label;
+                ok = false;
+                return;
+            }
+            if constexpr (std::is_same_v<M, std::string>) {
+                std::vector<std::uint32_t> lengths(rows);
+                ok = in.read(lengths.data(), rows * sizeof(std::uint32_t));
+                values.reserve(rows);
+                for (std::size_t r = 0; ok && r < rows; ++r) {
+                    std::string_view text;
+                    ok = in.view(text, lengths[r]);
+                    values.emplace_back(text);
+                }
+            }
+            else {
+                values.resize(rows);
+                ok = in.read(values.data(), rows * sizeof(M));
+            }
+            if (!ok) error = std::string("truncated column ") + std::get<I>(RecordTraits<T>::fields).label;
+        });
+        if (!ok) {
+            clear();
+            return false;
+        }
+        count = static_cast<std::size_t>(rows);
+        return rebuildIndexes(error);
+    }
+
+    // Takes over complete columns (as decoded by registrySnapshot.h) and indexes them; false, with
+    // the registry left empty, when the columns differ in length or a unique field repeats
+    bool adoptColumns(Columns&& values, std::string& error) {
+        clear();
+        std::size_t rows = std::get<0>(values).size();
+        bool sameLength = true;
+        forEachField<T>([&](auto i) { sameLength = sameLength && std::get<decltype(i)::value>(values).size() == rows; });
+        if (!sameLength || rows >= npos) {
+            error = "columns of different lengths";
+            return false;
+        }
+        columns = std::move(values);
+        count = rows;
+        return rebuildIndexes(error);
+    }
+
+    bool save(const std::string& path, std::string& error) const {
+        std::string data;
+        serialize(data);
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out.write(data.data(), static_cast<std::streamsize>(data.size()))) {
+            error = "cannot write " + path;
+            return false;
+        }
+        return true;
+    }
+
+    bool load(const std::string& path, std::string& error) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            error = "cannot open " + path;
+            return false;
+        }
+        std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        return deserialize(data, error);
+    }
+
+    void clear() {
+        columns = {};
+        indexes = {};
+        count = 0;
+    }
+
+private:
+    static constexpr char kMagic[4] = {'E', 'V', 'R', 'G'};
+    static constexpr std::uint32_t kVersion = 1;
+
+    struct Reader {
+        std::string_view data;
+        std::size_t at = 0;
+
+        bool read(void* out, std::size_t bytes) {
+            if (data.size() - at < bytes) return false;
+            if (bytes > 0) std::memcpy(out, data.data() + at, bytes);
+            at += bytes;
+            return true;
+        }
+        template <typename P> bool pod(P& value) { return read(&value, sizeof(P)); }
+        std::size_t remaining() const { return data.size() - at; }
+        bool view(std::string_view& out, std::size_t bytes) {
+            if (data.size() - at < bytes) return false;
+            out = data.substr(at, bytes);
+            at += bytes;
+            return true;
+        }
+    };
+
+    template <typename P>
+    static void appendPod(std::string& out, P value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(P));
+    }
+
+    template <typename M>
+    static constexpr char kindOf() {
+        if constexpr (std::is_integral_v<M>) return 0;
+        else if constexpr (std::is_floating_point_v<M>) return 1;
+        else return 2;
+    }
+
+    template <auto Member>
+    static constexpr std::size_t checkedField() {
+        static_assert(kFieldOf<T, Member> < kFields, "member is not a registry field");
+        return kFieldOf<T, Member>;
+    }
+
+    template <std::size_t I>
+    static constexpr auto member() { return std::get<I>(RecordTraits<T>::fields).member; }
+
+    // every index rebuilt from the columns
+    bool rebuildIndexes(std::string& error) {
+        bool ok = true;
+        forEachField<T>([&](auto i) {
+            constexpr std::size_t I = decltype(i)::value;
+            const auto& values = std::get<I>(columns);
+            if constexpr (FieldAt<T, I>::index == FieldIndex::unique) {
+                // sized once for every row; a repeated key finds its first row instead of its own
+                std::get<I>(indexes).reserve(values, count);
+                for (std::uint32_t row = 0; ok && row < count; ++row) {
+                    if (std::get<I>(indexes).find(values, values[row]) != row) {
+                        error = std::string("duplicate ") + std::get<I>(RecordTraits<T>::fields).label + " in row " + std::to_string(row + 1);
+                        ok = false;
+                    }
+                }
+            }
+            else {
+                for (std::uint32_t row = 0; row < count; ++row) indexRow<I>(row);
+            }
+        });
+        if (!ok) clear();
+        return ok;
+    }
+
+    template <std::size_t I>
+    void indexRow(std::uint32_t row) {
+        constexpr FieldIndex kind = FieldAt<T, I>::index;
+        const auto& values = std::get<I>(columns);
+        if constexpr (kind == FieldIndex::unique) std::get<I>(indexes).insert(values, row);
+        else if constexpr (kind == FieldIndex::ordered) std::get<I>(indexes).add(static_cast<std::int32_t>(values[row]), row);
+        else if constexpr (kind == FieldIndex::grouped) std::get<I>(indexes)[values[row]].push_back(row);
+    }
+
+    void appendBuffered(std::ostream& os, std::string& buffer, std::uint32_t row) const {
+        appendRow(buffer, row);
+        if (buffer.size() >= 64 * 1024) {
+            os.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    }
+
+    Columns columns;
+    decltype(indexesOf(std::make_index_sequence<kFields>{})) indexes;
+    std::size_t count = 0;
+};
+
+#endif //EMPLOYEE_VALIDATION_C_REGISTRY_H
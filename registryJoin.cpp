@@ -0,0 +1,230 @@
+//
+// Checks the employee registry against the citizen / eligibility records by id.
+//
+//   RegistryJoin <employees file> <population file> [output prefix] [threads]
+//       writes <prefix>.matched, <prefix>.unregistered (employees with no person record) and
+//       <prefix>.not_employees (person records with no employee)
+//   RegistryJoin --generate <employees file> <rows>
+//   RegistryJoin --bench [rows]      - join against std::unordered_map on in-memory columns
+//
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include "employee.h"
+#include "eligibility.h"
+#include "hashJoin.h"
+#include "mappedFile.h"
+
+// Leading id of every line (both file formats start with it); lines without one are counted as malformed
+void parseIdColumn(std::string_view text, std::vector<std::uint64_t>& ids, std::uint64_t& malformed) {
+    const char* p = text.data();
+    const char* end = p + text.size();
+    while (p < end) {
+        if (*p == '\n' || *p == '\r') {
+            ++p;
+            continue;
+        }
+        const char* digits = p;
+        std::uint64_t id = 0;
+        while (p < end && *p >= '0' && *p <= '9') id = id * 10 + static_cast<std::uint64_t>(*p++ - '0');
+        if (p == digits || (p < end && *p != ',' && *p != '\n' && *p != '\r')) ++malformed;
+        else ids.push_back(id);
+        while (p < end && *p != '\n') ++p;
+    }
+}
+
+bool loadIdColumn(const std::string& path, unsigned threads, std::vector<std::uint64_t>& ids,
+                  std::uint64_t& malformed) {
+    MappedFile input;
+    if (!input.open(path)) return false;
+    std::vector<std::string_view> chunks = splitOnLineBoundaries(skipHeader(input.view()), threads);
+    std::vector<std::vector<std::uint64_t>> parts(chunks.size());
+    std::vector<std::uint64_t> bad(chunks.size(), 0);
+    std::vector<std::thread> pool;
+    for (std::size_t c = 1; c < chunks.size(); ++c) {
+        pool.emplace_back([&, c] { parseIdColumn(chunks[c], parts[c], bad[c]); });
+    }
+    if (!chunks.empty()) parseIdColumn(chunks[0], parts[0], bad[0]);
+    for (auto& thread : pool) thread.join();
+
+    std::size_t total = 0;
+    for (const auto& part : parts) total += part.size();
+    ids.clear();
+    ids.reserve(total);
+    malformed = 0;
+    for (std::size_t c = 0; c < parts.size(); ++c) {
+        ids.insert(ids.end(), parts[c].begin(), parts[c].end());
+        malformed += bad[c];
+    }
+    return true;
+}
+
+bool writeIds(const std::string& path, const std::vector<std::uint64_t>& ids, const std::vector<std::uint32_t>& rows) {
+    std::FILE* out = std::fopen(path.c_str(), "wb");
+    if (out == nullptr) return false;
+    std::string buffer;
+    buffer.reserve(1 << 20);
+    bool ok = true;
+    for (std::uint32_t row : rows) {
+        buffer += std::to_string(ids[row]);
+        buffer += '\n';
+        if (buffer.size() > (1 << 20) - 32) {
+            ok = std::fwrite(buffer.data(), 1, buffer.size(), out) == buffer.size() && ok;
+            buffer.clear();
+        }
+    }
+    ok = std::fwrite(buffer.data(), 1, buffer.size(), out) == buffer.size() && ok;
+    return std::fclose(out) == 0 && ok;
+}
+
+// Employees with ids 1..~1.1*rows, every tenth id left out; against a population of the same
+// size that gives some of each: matched, employees without a record, records without an employee
+bool generateEmployees(const std::string& path, std::uint64_t rows) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    static const char* names[] = {"Jane Doe", "John Smith", "Ana Lopez", "Wei Chen", "Sam Patel", "Mia Novak"};
+    static const char* departments[] = {"Sales", "Engineering", "Finance", "Support", "Legal"};
+    std::string buffer;
+    buffer.reserve(1 << 20);
+    out << "id,name,department,salary\n";
+    for (std::uint64_t i = 1; i <= rows; ++i) {
+        Employee e{static_cast<int>(i + i / 9), names[i % 6], departments[i % 5], 40000.0 + (i * 37) % 60000};
+        appendEmployeeRow(buffer, e);
+        if (buffer.size() > (1 << 20) - 64) {
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    }
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    return static_cast<bool>(out);
+}
+
+int runJoin(const std::string& employeesPath, const std::string& populationPath, const std::string& prefix,
+            unsigned threads) {
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::time_point a, Clock::time_point b) { return std::chrono::duration<double, std::milli>(b - a).count(); };
+
+    auto t0 = Clock::now();
+    std::vector<std::uint64_t> employees, people;
+    std::uint64_t badEmployees = 0, badPeople = 0;
+    if (!loadIdColumn(employeesPath, threads, employees, badEmployees)) {
+        std::cout << "Could not read " << employeesPath << "\n";
+        return 1;
+    }
+    if (!loadIdColumn(populationPath, threads, people, badPeople)) {
+        std::cout << "Could not read " << populationPath << "\n";
+        return 1;
+    }
+    if (employees.size() > 0xFFFFFFFFull || people.size() > 0xFFFFFFFFull) {
+        std::cout << "Too many rows for one join\n";
+        return 1;
+    }
+    auto t1 = Clock::now();
+    JoinResult result = hashJoin(employees, people, threads);
+    auto t2 = Clock::now();
+
+    // the join hands back rows in partition order; the unmatched lists are written in input order
+    std::sort(result.unmatchedLeft.begin(), result.unmatchedLeft.end());
+    std::sort(result.unmatchedRight.begin(), result.unmatchedRight.end());
+    bool ok = writeIds(prefix + ".matched", employees, result.matchedLeft) &&
+              writeIds(prefix + ".unregistered", employees, result.unmatchedLeft) &&
+              writeIds(prefix + ".not_employees", people, result.unmatchedRight);
+    auto t3 = Clock::now();
+    if (!ok) {
+        std::cout << "Could not write " << prefix << ".*\n";
+        return 1;
+    }
+
+    std::cout << "Employees: " << employees.size() << " (" << badEmployees << " malformed) | people: "
+              << people.size() << " (" << badPeople << " malformed) | " << threads << " threads\n";
+    std::cout << "  matched                 : " << result.matchedLeft.size() << "\n";
+    std::cout << "  employees not in records: " << result.unmatchedLeft.size() << "\n";
+    std::cout << "  records not employees   : " << result.unmatchedRight.size() << "\n";
+    std::cout << "  load " << ms(t0, t1) << " ms | join " << ms(t1, t2) << " ms | write " << ms(t2, t3) << " ms\n";
+    std::cout << "Results written to " << prefix << ".matched / .unregistered / .not_employees\n";
+    return 0;
+}
+
+int runBenchmark(std::size_t rows, unsigned threads) {
+    using Clock = std::chrono::steady_clock;
+    std::vector<std::uint64_t> employees(rows), people(rows);
+    for (std::size_t i = 0; i < rows; ++i) {
+        employees[i] = i + 1 + i / 9;
+        people[i] = i + 1;
+    }
+    // shuffled so neither side is in the other's order (or in id order)
+    std::uint64_t state = 88172645463325252ull;
+    for (std::size_t i = rows; i > 1; --i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        std::swap(people[i - 1], people[state % i]);
+    }
+
+    auto t0 = Clock::now();
+    JoinResult result = hashJoin(employees, people, threads);
+    auto t1 = Clock::now();
+
+    // baseline: one big unordered_map over the left side, probed row by row, same outputs
+    std::unordered_map<std::uint64_t, std::uint32_t> table;
+    table.reserve(rows);
+    for (std::size_t i = 0; i < rows; ++i) table.emplace(employees[i], static_cast<std::uint32_t>(i));
+    JoinResult baseline;
+    std::vector<std::uint8_t> hit(rows, 0);
+    for (std::size_t j = 0; j < rows; ++j) {
+        auto found = table.find(people[j]);
+        if (found == table.end()) {
+            baseline.unmatchedRight.push_back(static_cast<std::uint32_t>(j));
+            continue;
+        }
+        baseline.matchedLeft.push_back(found->second);
+        baseline.matchedRight.push_back(static_cast<std::uint32_t>(j));
+        hit[found->second] = 1;
+    }
+    for (std::size_t i = 0; i < rows; ++i) {
+        if (!hit[i]) baseline.unmatchedLeft.push_back(static_cast<std::uint32_t>(i));
+    }
+    std::size_t matched = baseline.matchedLeft.size();
+    auto t2 = Clock::now();
+
+    auto ms = [](Clock::time_point a, Clock::time_point b) { return std::chrono::duration<double, std::milli>(b - a).count(); };
+    std::cout << "Rows per side: " << rows << " | radix bits: " << joinRadixBits(rows) << " | " << threads << " threads\n";
+    std::cout << "  partitioned hash join : " << ms(t0, t1) << " ms (matched " << result.matchedLeft.size()
+              << ", left only " << result.unmatchedLeft.size() << ", right only " << result.unmatchedRight.size() << ")\n";
+    std::cout << "  std::unordered_map    : " << ms(t1, t2) << " ms (matched " << matched << ")"
+              << (matched == result.matchedLeft.size() ? "" : " | MISMATCH") << "\n";
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    if (argc > 3 && std::strcmp(argv[1], "--generate") == 0) {
+        if (!generateEmployees(argv[2], std::strtoull(argv[3], nullptr, 10))) {
+            std::cout << "Could not write " << argv[2] << "\n";
+            return 1;
+        }
+        return 0;
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--bench") == 0) {
+        return runBenchmark(argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20000000, threads);
+    }
+    if (argc > 2) {
+        if (argc > 4) threads = std::max(1u, static_cast<unsigned>(std::strtoul(argv[4], nullptr, 10)));
+        return runJoin(argv[1], argv[2], argc > 3 ? argv[3] : "join", threads);
+    }
+
+    std::cout << "usage: RegistryJoin <employees file> <population file> [output prefix] [threads]\n"
+              << "       RegistryJoin --generate <employees file> <rows>\n"
+              << "       RegistryJoin --bench [rows]\n";
+    return 1;
+}
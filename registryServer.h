@@ -0,0 +1,674 @@
+//
+// Socket server for the employee registry, plus the load generator used to measure it.
+//
+// Clients send one request per line and get one line back (LIST answers with one line per
+// employee and then "END"):
+//
+//     REGISTER 1001,Jane Doe,Sales,52000   ->  OK | ERR <reason>
+//     LOOKUP 1001                          ->  FOUND ID: 1001 | Name: ... | NOTFOUND
+//     LIST [department]                    ->  ID: ... lines, END
+//     REGISTER                             ->  the registration dialog, one question per line,
+//                                              each following line answering it
+//
+// The address is "unix:<path>" or "tcp:<port>" (loopback only). There is one edge-triggered
+// epoll loop per core; loop 0 also owns the listening socket and deals accepted connections
+// out to the loops round robin, so every connection lives on exactly one thread. Requests
+// share one Registry<Employee> behind a reader / writer lock. Linux only.
+//
+// A line longer than kMaxLineBytes gets "ERR line too long" and the connection is closed, and
+// so does a registration dialog that fails with an exception ("ERR registration failed"). A
+// client that stops reading its replies stops being read once kOutHighWaterBytes are waiting,
+// and a client that shuts down its sending side still gets every reply it is owed.
+//
+
+#ifndef EMPLOYEE_VALIDATION_C_REGISTRYSERVER_H
+#define EMPLOYEE_VALIDATION_C_REGISTRYSERVER_H
+
+#if defined(__linux__)
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "employee.h"
+#include "instrumentation.h"
+#include "registrationSession.h"
+#include "registry.h"
+
+struct ServerAddress {
+    bool unixSocket = false;
+    std::string path;
+    std::uint16_t port = 0;
+};
+
+inline bool parseServerAddress(std::string_view text, ServerAddress& address, std::string& error) {
+    if (text.rfind("unix:", 0) == 0 && text.size() > 5) {
+        address.unixSocket = true;
+        address.path.assign(text.substr(5));
+        if (address.path.size() >= sizeof(sockaddr_un::sun_path)) {
+            error = "socket path too long";
+            return false;
+        }
+        return true;
+    }
+    if (text.rfind("tcp:", 0) == 0) text.remove_prefix(4);
+    unsigned port = 0;
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), port);
+    if (ec != std::errc() || end != text.data() + text.size() || port == 0 || port > 65535) {
+        error = "address must be unix:<path> or tcp:<port>";
+        return false;
+    }
+    address.unixSocket = false;
+    address.port = static_cast<std::uint16_t>(port);
+    return true;
+}
+
+inline bool setNonBlocking(int fd) {
+    int flags = ::fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+// sockaddr for the address; returns its length
+inline socklen_t fillSocketAddress(const ServerAddress& address, sockaddr_storage& storage) {
+    std::memset(&storage, 0, sizeof(storage));
+    if (address.unixSocket) {
+        auto* local = reinterpret_cast<sockaddr_un*>(&storage);
+        local->sun_family = AF_UNIX;
+        std::memcpy(local->sun_path, address.path.c_str(), address.path.size() + 1);
+        return static_cast<socklen_t>(sizeof(sockaddr_un));
+    }
+    auto* inet = reinterpret_cast<sockaddr_in*>(&storage);
+    inet->sin_family = AF_INET;
+    inet->sin_port = htons(address.port);
+    inet->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return static_cast<socklen_t>(sizeof(sockaddr_in));
+}
+
+// non-blocking listening socket, -1 and error on failure
+inline int listenOn(const ServerAddress& address, std::string& error) {
+    int fd = ::socket(address.unixSocket ? AF_UNIX : AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        error = std::string("socket: ") + std::strerror(errno);
+        return -1;
+    }
+    if (address.unixSocket) {
+        ::unlink(address.path.c_str());   // a socket file left behind by an earlier run
+    }
+    else {
+        int on = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    }
+    sockaddr_storage storage;
+    socklen_t length = fillSocketAddress(address, storage);
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&storage), length) != 0 || ::listen(fd, SOMAXCONN) != 0) {
+        error = std::string("bind / listen: ") + std::strerror(errno);
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// connected non-blocking socket, -1 and error on failure
+inline int connectTo(const ServerAddress& address, std::string& error) {
+    int fd = ::socket(address.unixSocket ? AF_UNIX : AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        error = std::string("socket: ") + std::strerror(errno);
+        return -1;
+    }
+    sockaddr_storage storage;
+    socklen_t length = fillSocketAddress(address, storage);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&storage), length) != 0) {
+        error = std::string("connect: ") + std::strerror(errno);
+        ::close(fd);
+        return -1;
+    }
+    if (!address.unixSocket) {
+        int on = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    }
+    setNonBlocking(fd);
+    return fd;
+}
+
+// ---- requests ----
+
+// Answers one request line, appending the reply to out
+inline void handleRegistryRequest(std::string_view line, SharedRegistry& shared, std::string& out) {
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    std::size_t space = line.find(' ');
+    std::string_view command = line.substr(0, space);
+    std::string_view argument = space == std::string_view::npos ? std::string_view() : line.substr(space + 1);
+
+    if (command == "REGISTER") {
+        Employee e;
+        std::string error;
+        if (!parseEmployeeFields(argument, e, error)) {
+            out += "ERR ";
+            out += error;
+            out += '\n';
+            return;
+        }
+        std::unique_lock writer(shared.lock);
+        out += shared.employees.add(std::move(e)) ? "OK\n" : "ERR Employee ID already registered\n";
+    }
+    else if (command == "LOOKUP") {
+        int id = 0;
+        auto [end, ec] = std::from_chars(argument.data(), argument.data() + argument.size(), id);
+        if (ec != std::errc() || end != argument.data() + argument.size()) {
+            out += "ERR LOOKUP needs a numeric id\n";
+            return;
+        }
+        std::shared_lock reader(shared.lock);
+        std::uint32_t row = shared.employees.find<&Employee::id>(id);
+        if (row == Registry<Employee>::npos) {
+            out += "NOTFOUND\n";
+            return;
+        }
+        out += "FOUND ";
+        shared.employees.appendRow(out, row);
+    }
+    else if (command == "LIST") {
+        std::shared_lock reader(shared.lock);
+        if (argument.empty()) {
+            for (std::uint32_t row = 0; row < shared.employees.size(); ++row) shared.employees.appendRow(out, row);
+        }
+        else {
+            for (std::uint32_t row : shared.employees.rowsWith<&Employee::department>(std::string(argument))) {
+                shared.employees.appendRow(out, row);
+            }
+        }
+        out += "END\n";
+    }
+    else {
+        out += "ERR unknown command\n";
+    }
+}
+
+// ---- server ----
+
+class ServerLoop {
+public:
+    explicit ServerLoop(SharedRegistry& registry) : shared(registry) {
+        epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+        wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLET;
+        event.data.ptr = &wakeFd;
+        ::epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+    }
+    ServerLoop(const ServerLoop&) = delete;
+    ServerLoop& operator=(const ServerLoop&) = delete;
+
+    ~ServerLoop() {
+        for (auto& [fd, connection] : connections) ::close(fd);
+        ::close(wakeFd);
+        ::close(epollFd);
+    }
+
+    static constexpr std::size_t kMaxLineBytes = 64 * 1024;
+    static constexpr std::size_t kOutHighWaterBytes = 1024 * 1024;
+
+    bool valid() const { return epollFd >= 0 && wakeFd >= 0; }
+
+    // loop 0 accepts on behalf of all of them
+    void listen(int fd, std::vector<ServerLoop*> loops) {
+        listenFd = fd;
+        shards = std::move(loops);
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLET;
+        event.data.ptr = &listenFd;
+        ::epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+    }
+
+    // hands a freshly accepted connection to this loop, from any thread
+    void adopt(int fd) {
+        {
+            std::lock_guard guard(adoptLock);
+            adopted.push_back(fd);
+        }
+        wake();
+    }
+
+    void stop() {
+        stopping.store(true, std::memory_order_relaxed);
+        wake();
+    }
+
+    void run() {
+        epoll_event events[256];
+        while (!stopping.load(std::memory_order_relaxed)) {
+            int ready = ::epoll_wait(epollFd, events, 256, -1);
+            if (ready < 0 && errno != EINTR) break;
+            for (int i = 0; i < ready; ++i) {
+                void* tag = events[i].data.ptr;
+                if (tag == &wakeFd) {
+                    std::uint64_t ignored;
+                    while (::read(wakeFd, &ignored, sizeof(ignored)) > 0) {}
+                    takeAdopted();
+                }
+                else if (tag == &listenFd) {
+                    acceptAll();
+                }
+                else {
+                    serve(*static_cast<Connection*>(tag), events[i].events);
+                }
+            }
+        }
+    }
+
+private:
+    struct Dialog {
+        SessionInput input;
+        RegistrationSession session;   // destroyed before the input it waits on
+    };
+
+    struct Connection {
+        int fd = -1;
+        std::string in;
+        std::size_t parsed = 0;    // bytes of in already answered
+        std::string out;
+        std::size_t sent = 0;      // bytes of out already written
+        std::unique_ptr<Dialog> dialog;   // a registration dialog in progress
+        bool reading = true;       // false after EOF, a read error or a too long line: close once flushed
+        bool paused = false;       // reading stopped at kOutHighWaterBytes, input may be waiting
+    };
+
+    void wake() {
+        std::uint64_t one = 1;
+        [[maybe_unused]] ssize_t written = ::write(wakeFd, &one, sizeof(one));
+    }
+
+    // edge triggered: keep accepting until the backlog is empty
+    void acceptAll() {
+        while (true) {
+            int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) continue;
+                break;   // EAGAIN, or out of descriptors - try again on the next edge
+            }
+            int on = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));   // fails harmlessly on unix sockets
+            ServerLoop* target = shards[nextShard++ % shards.size()];
+            if (target == this) add(fd);
+            else target->adopt(fd);
+        }
+    }
+
+    void takeAdopted() {
+        std::vector<int> fds;
+        {
+            std::lock_guard guard(adoptLock);
+            fds.swap(adopted);
+        }
+        for (int fd : fds) add(fd);
+    }
+
+    void add(int fd) {
+        auto connection = std::make_unique<Connection>();
+        connection->fd = fd;
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.ptr = connection.get();
+        if (::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            ::close(fd);
+            return;
+        }
+        connections.emplace(fd, std::move(connection));
+    }
+
+    void close(Connection& connection) {
+        int fd = connection.fd;
+        ::epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        ::close(fd);
+        connections.erase(fd);
+    }
+
+    void serve(Connection& connection, std::uint32_t events) {
+        while (true) {
+            if (connection.reading && (connection.paused || (events & (EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP)))) {
+                readAll(connection);
+            }
+            if (!flush(connection)) {
+                close(connection);
+                return;
+            }
+            if (!connection.reading) {
+                if (connection.out.empty()) {
+                    discardInput(connection);
+                    close(connection);
+                }
+                return;   // otherwise EPOLLOUT brings us back to send the rest
+            }
+            // a paused connection that flushed below the mark goes back to its waiting input
+            if (!connection.paused || pendingBytes(connection) >= kOutHighWaterBytes) return;
+        }
+    }
+
+    static std::size_t pendingBytes(const Connection& connection) { return connection.out.size() - connection.sent; }
+
+    // closing with unread input resets the connection, which can throw away the last reply
+    // before the client reads it - so drop what has arrived (up to a bound) first
+    void discardInput(Connection& connection) {
+        char buffer[64 * 1024];
+        for (std::size_t dropped = 0; dropped < 16 * kMaxLineBytes;) {
+            ssize_t got = ::read(connection.fd, buffer, sizeof(buffer));
+            if (got < 0 && errno == EINTR) continue;
+            if (got <= 0) return;
+            dropped += static_cast<std::size_t>(got);
+        }
+    }
+
+    // answers and reads until the socket is drained, the peer is gone, a line is too long or
+    // kOutHighWaterBytes of replies are waiting to be sent
+    void readAll(Connection& connection) {
+        char buffer[64 * 1024];
+        while (connection.reading) {
+            answer(connection);
+            connection.paused = pendingBytes(connection) >= kOutHighWaterBytes;
+            if (connection.paused || !connection.reading) return;
+            ssize_t got = ::read(connection.fd, buffer, sizeof(buffer));
+            if (got > 0) {
+                connection.in.append(buffer, static_cast<std::size_t>(got));
+                continue;
+            }
+            if (got < 0 && errno == EINTR) continue;
+            if (got == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) connection.reading = false;
+            return;
+        }
+    }
+
+    // answers complete lines until none are left or the replies reach kOutHighWaterBytes
+    void answer(Connection& connection) {
+        std::string_view pending(connection.in);
+        while (pendingBytes(connection) < kOutHighWaterBytes) {
+            std::size_t newline = pending.find('\n', connection.parsed);
+            if (newline == std::string_view::npos) {
+                if (connection.in.size() - connection.parsed > kMaxLineBytes) {
+                    connection.out += "ERR line too long\n";
+                    connection.reading = false;
+                    connection.parsed = connection.in.size();
+                }
+                break;
+            }
+            std::string_view line = pending.substr(connection.parsed, newline - connection.parsed);
+            connection.parsed = newline + 1;
+            if (connection.dialog) {
+                connection.dialog->input.feed(line);
+            }
+            else if (trimSpaces(line) == "REGISTER") {
+                connection.dialog = std::make_unique<Dialog>();
+                connection.dialog->session = registrationDialog(connection.dialog->input, connection.out, shared);
+            }
+            else {
+                handleRegistryRequest(line, shared, connection.out);
+                continue;
+            }
+            if (!connection.out.empty() && connection.out.back() != '\n') connection.out += '\n';   // prompts end the line
+            if (connection.dialog->session.failure()) {
+                connection.out += "ERR registration failed\n";
+                connection.reading = false;
+                connection.parsed = connection.in.size();
+                connection.dialog.reset();
+                break;
+            }
+            if (!connection.dialog->session.active()) connection.dialog.reset();
+        }
+        if (connection.parsed == connection.in.size()) {
+            connection.in.clear();
+            connection.parsed = 0;
+        }
+        else if (connection.parsed > 64 * 1024) {
+            connection.in.erase(0, connection.parsed);
+            connection.parsed = 0;
+        }
+    }
+
+    // writes until done or the socket is full (EPOLLOUT brings us back); false on error
+    bool flush(Connection& connection) {
+        while (connection.sent < connection.out.size()) {
+            ssize_t put = ::send(connection.fd, connection.out.data() + connection.sent,
+                                 connection.out.size() - connection.sent, MSG_NOSIGNAL);
+            if (put > 0) {
+                connection.sent += static_cast<std::size_t>(put);
+                continue;
+            }
+            if (put < 0 && errno == EINTR) continue;
+            if (put == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) return false;
+            if (connection.sent >= kOutHighWaterBytes) {   // a slow reader never empties out, so drop what went
+                connection.out.erase(0, connection.sent);
+                connection.sent = 0;
+            }
+            return true;
+        }
+        connection.out.clear();
+        connection.sent = 0;
+        return true;
+    }
+
+    SharedRegistry& shared;
+    int epollFd = -1;
+    int wakeFd = -1;
+    int listenFd = -1;
+    std::vector<ServerLoop*> shards;
+    std::size_t nextShard = 0;
+    std::unordered_map<int, std::unique_ptr<Connection>> connections;
+    std::mutex adoptLock;
+    std::vector<int> adopted;
+    std::atomic<bool> stopping{false};
+};
+
+class RegistryServer {
+public:
+    explicit RegistryServer(SharedRegistry& registry) : shared(registry) {}
+    ~RegistryServer() { stop(); }
+
+    bool start(const ServerAddress& where, unsigned loopCount, std::string& error) {
+        address = where;
+        listenFd = listenOn(address, error);
+        if (listenFd < 0) return false;
+        std::vector<ServerLoop*> all;
+        for (unsigned l = 0; l < std::max(1u, loopCount); ++l) {
+            loops.push_back(std::make_unique<ServerLoop>(shared));
+            if (!loops.back()->valid()) {
+                error = std::string("epoll: ") + std::strerror(errno);
+                return false;
+            }
+            all.push_back(loops.back().get());
+        }
+        loops[0]->listen(listenFd, all);
+        for (auto& loop : loops) threads.emplace_back([&loop] { loop->run(); });
+        return true;
+    }
+
+    void stop() {
+        for (auto& loop : loops) loop->stop();
+        for (auto& thread : threads) thread.join();
+        threads.clear();
+        loops.clear();
+        if (listenFd >= 0) {
+            ::close(listenFd);
+            if (address.unixSocket) ::unlink(address.path.c_str());
+        }
+        listenFd = -1;
+    }
+
+private:
+    SharedRegistry& shared;
+    ServerAddress address;
+    int listenFd = -1;
+    std::vector<std::unique_ptr<ServerLoop>> loops;
+    std::vector<std::thread> threads;
+};
+
+// ---- load generator ----
+
+struct LoadTestResult {
+    std::uint64_t sent = 0;
+    std::uint64_t answered = 0;
+    double seconds = 0;
+    LatencyHistogram::Snapshot latency;   // send to reply, nanoseconds
+};
+
+// Open loop load: requests are released every 100 us at the target rate, whether or not earlier
+// ones have been answered, round robin over the connections - 9 LOOKUPs of seeded ids to every
+// REGISTER of a new one. Replies come back in order per connection, so each one is matched with
+// the oldest send time still waiting on its connection.
+inline bool runRegistryLoadTest(const ServerAddress& address, std::uint64_t rate, double seconds, unsigned connectionCount,
+                                LoadTestResult& result, std::string& error) {
+    struct ClientConnection {
+        int fd = -1;
+        std::string out;
+        std::size_t sent = 0;
+        std::deque<std::uint64_t> waiting;   // send times, oldest first
+        std::string partial;                 // reply bytes after the last newline
+    };
+    std::vector<ClientConnection> clients(std::max(1u, connectionCount));
+    for (auto& client : clients) {
+        client.fd = connectTo(address, error);
+        if (client.fd < 0) {
+            for (auto& opened : clients) if (opened.fd >= 0) ::close(opened.fd);
+            return false;
+        }
+    }
+    int epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    int timerFd = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    for (std::size_t c = 0; c < clients.size(); ++c) {
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLOUT | EPOLLET;
+        event.data.u64 = c;
+        ::epoll_ctl(epollFd, EPOLL_CTL_ADD, clients[c].fd, &event);
+    }
+    epoll_event timerEvent{};
+    timerEvent.events = EPOLLIN;
+    timerEvent.data.u64 = clients.size();
+    ::epoll_ctl(epollFd, EPOLL_CTL_ADD, timerFd, &timerEvent);
+    itimerspec tick{};
+    tick.it_interval.tv_nsec = 100000;
+    tick.it_value.tv_nsec = 100000;
+    ::timerfd_settime(timerFd, 0, &tick, nullptr);
+
+    constexpr std::uint64_t kUntimed = 0;   // seed requests: answered, not measured
+    LatencyHistogram histogram;
+    auto flush = [](ClientConnection& client) {
+        while (client.sent < client.out.size()) {
+            ssize_t put = ::send(client.fd, client.out.data() + client.sent, client.out.size() - client.sent, MSG_NOSIGNAL);
+            if (put <= 0) break;
+            client.sent += static_cast<std::size_t>(put);
+        }
+        if (client.sent == client.out.size()) {
+            client.out.clear();
+            client.sent = 0;
+        }
+    };
+    auto drain = [&](ClientConnection& client) {
+        char buffer[64 * 1024];
+        while (true) {
+            ssize_t got = ::read(client.fd, buffer, sizeof(buffer));
+            if (got <= 0) break;
+            std::uint64_t now = monotonicNanos();
+            for (ssize_t i = 0; i < got; ++i) {
+                if (buffer[i] != '\n' || client.waiting.empty()) continue;
+                if (client.waiting.front() != kUntimed) {
+                    histogram.record(now - client.waiting.front());
+                    ++result.answered;
+                }
+                client.waiting.pop_front();
+            }
+        }
+    };
+
+    // seed ids 1..10000 so lookups find something (already registered on a rerun: ERR, still a reply)
+    constexpr int kSeeded = 10000;
+    std::uint64_t nextRegister = monotonicNanos() % 1000000000 + 1000000000;   // unlikely to collide across runs
+    const std::uint64_t duration = static_cast<std::uint64_t>(seconds * 1e9);
+    std::uint64_t start = monotonicNanos();
+    std::uint64_t end = start + duration + 60000000000ull;   // the seeding gets a minute
+    bool seeding = true;
+    std::uint64_t released = 0;
+    std::uint32_t random = 2463534242u;
+    std::size_t nextClient = 0;
+    std::string request;
+    auto release = [&](std::string_view line, bool timed) {
+        ClientConnection& client = clients[nextClient++ % clients.size()];
+        client.out.append(line);
+        client.waiting.push_back(timed ? monotonicNanos() : kUntimed);
+        result.sent += timed ? 1 : 0;
+    };
+    for (int id = 1; id <= kSeeded; ++id) {
+        request = "REGISTER " + std::to_string(id) + ",Load Test,Engineering,50000\n";
+        release(request, false);
+    }
+
+    epoll_event events[64];
+    std::uint64_t outstanding = 1;
+    while (true) {
+        std::uint64_t now = monotonicNanos();
+        outstanding = 0;
+        for (auto& client : clients) outstanding += client.waiting.size() + client.out.size();
+        if (seeding && outstanding == 0) {   // the clock starts once every seed is registered
+            seeding = false;
+            start = now;
+            end = start + duration;
+        }
+        if (now >= end + 2000000000ull || (now >= end && outstanding == 0)) break;
+        int ready = ::epoll_wait(epollFd, events, 64, 10);
+        for (int i = 0; i < ready; ++i) {
+            std::uint64_t tag = events[i].data.u64;
+            if (tag == clients.size()) {
+                std::uint64_t expirations;
+                while (::read(timerFd, &expirations, sizeof(expirations)) > 0) {}
+                now = monotonicNanos();
+                std::uint64_t due = seeding || now >= end ? released
+                                               : static_cast<std::uint64_t>(static_cast<double>(now - start) * 1e-9 * static_cast<double>(rate));
+                for (; released < due; ++released) {
+                    random ^= random << 13;
+                    random ^= random >> 17;
+                    random ^= random << 5;
+                    if (released % 10 == 9) request = "REGISTER " + std::to_string(nextRegister++ % 2000000000 + 1) + ",Load Test,Sales,50000\n";
+                    else request = "LOOKUP " + std::to_string(random % kSeeded + 1) + "\n";
+                    release(request, true);
+                }
+                for (auto& client : clients) flush(client);
+            }
+            else {
+                ClientConnection& client = clients[tag];
+                if (events[i].events & EPOLLIN) drain(client);
+                if (events[i].events & EPOLLOUT) flush(client);
+            }
+        }
+    }
+    result.seconds = static_cast<double>(std::min(monotonicNanos(), end) - start) * 1e-9;
+    histogram.addTo(result.latency);
+    for (auto& client : clients) ::close(client.fd);
+    ::close(timerFd);
+    ::close(epollFd);
+    if (outstanding != 0) error = std::to_string(outstanding) + " requests / bytes still outstanding after 2 s";
+    return true;
+}
+
+#endif // __linux__
+
+#endif //EMPLOYEE_VALIDATION_C_REGISTRYSERVER_H
@@ -0,0 +1,299 @@
+//
+// Compressed Registry<T> snapshots: rows are cut into blocks of rowsPerBlock, every block is
+// encoded a column at a time and compressed with lzCodec.h on its own, so saving and loading
+// both spread the blocks over threads.
+//
+// Before compression each column is reshaped by what it holds:
+//   integers           zigzag varint of the difference to the previous row (sorted ids: 1 byte)
+//   grouped strings    block dictionary of the distinct values, then a varint code per row
+//   other strings      varint lengths for the block, then the bytes back to back
+//   floating point     the values as they are
+// The field labels, types and encodings are in the container's meta block, so a snapshot of a
+// different record layout is refused rather than misread.
+//
+
+#ifndef EMPLOYEE_VALIDATION_C_REGISTRYSNAPSHOT_H
+#define EMPLOYEE_VALIDATION_C_REGISTRYSNAPSHOT_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "lzCodec.h"
+#include "mappedFile.h"
+#include "registry.h"
+
+inline constexpr char kSnapshotMagic[4] = {'E', 'V', 'R', 'S'};
+inline constexpr std::uint32_t kSnapshotVersion = 1;
+
+inline void appendVarint(std::string& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>(value | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+inline bool readVarint(const char*& p, const char* end, std::uint64_t& value) {
+    value = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        const auto byte = static_cast<unsigned char>(*p++);
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if (byte < 0x80) return true;
+    }
+    return false;
+}
+
+template <typename M>
+constexpr char snapshotEncoding(FieldIndex index) {
+    if constexpr (std::is_integral_v<M>) return 'd';
+    else if constexpr (std::is_floating_point_v<M>) return 'r';
+    else return index == FieldIndex::grouped ? 'g' : 's';
+}
+
+template <typename M>
+void encodeSnapshotColumn(std::span<const M> values, FieldIndex index, std::string& out) {
+    if constexpr (std::is_integral_v<M>) {
+        // the difference is taken modulo 2^64, so int64 extremes wrap instead of overflowing
+        std::uint64_t previous = 0;
+        for (M value : values) {
+            const std::uint64_t current = static_cast<std::uint64_t>(static_cast<std::int64_t>(value));
+            const std::uint64_t delta = current - previous;
+            appendVarint(out, (delta << 1) ^ (0 - (delta >> 63)));
+            previous = current;
+        }
+    }
+    else if constexpr (std::is_floating_point_v<M>) {
+        out.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(M));
+    }
+    else if (index == FieldIndex::grouped) {
+        std::unordered_map<std::string_view, std::uint32_t> codes;
+        std::vector<std::string_view> dictionary;
+        std::string rowCodes;
+        for (const std::string& value : values) {
+            auto [entry, added] = codes.try_emplace(value, static_cast<std::uint32_t>(dictionary.size()));
+            if (added) dictionary.push_back(value);
+            appendVarint(rowCodes, entry->second);
+        }
+        appendVarint(out, dictionary.size());
+        for (std::string_view value : dictionary) {
+            appendVarint(out, value.size());
+            out.append(value);
+        }
+        out += rowCodes;
+    }
+    else {
+        for (const std::string& value : values) appendVarint(out, value.size());
+        for (const std::string& value : values) out += value;
+    }
+}
+
+template <typename M>
+bool decodeSnapshotColumn(const char*& p, const char* end, std::size_t rows, FieldIndex index, std::vector<M>& values) {
+    values.reserve(rows);
+    std::uint64_t word = 0;
+    if constexpr (std::is_integral_v<M>) {
+        // summed modulo 2^64 like the encoder; a value that does not fit M is a corrupt column
+        std::uint64_t previous = 0;
+        for (std::size_t r = 0; r < rows; ++r) {
+            if (!readVarint(p, end, word)) return false;
+            previous += (word >> 1) ^ (0 - (word & 1));
+            if constexpr (std::is_signed_v<M>) {
+                const std::int64_t value = static_cast<std::int64_t>(previous);
+                if (value < std::numeric_limits<M>::min() || value > std::numeric_limits<M>::max()) return false;
+            }
+            else if (previous > std::numeric_limits<M>::max()) {
+                return false;
+            }
+            values.push_back(static_cast<M>(previous));
+        }
+        return true;
+    }
+    else if constexpr (std::is_floating_point_v<M>) {
+        if (static_cast<std::size_t>(end - p) / sizeof(M) < rows) return false;
+        values.resize(rows);
+        std::memcpy(values.data(), p, rows * sizeof(M));
+        p += rows * sizeof(M);
+        return true;
+    }
+    else if (index == FieldIndex::grouped) {
+        if (!readVarint(p, end, word) || word > rows) return false;
+        std::vector<std::string_view> dictionary(static_cast<std::size_t>(word));
+        for (std::string_view& value : dictionary) {
+            if (!readVarint(p, end, word) || static_cast<std::uint64_t>(end - p) < word) return false;
+            value = std::string_view(p, static_cast<std::size_t>(word));
+            p += word;
+        }
+        for (std::size_t r = 0; r < rows; ++r) {
+            if (!readVarint(p, end, word) || word >= dictionary.size()) return false;
+            values.emplace_back(dictionary[static_cast<std::size_t>(word)]);
+        }
+        return true;
+    }
+    else {
+        std::vector<std::uint32_t> lengths(rows);
+        std::uint64_t total = 0;
+        for (std::uint32_t& length : lengths) {
+            if (!readVarint(p, end, word) || word > 0xFFFFFFFFu) return false;
+            length = static_cast<std::uint32_t>(word);
+            total += word;
+        }
+        if (static_cast<std::uint64_t>(end - p) < total) return false;
+        for (std::uint32_t length : lengths) {
+            values.emplace_back(p, length);
+            p += length;
+        }
+        return true;
+    }
+}
+
+// Field labels, types and encodings, in field order
+template <typename T>
+std::string snapshotSignature() {
+    std::string out;
+    forEachField<T>([&](auto i) {
+        constexpr std::size_t I = decltype(i)::value;
+        using M = typename FieldAt<T, I>::Type;
+        const char* label = std::get<I>(RecordTraits<T>::fields).label;
+        appendVarint(out, std::strlen(label));
+        out += label;
+        out += std::is_integral_v<M> ? 'i' : std::is_floating_point_v<M> ? 'f' : 's';
+        out += static_cast<char>(sizeof(M));
+        out += snapshotEncoding<M>(FieldAt<T, I>::index);
+    });
+    return out;
+}
+
+template <typename T>
+std::string encodeRegistrySnapshot(const Registry<T>& registry, unsigned threads, std::size_t rowsPerBlock = 1 << 16) {
+    rowsPerBlock = std::max<std::size_t>(rowsPerBlock, 1);
+    const std::size_t rows = registry.size();
+    const std::size_t blockCount = (rows + rowsPerBlock - 1) / rowsPerBlock;
+    std::vector<std::string> blocks(blockCount);
+    forEachBlock(blockCount, threads, [&](std::size_t b) {
+        const std::size_t first = b * rowsPerBlock;
+        const std::size_t count = std::min(rowsPerBlock, rows - first);
+        forEachField<T>([&](auto i) {
+            constexpr std::size_t I = decltype(i)::value;
+            encodeSnapshotColumn(registry.template columnAt<I>().subspan(first, count), FieldAt<T, I>::index, blocks[b]);
+        });
+    });
+    std::string meta(kSnapshotMagic, 4);
+    appendVarint(meta, kSnapshotVersion);
+    appendVarint(meta, rows);
+    appendVarint(meta, rowsPerBlock);
+    meta += snapshotSignature<T>();
+    return packBlocks(meta, blocks, threads);
+}
+
+// Replaces the registry's contents with the snapshot; on failure it is left empty
+template <typename T>
+bool decodeRegistrySnapshot(std::string_view data, unsigned threads, Registry<T>& registry, std::string& error) {
+    registry.clear();
+    BlockDirectory directory;
+    if (!readBlockDirectory(data, directory, error)) return false;
+    const char* p = directory.meta.data();
+    const char* metaEnd = p + directory.meta.size();
+    std::uint64_t version = 0, rows = 0, rowsPerBlock = 0;
+    if (directory.meta.size() < 4 || std::memcmp(p, kSnapshotMagic, 4) != 0) {
+        error = "not a registry snapshot";
+        return false;
+    }
+    p += 4;
+    if (!readVarint(p, metaEnd, version) || version != kSnapshotVersion || !readVarint(p, metaEnd, rows) ||
+        !readVarint(p, metaEnd, rowsPerBlock) || rowsPerBlock == 0) {
+        error = "unsupported registry snapshot version";
+        return false;
+    }
+    if (std::string_view(p, static_cast<std::size_t>(metaEnd - p)) != snapshotSignature<T>()) {
+        error = "snapshot fields do not match this record type";
+        return false;
+    }
+    if ((rows + rowsPerBlock - 1) / rowsPerBlock != directory.blocks.size() || rows >= Registry<T>::npos) {
+        error = "snapshot block count does not match its rows";
+        return false;
+    }
+    // every row takes at least a byte per field, so the per-block allocations below are bounded
+    // by rawSize, which readBlockDirectory bounds by the file size
+    for (std::size_t b = 0; b < directory.blocks.size(); ++b) {
+        if (std::min<std::uint64_t>(rowsPerBlock, rows - b * rowsPerBlock) > directory.blocks[b].rawSize) {
+            error = "corrupt snapshot block";
+            return false;
+        }
+    }
+
+    using Columns = typename Registry<T>::Columns;
+    std::vector<Columns> parts(directory.blocks.size());
+    std::atomic<bool> ok{true};
+    try {
+        forEachBlock(directory.blocks.size(), threads, [&](std::size_t b) {
+            thread_local std::string raw;
+            raw.resize(directory.blocks[b].rawSize);
+            const std::size_t count = static_cast<std::size_t>(std::min<std::uint64_t>(rowsPerBlock, rows - b * rowsPerBlock));
+            bool good = unpackBlock(data, directory.blocks[b], raw.data());
+            const char* at = raw.data();
+            const char* end = at + raw.size();
+            forEachField<T>([&](auto i) {
+                constexpr std::size_t I = decltype(i)::value;
+                good = good && decodeSnapshotColumn(at, end, count, FieldAt<T, I>::index, std::get<I>(parts[b]));
+            });
+            if (!good || at != end) ok.store(false);
+        });
+    }
+    catch (const std::bad_alloc&) {
+        error = "not enough memory to load the snapshot";
+        return false;
+    }
+    if (!ok) {
+        error = "corrupt snapshot block";
+        return false;
+    }
+
+    Columns all;
+    forEachField<T>([&](auto i) {
+        constexpr std::size_t I = decltype(i)::value;
+        auto& column = std::get<I>(all);
+        column.reserve(static_cast<std::size_t>(rows));
+        for (Columns& part : parts) {
+            auto& piece = std::get<I>(part);
+            column.insert(column.end(), std::make_move_iterator(piece.begin()), std::make_move_iterator(piece.end()));
+            std::vector<typename FieldAt<T, I>::Type>().swap(piece);
+        }
+    });
+    return registry.adoptColumns(std::move(all), error);
+}
+
+template <typename T>
+bool saveRegistrySnapshot(const Registry<T>& registry, const std::string& path, unsigned threads, std::string& error) {
+    std::string data = encodeRegistrySnapshot(registry, threads);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.write(data.data(), static_cast<std::streamsize>(data.size()))) {
+        error = "cannot write " + path;
+        return false;
+    }
+    return true;
+}
+
+template <typename T>
+bool loadRegistrySnapshot(Registry<T>& registry, const std::string& path, unsigned threads, std::string& error) {
+    MappedFile input;
+    if (!input.open(path)) {
+        error = "cannot open " + path;
+        return false;
+    }
+    return decodeRegistrySnapshot(input.view(), threads, registry, error);
+}
+
+#endif //EMPLOYEE_VALIDATION_C_REGISTRYSNAPSHOT_H
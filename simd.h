@@ -0,0 +1,61 @@
+//
+// Shared SIMD helpers - runtime AVX2 detection and a cache-line aligned allocator
+//
+
+#ifndef EMPLOYEE_VALIDATION_C_SIMD_H
+#define EMPLOYEE_VALIDATION_C_SIMD_H
+
+#include <cstddef>
+#include <new>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define EV_X86_SIMD 1
+#include <immintrin.h>
+// lets one function use AVX2 while the rest of the file is built for the baseline cpu
+#define EV_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define EV_X86_SIMD 0
+#define EV_TARGET_AVX2
+#endif
+
+constexpr std::size_t kCacheLine = 64;
+
+// checked once, the answer never changes while the program runs
+inline bool cpuHasAvx2() {
+#if EV_X86_SIMD
+    static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+    return hasAvx2;
+#else
+    return false;
+#endif
+}
+
+// Allocator so std::vector storage starts on a cache line (and a 32 byte AVX2 boundary)
+template <typename T, std::size_t Alignment = kCacheLine>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T* p, std::size_t) {
+        ::operator delete(p, std::align_val_t(Alignment));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+};
+
+#endif //EMPLOYEE_VALIDATION_C_SIMD_H
@@ -0,0 +1,139 @@
+//
+// B+ tree style index of (int32 key, row) pairs: sorted leaves in blocks of 64 with levels of
+// per-block maxima above them, so a range query descends a few cache lines and then streams
+// the leaves. Keys added after the last query are kept aside and merged in on the next one.
+// Used by the car inventory and by ordered Registry fields.
+//
+
+#ifndef EMPLOYEE_VALIDATION_C_SORTEDINDEX_H
+#define EMPLOYEE_VALIDATION_C_SORTEDINDEX_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+class SortedIndex {
+public:
+    static constexpr std::size_t kFanout = 64;
+    static constexpr std::size_t kRadixMinimum = 1 << 16;   // below this std::sort is quicker
+
+    void add(std::int32_t key, std::uint32_t row) { pending.emplace_back(key, row); }
+
+    std::size_t size() const { return keys.size() + pending.size(); }
+
+    // calls fn(row) for every key in [low, high], in key order
+    template <typename Fn>
+    void forEachInRange(std::int32_t low, std::int32_t high, Fn&& fn) {
+        merge();
+        for (std::size_t p = lowerBound(low); p < keys.size() && keys[p] <= high; ++p) fn(rows[p]);
+    }
+
+    std::size_t countInRange(std::int32_t low, std::int32_t high) {
+        merge();
+        if (high < low) return 0;
+        std::size_t first = lowerBound(low);
+        std::size_t end = high == std::numeric_limits<std::int32_t>::max() ? keys.size() : lowerBound(high + 1);
+        return end > first ? end - first : 0;
+    }
+
+private:
+    // first position with keys[p] >= key: pick the child whose maximum covers the key on every
+    // level, then finish inside one leaf block
+    std::size_t lowerBound(std::int32_t key) const {
+        if (keys.empty()) return 0;
+        std::size_t node = 0;
+        for (std::size_t level = levels.size(); level-- > 0;) {
+            const std::vector<std::int32_t>& maxima = levels[level];
+            std::size_t begin = node * kFanout;
+            std::size_t end = std::min(begin + kFanout, maxima.size());
+            std::size_t child = begin;
+            while (child < end && maxima[child] < key) ++child;
+            if (child == end) return keys.size();   // only possible at the top: key above everything
+            node = child;
+        }
+        std::size_t p = node * kFanout;
+        std::size_t end = std::min(p + kFanout, keys.size());
+        while (p < end && keys[p] < key) ++p;
+        return p;
+    }
+
+    void merge() {
+        if (pending.empty()) return;
+        if (pending.size() < kRadixMinimum) std::sort(pending.begin(), pending.end());
+        else radixSortPending();
+        std::vector<std::int32_t> mergedKeys;
+        std::vector<std::uint32_t> mergedRows;
+        mergedKeys.reserve(keys.size() + pending.size());
+        mergedRows.reserve(keys.size() + pending.size());
+        std::size_t i = 0, j = 0;
+        while (i < keys.size() || j < pending.size()) {
+            bool takeOld = j == pending.size() ||
+                           (i < keys.size() && std::make_pair(keys[i], rows[i]) < pending[j]);
+            if (takeOld) {
+                mergedKeys.push_back(keys[i]);
+                mergedRows.push_back(rows[i++]);
+            }
+            else {
+                mergedKeys.push_back(pending[j].first);
+                mergedRows.push_back(pending[j++].second);
+            }
+        }
+        keys.swap(mergedKeys);
+        rows.swap(mergedRows);
+        pending.clear();
+        rebuildLevels();
+    }
+
+    // LSD radix sort of pending by (key, row), 16 bits a pass. A pass whose digit is the same for
+    // every entry is skipped, and so are the row passes when rows were added in ascending order
+    // (the usual case - a stable sort by key keeps them that way)
+    void radixSortPending() {
+        auto keyBits = [](std::int32_t key) { return static_cast<std::uint32_t>(key) ^ 0x80000000u; };
+        bool rowsAscending = std::is_sorted(pending.begin(), pending.end(),
+                                            [](const auto& a, const auto& b) { return a.second < b.second; });
+        std::vector<std::pair<std::int32_t, std::uint32_t>> scratch(pending.size());
+        std::vector<std::uint32_t> counts(1 << 16);
+        for (int pass = rowsAscending ? 2 : 0; pass < 4; ++pass) {
+            auto digit = [&](const std::pair<std::int32_t, std::uint32_t>& entry) {
+                std::uint32_t word = pass < 2 ? entry.second : keyBits(entry.first);
+                return (word >> (16 * (pass & 1))) & 0xFFFFu;
+            };
+            std::fill(counts.begin(), counts.end(), 0u);
+            for (const auto& entry : pending) ++counts[digit(entry)];
+            if (counts[digit(pending[0])] == pending.size()) continue;
+            std::uint32_t offset = 0;
+            for (std::uint32_t& count : counts) {
+                std::uint32_t here = count;
+                count = offset;
+                offset += here;
+            }
+            for (const auto& entry : pending) scratch[counts[digit(entry)]++] = entry;
+            pending.swap(scratch);
+        }
+    }
+
+    // bulk load: level 0 holds the max of every leaf block, each level above the max of 64 below
+    void rebuildLevels() {
+        levels.clear();
+        const std::vector<std::int32_t>* below = &keys;
+        do {
+            std::vector<std::int32_t> maxima;
+            maxima.reserve(below->size() / kFanout + 1);
+            for (std::size_t b = 0; b < below->size(); b += kFanout) {
+                maxima.push_back((*below)[std::min(b + kFanout, below->size()) - 1]);
+            }
+            levels.push_back(std::move(maxima));
+            below = &levels.back();
+        } while (below->size() > kFanout);
+    }
+
+    std::vector<std::int32_t> keys;    // sorted, leaf level
+    std::vector<std::uint32_t> rows;   // rows[p] belongs to keys[p]
+    std::vector<std::vector<std::int32_t>> levels;
+    std::vector<std::pair<std::int32_t, std::uint32_t>> pending;
+};
+
+#endif //EMPLOYEE_VALIDATION_C_SORTEDINDEX_H
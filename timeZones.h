@@ -0,0 +1,350 @@
+//
+// Time zone abbreviations ("EST", "CEST", "AEST", ...) resolved to offsets without allocating.
+//
+// Every abbreviation packs into a 32 bit key (up to 4 letters, case folded) and lands in its
+// own slot of a 64 entry table: the multiplier of the slot hash is searched for at compile
+// time until no two abbreviations collide, so a lookup is one multiply and one compare.
+//
+// An abbreviation names a zone, and the zone's daylight saving rule decides the offset at a
+// given instant ("CST" is US Central, which is on CDT in the summer). For batch conversion each
+// zone with a rule gets a table of its UTC transition instants for 1970-2099, built once on
+// first use and bucketed so any instant finds its transition in one step; instants outside
+// those years fall back to evaluating the rule directly.
+// Rules are today's rules for every year (US since 2007, EU since 1996).
+//
+
+#ifndef EMPLOYEE_VALIDATION_C_TIMEZONES_H
+#define EMPLOYEE_VALIDATION_C_TIMEZONES_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+enum class DstRule : std::uint8_t {
+    none,
+    us,          // second Sunday of March 2:00 local -> first Sunday of November 2:00 local
+    eu,          // last Sunday of March 1:00 UTC -> last Sunday of October 1:00 UTC
+    australia,   // first Sunday of October 2:00 local -> first Sunday of April 3:00 local
+};
+
+struct TimeZone {
+    std::string_view name;
+    std::int32_t standardOffset;   // seconds east of UTC
+    std::int32_t daylightShift;    // added while daylight saving time is on
+    DstRule rule;
+};
+
+struct ZoneAbbreviation {
+    std::string_view abbreviation;
+    std::uint8_t zone;   // index into kTimeZones
+    bool daylight;       // the abbreviation of the zone's summer time
+};
+
+inline constexpr TimeZone kTimeZones[] = {
+    {"UTC", 0, 0, DstRule::none},
+    {"US Eastern", -5 * 3600, 3600, DstRule::us},
+    {"US Central", -6 * 3600, 3600, DstRule::us},
+    {"US Mountain", -7 * 3600, 3600, DstRule::us},
+    {"US Pacific", -8 * 3600, 3600, DstRule::us},
+    {"Alaska", -9 * 3600, 3600, DstRule::us},
+    {"Hawaii", -10 * 3600, 0, DstRule::none},
+    {"Western Europe", 0, 3600, DstRule::eu},
+    {"Central Europe", 3600, 3600, DstRule::eu},
+    {"Eastern Europe", 2 * 3600, 3600, DstRule::eu},
+    {"Moscow", 3 * 3600, 0, DstRule::none},
+    {"India", 5 * 3600 + 1800, 0, DstRule::none},
+    {"Singapore", 8 * 3600, 0, DstRule::none},
+    {"Japan", 9 * 3600, 0, DstRule::none},
+    {"Australia Central", 9 * 3600 + 1800, 3600, DstRule::australia},
+    {"Australia Eastern", 10 * 3600, 3600, DstRule::australia},
+};
+
+inline constexpr ZoneAbbreviation kZoneAbbreviations[] = {
+    {"UTC", 0, false},  {"GMT", 0, false},   {"Z", 0, false},
+    {"EST", 1, false},  {"EDT", 1, true},    {"CST", 2, false},  {"CDT", 2, true},
+    {"MST", 3, false},  {"MDT", 3, true},    {"PST", 4, false},  {"PDT", 4, true},
+    {"AKST", 5, false}, {"AKDT", 5, true},   {"HST", 6, false},
+    {"WET", 7, false},  {"WEST", 7, true},   {"CET", 8, false},  {"CEST", 8, true},
+    {"EET", 9, false},  {"EEST", 9, true},   {"MSK", 10, false}, {"IST", 11, false},
+    {"SGT", 12, false}, {"JST", 13, false},  {"ACST", 14, false}, {"ACDT", 14, true},
+    {"AEST", 15, false}, {"AEDT", 15, true},
+};
+
+// ---- perfect hash of the abbreviations ----
+
+// letters folded to upper case, one per byte; 0 when it cannot be an abbreviation
+constexpr std::uint32_t packAbbreviation(std::string_view text) {
+    if (text.empty() || text.size() > 4) return 0;
+    std::uint32_t key = 0;
+    for (char c : text) {
+        if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 'a' + 'A');
+        if (c < 'A' || c > 'Z') return 0;
+        key = key << 8 | static_cast<std::uint8_t>(c);
+    }
+    return key;
+}
+
+inline constexpr unsigned kZoneSlotBits = 6;
+
+constexpr std::uint32_t zoneSlot(std::uint32_t key, std::uint32_t multiplier) {
+    return (key * multiplier) >> (32 - kZoneSlotBits);
+}
+
+// first odd multiplier that gives every abbreviation its own slot
+constexpr std::uint32_t findZoneMultiplier() {
+    for (std::uint32_t multiplier = 0x9E3779B1u;; multiplier += 2) {
+        bool used[1 << kZoneSlotBits] = {};
+        bool collision = false;
+        for (const ZoneAbbreviation& entry : kZoneAbbreviations) {
+            std::uint32_t slot = zoneSlot(packAbbreviation(entry.abbreviation), multiplier);
+            collision = collision || used[slot];
+            used[slot] = true;
+        }
+        if (!collision) return multiplier;
+    }
+}
+
+inline constexpr std::uint32_t kZoneMultiplier = findZoneMultiplier();
+
+struct ZoneSlot {
+    std::uint32_t key = 0;     // 0: empty
+    std::uint8_t entry = 0;    // index into kZoneAbbreviations
+};
+
+inline constexpr auto kZoneSlots = [] {
+    std::array<ZoneSlot, 1 << kZoneSlotBits> slots{};
+    for (std::size_t e = 0; e < std::size(kZoneAbbreviations); ++e) {
+        std::uint32_t key = packAbbreviation(kZoneAbbreviations[e].abbreviation);
+        slots[zoneSlot(key, kZoneMultiplier)] = ZoneSlot{key, static_cast<std::uint8_t>(e)};
+    }
+    return slots;
+}();
+
+// nullptr when the abbreviation is not known
+constexpr const ZoneAbbreviation* findZoneAbbreviation(std::string_view abbreviation) {
+    std::uint32_t key = packAbbreviation(abbreviation);
+    const ZoneSlot& slot = kZoneSlots[zoneSlot(key, kZoneMultiplier)];
+    return key != 0 && slot.key == key ? &kZoneAbbreviations[slot.entry] : nullptr;
+}
+
+constexpr const TimeZone* findTimeZone(std::string_view abbreviation) {
+    const ZoneAbbreviation* entry = findZoneAbbreviation(abbreviation);
+    return entry == nullptr ? nullptr : &kTimeZones[entry->zone];
+}
+
+static_assert(findTimeZone("cst") == &kTimeZones[2]);
+static_assert(findTimeZone("CEST")->standardOffset == 3600);
+static_assert(findTimeZone("XYZ") == nullptr && findTimeZone("") == nullptr);
+
+// ---- calendar ----
+
+// days since 1970-01-01 of a proleptic Gregorian date (Howard Hinnant's days_from_civil)
+constexpr std::int64_t daysFromCivil(std::int64_t year, unsigned month, unsigned day) {
+    year -= month <= 2;
+    const std::int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const unsigned yearOfEra = static_cast<unsigned>(year - era * 400);
+    const unsigned dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + static_cast<std::int64_t>(dayOfEra) - 719468;
+}
+
+struct CivilDate {
+    std::int64_t year;
+    unsigned month;
+    unsigned day;
+};
+
+constexpr CivilDate civilFromDays(std::int64_t days) {
+    days += 719468;
+    const std::int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const unsigned dayOfEra = static_cast<unsigned>(days - era * 146097);
+    const unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    const unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    const unsigned mp = (5 * dayOfYear + 2) / 153;
+    const unsigned day = dayOfYear - (153 * mp + 2) / 5 + 1;
+    const unsigned month = mp < 10 ? mp + 3 : mp - 9;
+    return CivilDate{static_cast<std::int64_t>(yearOfEra) + era * 400 + (month <= 2), month, day};
+}
+
+constexpr std::int64_t floorDiv(std::int64_t a, std::int64_t b) {
+    return a / b - (a % b != 0 && (a < 0) != (b < 0));
+}
+
+// 0 = Sunday
+constexpr unsigned weekdayOf(std::int64_t days) {
+    return static_cast<unsigned>(days >= -4 ? (days + 4) % 7 : (days + 5) % 7 + 6);
+}
+
+// day number of the nth (1-based) Sunday of a month
+constexpr std::int64_t nthSunday(std::int64_t year, unsigned month, unsigned n) {
+    std::int64_t first = daysFromCivil(year, month, 1);
+    return first + (7 - weekdayOf(first)) % 7 + 7 * (n - 1);
+}
+
+constexpr std::int64_t lastSunday(std::int64_t year, unsigned month) {
+    std::int64_t last = daysFromCivil(year + (month == 12), month == 12 ? 1 : month + 1, 1) - 1;
+    return last - weekdayOf(last);
+}
+
+static_assert(daysFromCivil(1970, 1, 1) == 0 && daysFromCivil(2000, 3, 1) == 11017);
+static_assert(civilFromDays(11017).year == 2000 && civilFromDays(11017).month == 3);
+static_assert(weekdayOf(0) == 4 && weekdayOf(-1) == 3 && weekdayOf(-5) == 6);
+
+// ---- daylight saving rules ----
+
+struct DstWindow {
+    std::int64_t start;   // UTC instant daylight time begins
+    std::int64_t end;     // UTC instant it ends; before start in the southern hemisphere
+};
+
+constexpr DstWindow dstWindow(const TimeZone& zone, std::int64_t year) {
+    const std::int64_t standard = zone.standardOffset;
+    const std::int64_t daylight = zone.standardOffset + zone.daylightShift;
+    switch (zone.rule) {
+        case DstRule::us:
+            return {nthSunday(year, 3, 2) * 86400 + 2 * 3600 - standard, nthSunday(year, 11, 1) * 86400 + 2 * 3600 - daylight};
+        case DstRule::eu:
+            return {lastSunday(year, 3) * 86400 + 3600, lastSunday(year, 10) * 86400 + 3600};
+        case DstRule::australia:
+            return {nthSunday(year, 10, 1) * 86400 + 2 * 3600 - standard, nthSunday(year, 4, 1) * 86400 + 3 * 3600 - daylight};
+        case DstRule::none:
+            break;
+    }
+    return {0, 0};
+}
+
+// offset in effect at a UTC instant, straight from the rule
+constexpr std::int32_t offsetAt(const TimeZone& zone, std::int64_t utc) {
+    if (zone.rule == DstRule::none) return zone.standardOffset;
+    const DstWindow window = dstWindow(zone, civilFromDays(floorDiv(utc, 86400)).year);
+    const bool daylight = window.start < window.end ? utc >= window.start && utc < window.end
+                                                    : utc >= window.start || utc < window.end;
+    return zone.standardOffset + (daylight ? zone.daylightShift : 0);
+}
+
+// 2026-03-08 07:00 UTC is 2:00 EST, when the US switches to EDT
+static_assert(offsetAt(kTimeZones[1], 1772953200 - 1) == -5 * 3600 && offsetAt(kTimeZones[1], 1772953200) == -4 * 3600);
+
+// ---- cached transition tables ----
+
+struct TransitionTable {
+    static constexpr std::int64_t kFirstYear = 1970;
+    static constexpr std::int64_t kLastYear = 2099;
+
+    // transitions are months apart, so a 2^22 s (~48 day) bucket holds at most one of them
+    static constexpr int kBucketShift = 22;
+
+    std::vector<std::int64_t> instants;   // instants[0] is the first covered instant
+    std::vector<std::int32_t> offsets;    // in effect from instants[i] until instants[i + 1]
+    std::vector<std::uint32_t> buckets;   // last transition at or before each bucket's start
+    std::int64_t coveredEnd = 0;          // first instant after the table
+
+    // index of the transition in effect at t, for instants[0] <= t < coveredEnd
+    std::size_t find(std::int64_t t) const {
+        std::size_t at = buckets[static_cast<std::size_t>((t - instants[0]) >> kBucketShift)];
+        return at + (at + 1 < instants.size() && t >= instants[at + 1]);
+    }
+};
+
+inline TransitionTable buildTransitionTable(const TimeZone& zone) {
+    TransitionTable table;
+    const std::int64_t begin = daysFromCivil(TransitionTable::kFirstYear, 1, 1) * 86400;
+    table.coveredEnd = daysFromCivil(TransitionTable::kLastYear + 1, 1, 1) * 86400;
+    table.instants.push_back(begin);
+    table.offsets.push_back(offsetAt(zone, begin));
+    for (std::int64_t year = TransitionTable::kFirstYear; year <= TransitionTable::kLastYear; ++year) {
+        DstWindow window = dstWindow(zone, year);
+        std::int64_t first = std::min(window.start, window.end);
+        std::int64_t second = std::max(window.start, window.end);
+        for (std::int64_t instant : {first, second}) {
+            table.instants.push_back(instant);
+            table.offsets.push_back(offsetAt(zone, instant));
+        }
+    }
+    std::size_t at = 0;
+    for (std::int64_t start = begin; start < table.coveredEnd; start += std::int64_t{1} << TransitionTable::kBucketShift) {
+        while (at + 1 < table.instants.size() && table.instants[at + 1] <= start) ++at;
+        table.buckets.push_back(static_cast<std::uint32_t>(at));
+    }
+    return table;
+}
+
+// one table per zone, built together on first use (thread safe static init)
+inline const TransitionTable& transitionTable(const TimeZone& zone) {
+    static const std::vector<TransitionTable> tables = [] {
+        std::vector<TransitionTable> built;
+        for (const TimeZone& each : kTimeZones) built.push_back(buildTransitionTable(each));
+        return built;
+    }();
+    return tables[static_cast<std::size_t>(&zone - kTimeZones)];
+}
+
+// local[i] = utc[i] + the zone's offset at utc[i] (spans trimmed to the shorter). The last
+// transition interval is remembered, so runs of nearby timestamps skip even the bucket lookup.
+inline void utcToLocalBatch(const TimeZone& zone, std::span<const std::int64_t> utc, std::span<std::int64_t> local) {
+    const std::size_t n = std::min(utc.size(), local.size());
+    const std::int64_t* in = utc.data();
+    std::int64_t* out = local.data();
+    if (zone.rule == DstRule::none) {
+        for (std::size_t i = 0; i < n; ++i) out[i] = in[i] + zone.standardOffset;
+        return;
+    }
+    const TransitionTable& table = transitionTable(zone);
+    const std::int64_t* instants = table.instants.data();
+    const std::size_t count = table.instants.size();
+    std::size_t at = 0;
+    std::int64_t low = instants[0];
+    std::int64_t high = count > 1 ? instants[1] : table.coveredEnd;
+    for (std::size_t i = 0; i < n; ++i) {
+        const std::int64_t t = in[i];
+        if (t < low || t >= high) {
+            if (t < instants[0] || t >= table.coveredEnd) {
+                out[i] = t + offsetAt(zone, t);
+                continue;
+            }
+            at = table.find(t);
+            low = instants[at];
+            high = at + 1 < count ? instants[at + 1] : table.coveredEnd;
+        }
+        out[i] = t + table.offsets[at];
+    }
+}
+
+// "2026-10-18 14:05:09" into out (at least 20 bytes, NUL terminated)
+inline void formatLocalTime(std::int64_t local, char* out) {
+    const std::int64_t days = floorDiv(local, 86400);
+    const std::int64_t secondOfDay = local - days * 86400;
+    const CivilDate date = civilFromDays(days);
+    const unsigned fields[] = {static_cast<unsigned>(date.year % 10000), date.month, date.day,
+                               static_cast<unsigned>(secondOfDay / 3600), static_cast<unsigned>(secondOfDay / 60 % 60),
+                               static_cast<unsigned>(secondOfDay % 60)};
+    const char separators[] = {'-', '-', ' ', ':', ':', '\0'};
+    char* p = out;
+    for (int f = 0; f < 6; ++f) {
+        if (f == 0) {
+            for (unsigned divisor = 1000; divisor > 0; divisor /= 10) *p++ = static_cast<char>('0' + fields[0] / divisor % 10);
+        }
+        else {
+            *p++ = static_cast<char>('0' + fields[f] / 10);
+            *p++ = static_cast<char>('0' + fields[f] % 10);
+        }
+        *p++ = separators[f];
+    }
+}
+
+// "UTC-05:00" into out (at least 10 bytes, NUL terminated)
+inline void formatUtcOffset(std::int32_t offset, char* out) {
+    const unsigned magnitude = static_cast<unsigned>(offset < 0 ? -offset : offset);
+    const unsigned hours = magnitude / 3600;
+    const unsigned minutes = magnitude / 60 % 60;
+    const char text[] = {'U', 'T', 'C', offset < 0 ? '-' : '+', static_cast<char>('0' + hours / 10),
+                         static_cast<char>('0' + hours % 10), ':', static_cast<char>('0' + minutes / 10),
+                         static_cast<char>('0' + minutes % 10), '\0'};
+    std::copy(text, text + sizeof(text), out);
+}
+
+#endif //EMPLOYEE_VALIDATION_C_TIMEZONES_H
@@ -0,0 +1,188 @@
+//
+// Cached wall clock with a pre-formatted "Www Mmm dd hh:mm:ss yyyy" string (std::ctime's layout,
+// without the newline). The string is rebuilt once per second, either by a background ticker
+// or lazily by whichever caller first notices the second changed; every other call is a
+// seqlock read of 32 bytes, safe from any thread, instead of std::time + std::ctime.
+//
+
+#ifndef EMPLOYEE_VALIDATION_C_TIMESTAMPSERVICE_H
+#define EMPLOYEE_VALIDATION_C_TIMESTAMPSERVICE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <thread>
+
+struct Timestamp {
+    std::int64_t seconds = 0;
+    char text[32] = {};
+
+    std::string_view view() const { return std::string_view(text, std::strlen(text)); }
+};
+
+inline std::ostream& operator<<(std::ostream& out, const Timestamp& timestamp) {
+    return out << timestamp.view();
+}
+
+// coarse clock - on Linux this is the vDSO tick counter, a few ns and no syscall
+inline std::int64_t coarseUnixSeconds() {
+#if defined(CLOCK_REALTIME_COARSE)
+    timespec now;
+    clock_gettime(CLOCK_REALTIME_COARSE, &now);
+    return static_cast<std::int64_t>(now.tv_sec);
+#else
+    return static_cast<std::int64_t>(std::time(nullptr));
+#endif
+}
+
+// std::ctime layout into out (at least 32 bytes), using the thread safe localtime variants
+inline void formatTimestamp(std::int64_t seconds, char* out) {
+    static const char* days[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+    static const char* months[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                   "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+    std::time_t time = static_cast<std::time_t>(seconds);
+    std::tm local{};
+#if defined(_WIN32)
+    localtime_s(&local, &time);
+#else
+    localtime_r(&time, &local);
+#endif
+    auto two = [](char* p, int value) {
+        p[0] = static_cast<char>('0' + value / 10 % 10);
+        p[1] = static_cast<char>('0' + value % 10);
+    };
+    std::memcpy(out, days[local.tm_wday % 7], 3);
+    out[3] = ' ';
+    std::memcpy(out + 4, months[local.tm_mon % 12], 3);
+    out[7] = ' ';
+    two(out + 8, local.tm_mday);
+    if (out[8] == '0') out[8] = ' ';   // ctime pads the day with a space
+    out[10] = ' ';
+    two(out + 11, local.tm_hour);
+    out[13] = ':';
+    two(out + 14, local.tm_min);
+    out[16] = ':';
+    two(out + 17, local.tm_sec);
+    out[19] = ' ';
+    int year = local.tm_year + 1900;
+    two(out + 20, year / 100);
+    two(out + 22, year % 100);
+    out[24] = '\0';
+}
+
+class TimestampService {
+public:
+    static TimestampService& instance() {
+        static TimestampService service;
+        return service;
+    }
+
+    TimestampService(const TimestampService&) = delete;
+    TimestampService& operator=(const TimestampService&) = delete;
+
+    ~TimestampService() { stopTicker(); }
+
+    // Current time and its string. With the ticker running this never reads the clock.
+    Timestamp now() {
+        if (!ticking.load(std::memory_order_relaxed)) refreshIfStale(coarseUnixSeconds());
+        return read();
+    }
+
+    std::int64_t seconds() {
+        if (!ticking.load(std::memory_order_relaxed)) refreshIfStale(coarseUnixSeconds());
+        return cachedSeconds.load(std::memory_order_relaxed);
+    }
+
+    // Background refresh, for callers that cannot afford even the coarse clock read
+    void startTicker(std::chrono::milliseconds interval = std::chrono::milliseconds(50)) {
+        std::lock_guard<std::mutex> lock(tickerMutex);
+        if (ticker.joinable()) return;
+        stopping = false;
+        refreshIfStale(coarseUnixSeconds());
+        ticker = std::thread([this, interval] {
+            std::unique_lock<std::mutex> wait(tickerMutex);
+            while (!wake.wait_for(wait, interval, [this] { return stopping; })) {
+                refreshIfStale(coarseUnixSeconds());
+            }
+        });
+        ticking.store(true, std::memory_order_relaxed);
+    }
+
+    void stopTicker() {
+        std::thread finished;
+        {
+            std::lock_guard<std::mutex> lock(tickerMutex);
+            if (!ticker.joinable()) return;
+            stopping = true;
+            ticking.store(false, std::memory_order_relaxed);
+            finished = std::move(ticker);
+        }
+        wake.notify_all();
+        finished.join();
+    }
+
+private:
+    static constexpr std::size_t kWords = sizeof(Timestamp::text) / sizeof(std::uint64_t);
+
+    TimestampService() { refreshIfStale(coarseUnixSeconds()); }
+
+    // Only one thread rewrites the string; the others keep reading the previous second. Only a
+    // later second is published: a thread that read the clock, then lost the CPU while another
+    // published the next second, must not write its older second back over it.
+    void refreshIfStale(std::int64_t seconds) {
+        if (seconds <= cachedSeconds.load(std::memory_order_relaxed)) return;
+        if (writing.test_and_set(std::memory_order_acquire)) return;
+        if (seconds > cachedSeconds.load(std::memory_order_relaxed)) {
+            char text[sizeof(Timestamp::text)] = {};
+            formatTimestamp(seconds, text);
+            std::uint64_t packed[kWords];
+            std::memcpy(packed, text, sizeof(text));
+
+            std::uint32_t s = sequence.load(std::memory_order_relaxed);
+            sequence.store(s + 1, std::memory_order_relaxed);   // odd: write in progress
+            std::atomic_thread_fence(std::memory_order_release);
+            for (std::size_t i = 0; i < kWords; ++i) words[i].store(packed[i], std::memory_order_relaxed);
+            cachedSeconds.store(seconds, std::memory_order_relaxed);
+            sequence.store(s + 2, std::memory_order_release);
+        }
+        writing.clear(std::memory_order_release);
+    }
+
+    Timestamp read() const {
+        Timestamp timestamp;
+        std::uint64_t packed[kWords];
+        while (true) {
+            std::uint32_t before = sequence.load(std::memory_order_acquire);
+            if (before & 1) continue;
+            for (std::size_t i = 0; i < kWords; ++i) packed[i] = words[i].load(std::memory_order_relaxed);
+            timestamp.seconds = cachedSeconds.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == before) break;
+        }
+        std::memcpy(timestamp.text, packed, sizeof(packed));
+        return timestamp;
+    }
+
+    alignas(64) std::atomic<std::uint32_t> sequence{0};
+    std::atomic<std::int64_t> cachedSeconds{-1};
+    std::atomic<std::uint64_t> words[kWords] = {};
+    std::atomic_flag writing = ATOMIC_FLAG_INIT;
+
+    std::atomic<bool> ticking{false};
+    std::mutex tickerMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread ticker;
+};
+
+inline Timestamp currentTimestamp() {
+    return TimestampService::instance().now();
+}
+
+#endif //EMPLOYEE_VALIDATION_C_TIMESTAMPSERVICE_H